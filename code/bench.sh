@@ -0,0 +1,3 @@
+# Run the micro-benchmarks (optionally filtered by name, e.g. ./bench.sh preset)
+echo "[bench.sh] Running benchmarks..."
+./build/src/test/benchmarks/benchmarks "$@"
@@ -0,0 +1,47 @@
+#ifndef BLOCKOPS_H
+#define BLOCKOPS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief Largest |x| in a block.
+ *
+ * Compares the bit patterns with the sign cleared as unsigned integers, which
+ * orders non-negative floats the same way. Unlike a float max (an ordered
+ * reduction without -ffast-math), the integer max reduction vectorises.
+ */
+inline float peakMagnitude(const float *samples, size_t count)
+{
+    uint32_t peak = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, samples + i, sizeof bits);
+        peak = std::max(peak, bits & 0x7fffffffu);
+    }
+    float magnitude;
+    std::memcpy(&magnitude, &peak, sizeof magnitude);
+    return magnitude;
+}
+
+/**
+ * @brief Average of `count` planar channels (the mono fold). `mono` may be channels[0].
+ */
+inline void foldToMono(const float *const *channels, size_t count, float *mono, size_t frames)
+{
+    const float scale = 1.0f / static_cast<float>(count);
+    const float *first = channels[0];
+    for (size_t i = 0; i < frames; ++i)
+        mono[i] = first[i] * scale;
+    for (size_t c = 1; c < count; ++c)
+    {
+        const float *plane = channels[c];
+        for (size_t i = 0; i < frames; ++i)
+            mono[i] += plane[i] * scale;
+    }
+}
+
+#endif // BLOCKOPS_H
@@ -0,0 +1,87 @@
+#include "BranchWorkers.h"
+#include "RealtimeCheck.h"
+#include <algorithm>
+#include <iostream>
+
+BranchWorkers::~BranchWorkers()
+{
+    stop();
+}
+
+void BranchWorkers::start(size_t count)
+{
+    size_t started = running.load();
+    count = std::min(count, MAX_BRANCH_WORKERS);
+
+    for (; started < count; ++started)
+    {
+        auto worker = std::make_unique<Worker>();
+        if (sem_init(&worker->wake, 0, 0) != 0)
+        {
+            std::cerr << "[BranchWorkers] sem_init failed\n";
+            break;
+        }
+        worker->thread = std::thread(&BranchWorkers::run, worker.get());
+        workers[started] = std::move(worker);
+    }
+
+    if (started != running.load())
+        std::cout << "[BranchWorkers] " << started << " helper thread(s) running\n";
+    running.store(started, std::memory_order_release);
+}
+
+void BranchWorkers::stop()
+{
+    const size_t count = running.exchange(0);
+    for (size_t i = 0; i < count; ++i)
+    {
+        Worker &worker = *workers[i];
+        while (worker.busy.load(std::memory_order_acquire))
+            ; // Let a running branch finish
+        worker.stopping = true;
+        sem_post(&worker.wake);
+        worker.thread.join();
+        sem_destroy(&worker.wake);
+        workers[i].reset();
+    }
+}
+
+void BranchWorkers::dispatch(size_t index, Job job, void *context, uint16_t begin, uint16_t end)
+{
+    Worker &worker = *workers[index];
+    worker.job = job;
+    worker.context = context;
+    worker.begin = begin;
+    worker.end = end;
+    worker.busy.store(true, std::memory_order_relaxed);
+    sem_post(&worker.wake); // Publishes the fields above
+}
+
+void BranchWorkers::wait(size_t index)
+{
+    const Worker &worker = *workers[index];
+    while (worker.busy.load(std::memory_order_acquire))
+        ; // Spin: the branch finishes within this audio period
+}
+
+void BranchWorkers::run(Worker *worker)
+{
+    while (true)
+    {
+        while (sem_wait(&worker->wake) != 0)
+            ; // Retry on EINTR
+        if (worker->stopping)
+            break;
+
+        try
+        {
+            RealtimeScope realtime; // A branch of the audio thread's work
+            worker->job(worker->context, worker->begin, worker->end);
+        }
+        catch (...)
+        {
+            // Fail-safe: the branch keeps whatever it produced
+        }
+        worker->busy.store(false, std::memory_order_release);
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef BRANCHWORKERS_H
+#define BRANCHWORKERS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <semaphore.h>
+
+constexpr size_t MAX_BRANCH_WORKERS = 3; ///< Helper threads for parallel route branches
+
+/**
+ * @class BranchWorkers
+ * @brief Helper threads that run forked route branches for the audio thread.
+ *
+ * Threads are started from a control thread and then sleep on a semaphore.
+ * The audio thread hands a job to an idle worker with sem_post() (no locks,
+ * no allocation) and later spins until it reports completion; branches are a
+ * fraction of one audio period, so spinning is cheaper than sleeping.
+ */
+class BranchWorkers
+{
+public:
+    using Job = void (*)(void *context, uint16_t begin, uint16_t end);
+
+    ~BranchWorkers();
+
+    /**
+     * @brief Starts up to `count` threads (capped at MAX_BRANCH_WORKERS). Control thread only.
+     */
+    void start(size_t count);
+
+    /**
+     * @brief Stops and joins all threads. Not while the audio thread is processing.
+     */
+    void stop();
+
+    /**
+     * @brief Number of running workers (safe to read from the audio thread).
+     */
+    size_t size() const { return running.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Audio thread: runs job(context, begin, end) on worker `index`.
+     */
+    void dispatch(size_t index, Job job, void *context, uint16_t begin, uint16_t end);
+
+    /**
+     * @brief Audio thread: waits for worker `index` to finish its job.
+     */
+    void wait(size_t index);
+
+private:
+    struct Worker
+    {
+        std::thread thread;
+        sem_t wake;
+        std::atomic<bool> busy{false};
+        bool stopping = false;
+        Job job = nullptr;
+        void *context = nullptr;
+        uint16_t begin = 0;
+        uint16_t end = 0;
+    };
+
+    static void run(Worker *worker);
+
+    std::unique_ptr<Worker> workers[MAX_BRANCH_WORKERS];
+    std::atomic<size_t> running{0};
+};
+
+#endif // BRANCHWORKERS_H
@@ -0,0 +1,191 @@
+#ifndef DELAYLINE_H
+#define DELAYLINE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Catmull-Rom cubic through x0..x3, evaluated at u in [0, 1] between x1 and x2.
+ */
+inline float cubicInterpolate(float x0, float x1, float x2, float x3, float u)
+{
+    const float c1 = 0.5f * (x2 - x0);
+    const float c2 = x0 - 2.5f * x1 + 2.0f * x2 - 0.5f * x3;
+    const float c3 = 0.5f * (x3 - x0) + 1.5f * (x1 - x2);
+    return ((c3 * u + c2) * u + c1) * u + x1;
+}
+
+/**
+ * @class DelayLine
+ * @brief Circular sample history with a power-of-two length.
+ *
+ * Positions wrap with a mask rather than a modulo. Blocks are written and read
+ * as at most two contiguous spans (before and after the wrap point), so each
+ * span is a plain copy the compiler vectorises. Memory is allocated once by
+ * allocate(); nothing else allocates, so changing the delay at run time is free.
+ *
+ * Fractional delays are read with cubic interpolation, for the block about to
+ * be written: out[i] is the signal delay (or delays[i]) samples before the
+ * i-th sample of that block. Delays must be at least count + 1, so that every
+ * tap is already in the line.
+ */
+class DelayLine
+{
+public:
+    static constexpr size_t MAX_READ = 256; ///< Longest block readFractional() takes
+
+    /**
+     * @brief Allocates at least `minimumLength` samples (rounded up to a power of two) and clears them.
+     *        Not real-time safe; call when preparing the effect.
+     */
+    void allocate(size_t minimumLength)
+    {
+        size_t length = 1;
+        while (length < minimumLength)
+            length <<= 1;
+        buffer.assign(length, 0.0f);
+        mask = length - 1;
+        position = 0;
+    }
+
+    /**
+     * @brief Samples of history held.
+     */
+    size_t capacity() const { return buffer.size(); }
+
+    /**
+     * @brief Zeroes the history.
+     */
+    void clear()
+    {
+        std::fill(buffer.begin(), buffer.end(), 0.0f);
+        position = 0;
+    }
+
+    /**
+     * @brief Frees the history; allocate() again before use.
+     */
+    void release()
+    {
+        std::vector<float>().swap(buffer);
+        mask = 0;
+        position = 0;
+    }
+
+    /**
+     * @brief Appends a block of samples.
+     */
+    void write(const float *in, size_t count)
+    {
+        const size_t start = position & mask;
+        const size_t first = std::min(count, buffer.size() - start);
+        std::copy(in, in + first, buffer.data() + start);
+        std::copy(in + first, in + count, buffer.data());
+        position += count;
+    }
+
+    /**
+     * @brief Reads the last `count` samples written, delayed by a further `delay` samples.
+     *        out[i] is the sample written count - i + delay samples ago; needs delay + count <= capacity().
+     */
+    void read(float *out, size_t count, size_t delay) const
+    {
+        const size_t start = (position - count - delay) & mask;
+        const size_t first = std::min(count, buffer.size() - start);
+        std::copy(buffer.data() + start, buffer.data() + start + first, out);
+        std::copy(buffer.data(), buffer.data() + (count - first), out + first);
+    }
+
+    /**
+     * @brief Fractional read at a constant delay: one two-span copy, then a vectorised cubic.
+     */
+    void readFractional(float *out, size_t count, float delay)
+    {
+        const size_t whole = static_cast<size_t>(delay);
+        const float u = 1.0f - (delay - static_cast<float>(whole));
+        // taps[j] is the sample whole + 2 - j before the block
+        read(taps, count + 3, whole - count - 1);
+        for (size_t i = 0; i < count; ++i)
+            out[i] = cubicInterpolate(taps[i], taps[i + 1], taps[i + 2], taps[i + 3], u);
+    }
+
+    /**
+     * @brief Fractional read with a delay per sample (modulation, glides).
+     *
+     * Works through SWEEP samples at a time. When their delays span fewer than
+     * MAX_PASSES whole samples (as an LFO or a slow glide does), the taps are
+     * first copied out as one contiguous window; then, for each whole delay in
+     * the span, a vectorised cubic over contiguous taps is kept in the lanes
+     * whose delay has that whole part. Faster sweeps look each tap up alone.
+     */
+    void readModulated(float *out, const float *delays, size_t count)
+    {
+        for (size_t done = 0; done < count; done += SWEEP)
+            readSweep(out, delays, done, std::min(SWEEP, count - done));
+    }
+
+    /**
+     * @brief Sample written `age` samples ago (1 = the newest).
+     */
+    float at(size_t age) const { return buffer[(position - age) & mask]; }
+
+    /**
+     * @brief Samples written since allocate() or clear() (wraps).
+     */
+    size_t written() const { return position; }
+
+private:
+    static constexpr size_t SWEEP = 64;      ///< Samples per readModulated() pass
+    static constexpr int32_t MAX_PASSES = 4; ///< Whole delays spanned before falling back to lookups
+
+    /**
+     * @brief readModulated() for out[from .. from + n).
+     */
+    void readSweep(float *out, const float *delays, size_t from, size_t n)
+    {
+        int32_t whole[SWEEP];
+        float u[SWEEP];
+        int32_t low = INT32_MAX, high = 0;
+        for (size_t j = 0; j < n; ++j)
+        {
+            whole[j] = static_cast<int32_t>(delays[from + j]);
+            u[j] = 1.0f - (delays[from + j] - static_cast<float>(whole[j]));
+            low = std::min(low, whole[j]);
+            high = std::max(high, whole[j]);
+        }
+
+        if (high - low >= MAX_PASSES)
+        {
+            for (size_t j = 0; j < n; ++j)
+            {
+                const size_t age = static_cast<size_t>(whole[j]) + 2 - (from + j); // Age of the oldest tap
+                out[from + j] = cubicInterpolate(at(age), at(age - 1), at(age - 2), at(age - 3), u[j]);
+            }
+            return;
+        }
+
+        // taps[k] is the sample oldest - k samples old; sample j with whole delay w starts at k = high - w + j
+        const size_t oldest = static_cast<size_t>(high) + 2 - from;
+        const size_t window = static_cast<size_t>(high - low) + n + 3;
+        read(taps, window, oldest - window);
+        float *result = out + from;
+        for (int32_t w = low; w <= high; ++w)
+        {
+            const float *tap = taps + (high - w);
+            for (size_t j = 0; j < n; ++j)
+            {
+                const float y = cubicInterpolate(tap[j], tap[j + 1], tap[j + 2], tap[j + 3], u[j]);
+                result[j] = (w == low || whole[j] == w) ? y : result[j];
+            }
+        }
+    }
+
+    std::vector<float> buffer;
+    float taps[MAX_READ + 3];  ///< readFractional() and readModulated() scratch
+    size_t mask = 0;
+    size_t position = 0; ///< Samples written; the next write goes to position & mask
+};
+
+#endif // DELAYLINE_H
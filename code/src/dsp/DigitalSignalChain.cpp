@@ -1,102 +1,235 @@
 #include "DigitalSignalChain.h"
-#include "EffectFactory.h"
+#include "BlockOps.h"
+#include "RealtimeCheck.h"
+#include <algorithm>
 #include <iostream>
+#include <cmath>
 #include <cstring>
-#include <unordered_set>
+#include <thread>
 
-// Constructor: initialise both chains to empty slots
-DigitalSignalChain::DigitalSignalChain()
+static_assert(MAX_CHANNELS >= 2, "Stereo effects need two planes");
+static_assert(MAX_EFFECTS <= Sample::MAX_TAGS, "A traced Sample must have room to tag every effect");
+
+namespace
 {
-    for (auto &chain : chains)
+    // Adapts planar channels in place: folds down to mono, or copies the first channel to fill up
+    void matchChannels(float *const *channels, size_t have, size_t want, size_t frames)
     {
-        for (auto &slot : chain.effects)
+        if (want < have)
         {
-            slot.effect.reset();
-            std::memset(slot.name, 0, sizeof(slot.name));
+            if (want == 1)
+                foldToMono(channels, have, channels[0], frames);
+            return;
         }
-        chain.count = 0;
+        for (size_t c = have; c < want; ++c)
+            std::memcpy(channels[c], channels[0], frames * sizeof(float));
+    }
+}
+
+// Constructor: initialise all chains to empty slots
+DigitalSignalChain::DigitalSignalChain()
+{
+    for (auto &chain : chains)
+    {
+        // Allocated once: the audio thread may still be reading an older schedule
+        chain.buffers.assign(MAX_ROUTE_BUFFERS * MAX_CHANNELS * MAX_BLOCK_SIZE, 0.0f);
+        chain.route.publish(RoutingGraph::serial());
+        chain.route.update(); // No audio thread yet, so adopt it here
     }
+
+    // Equal-power curve: incoming gain sin(theta), outgoing gain cos(theta)
+    for (size_t i = 0; i <= CROSSFADE_SAMPLES; ++i)
+    {
+        fadeGains[i] = std::sin(0.5f * static_cast<float>(M_PI) * i / CROSSFADE_SAMPLES);
+    }
+
     activeChainIndex.store(0);
-    registerAllEffects(); // Register all effects into active chain
+    requestedChainIndex.store(0);
+    fadingChainIndex.store(NO_CHAIN);
+    buildChain(chains[0]); // Register all effects into the live chain
 }
 
-// Register all effects from the factory
-void DigitalSignalChain::registerAllEffects()
+// Instantiate every effect in the registry table
+void DigitalSignalChain::buildChain(Chain &chain)
 {
-    size_t active = activeChainIndex.load();
-    Chain &chain = chains[active];
+    for (auto &slot : chain.effects)
+    {
+        slot = EffectSlot{};
+    }
     chain.count = 0;
 
-    auto &factory = EffectFactory::instance();
-    auto allNames = factory.getAllRegisteredEffectNames();
+    for (EffectId id = 0; id < EffectRegistry::slotCount; ++id)
+    {
+        const EffectInfo &info = EffectRegistry::info(id);
+        EffectSlot &slot = chain.effects[chain.count];
+        slot.effect = info.create();
+        slot.id = info.id;
+        slot.name = info.name;
+        chain.count++;
+        for (const auto &[setupId, setup] : instanceSetups)
+        {
+            if (setupId == info.id)
+                setup(*slot.effect);
+        }
+        std::cout << "[DigitalSignalChain] Registered effect: " << info.name << "\n";
+    }
+    prepareChain(chain);
+
+    chain.routeRevision = std::numeric_limits<uint64_t>::max();
+    chain.route.publish(RoutingGraph::serial());
+}
 
-    std::unordered_set<std::string> registered;
+Effect *DigitalSignalChain::getEffect(EffectId id) const
+{
+    return id < chains[0].count ? chains[0].effects[id].effect.get() : nullptr;
+}
 
-    for (const auto &effectName : allNames)
+std::shared_ptr<Effect> DigitalSignalChain::getPlayingEffect(EffectId id)
+{
+    std::lock_guard<std::recursive_mutex> lock(controlMutex);
+    const Chain &chain = chains[requestedChainIndex.load()];
+    return id < chain.count ? chain.effects[id].effect : nullptr;
+}
+
+void DigitalSignalChain::forEachInstance(EffectId id, std::function<void(Effect &)> setup)
+{
+    std::lock_guard<std::recursive_mutex> lock(controlMutex);
+    for (Chain &chain : chains)
     {
-        if (chain.count >= MAX_EFFECTS)
-            break;
+        if (id < chain.count && chain.effects[id].effect)
+            setup(*chain.effects[id].effect);
+    }
+    instanceSetups.emplace_back(id, std::move(setup));
+}
 
-        // Avoid duplicates
-        if (!registered.insert(effectName).second)
+void DigitalSignalChain::prepareChain(Chain &chain)
+{
+    for (size_t i = 0; i < chain.count; ++i)
+    {
+        Effect *effect = chain.effects[i].effect.get();
+        if (!effect)
             continue;
+        const size_t channels = effect->channelLayout() == ChannelLayout::Mono ? 1 : MAX_CHANNELS;
+        effect->prepare(preparedRate, preparedBlock, channels);
+    }
+}
 
-        auto effectPtr = factory.createEffect(effectName);
-        if (effectPtr)
-        {
-            chain.effects[chain.count].effect = effectPtr;
-            std::strncpy(chain.effects[chain.count].name, effectName.c_str(), sizeof(chain.effects[chain.count].name) - 1);
-            chain.count++;
-            std::cout << "[DigitalSignalChain] Registered effect: " << effectName << "\n";
-        }
-        else
+bool DigitalSignalChain::prepare(float sampleRate, size_t maxBlockSize)
+{
+    std::lock_guard<std::recursive_mutex> lock(controlMutex);
+
+    maxBlockSize = std::min(maxBlockSize, MAX_BLOCK_SIZE);
+    if (sampleRate == preparedRate && maxBlockSize == preparedBlock)
+        return false;
+
+    suspendAudio();
+    preparedRate = sampleRate;
+    preparedBlock = maxBlockSize;
+    for (auto &chain : chains)
+        prepareChain(chain);
+    resumeAudio();
+
+    std::cout << "[DigitalSignalChain] Prepared for " << sampleRate << " Hz in blocks of up to " << maxBlockSize
+              << " frames\n";
+    return true;
+}
+
+void DigitalSignalChain::reset()
+{
+    std::lock_guard<std::recursive_mutex> lock(controlMutex);
+
+    const bool released = suspended.load();
+    suspendAudio();
+    for (auto &chain : chains)
+    {
+        for (size_t i = 0; i < chain.count; ++i)
         {
-            std::cerr << "[DigitalSignalChain] Failed to create effect: " << effectName << "\n";
+            if (chain.effects[i].effect)
+                chain.effects[i].effect->reset();
         }
     }
+    if (!released)
+        resumeAudio();
 }
 
-// Applies active effects to a sample
-void DigitalSignalChain::applyEffects(Sample &sample)
+void DigitalSignalChain::release()
 {
-    float originalValue = sample.getPcmValue();
-    size_t activeIndex = activeChainIndex.load();
-    const Chain &chain = chains[activeIndex];
+    std::lock_guard<std::recursive_mutex> lock(controlMutex);
 
-    try
+    suspendAudio(); // Until the next prepare()
+    for (auto &chain : chains)
     {
         for (size_t i = 0; i < chain.count; ++i)
         {
-            const auto &slot = chain.effects[i];
-            if (!slot.effect || !slot.effect->isActive())
-            {
-                //std::cout << "[DigitalSignalChain] Skipping process...\n Value: " << originalValue << "\n";
-                continue;
-            }
-            else
-            {
-                float result = slot.effect->process(sample.getPcmValue());
-                sample.setPcmValue(result);
-                sample.addEffect(slot.name);
-            }
+            if (chain.effects[i].effect)
+                chain.effects[i].effect->release();
         }
     }
-    catch (...)
+    preparedRate = 0.0f;
+}
+
+void DigitalSignalChain::suspendAudio()
+{
+    // Sequentially consistent with processChunk(): either it sees the flag, or this sees it processing
+    suspended.store(true);
+    while (processing.load())
+        std::this_thread::yield();
+}
+
+void DigitalSignalChain::resumeAudio()
+{
+    suspended.store(false, std::memory_order_release);
+}
+
+void DigitalSignalChain::warmChain(Chain &chain)
+{
+    // Local buffers: the audio thread may be using dryInput meanwhile
+    const float zeros[MAX_BLOCK_SIZE] = {};
+    float silence[MAX_BLOCK_SIZE];
+    float *channels[1] = {silence};
+    DryInput dry{};
+    dry.channels[0] = zeros;
+    dry.count = 1;
+    dry.mono = zeros;
+    for (size_t done = 0; done < WARMUP_SAMPLES; done += MAX_BLOCK_SIZE)
     {
-        sample.setPcmValue(originalValue); // fail-safe
+        const size_t frames = std::min(MAX_BLOCK_SIZE, WARMUP_SAMPLES - done);
+        std::fill(silence, silence + frames, 0.0f);
+        runChain(chain, channels, 1, 1, frames, dry, nullptr, false);
     }
 }
 
-// Apply configuration to each effect
-void DigitalSignalChain::configureEffects(Config &config)
+void DigitalSignalChain::configureRoute(Chain &chain, const Config &config)
 {
-    if (!config.hasUpdate())
+    const uint64_t revision = config.revision("route");
+    if (revision == chain.routeRevision)
         return;
+    chain.routeRevision = revision;
 
-    size_t activeIndex = activeChainIndex.load();
-    Chain &chain = chains[activeIndex];
+    RouteSchedule schedule = RoutingGraph::serial();
+    if (config.contains("route"))
+    {
+        const std::string route = config.get<std::string>("route", "");
+        std::string error;
+        if (!RoutingGraph::compile(route, schedule, error))
+        {
+            std::cerr << "[DigitalSignalChain] Invalid route \"" << route << "\": " << error << " (keeping previous)\n";
+            return;
+        }
+        std::cout << "[DigitalSignalChain] Route: " << route << "\n";
+    }
+
+    if (schedule.forks > 0)
+    {
+        const unsigned cores = std::thread::hardware_concurrency();
+        workers.start(cores > 1 ? cores - 1 : 0);
+    }
+    chain.route.publish(schedule);
+}
 
-    std::cout << "[DigitalSignalChain] Configuring " << chain.count << " effect(s)\n";
+void DigitalSignalChain::configureChain(Chain &chain, const Config &config)
+{
+    configureRoute(chain, config);
 
     for (size_t i = 0; i < chain.count; ++i)
     {
@@ -106,14 +239,349 @@ void DigitalSignalChain::configureEffects(Config &config)
 
         try
         {
-            slot.effect->configure(config);
-            std::cout << "[DigitalSignalChain] Configured: " << slot.name << "\n";
+            // Effects whose keys did not change are skipped and keep their state
+            if (slot.effect->configure(config))
+                std::cout << "[DigitalSignalChain] Configured: " << slot.name << "\n";
         }
         catch (const std::exception &e)
         {
             std::cerr << "[DigitalSignalChain] Error configuring " << slot.name << ": " << e.what() << "\n";
         }
     }
+}
+
+void DigitalSignalChain::runSteps(RouteRun &run, uint16_t begin, uint16_t end, Sample *sample, BranchWorkers *workers)
+{
+    const size_t frames = run.frames;
+    size_t forked = 0;
+
+    for (uint16_t s = begin; s < end; ++s)
+    {
+        const RouteStep &step = run.schedule->steps[s];
+        float *const *dst = run.buffers[step.dst];
+        float *const *src = run.buffers[step.src];
+        size_t &channels = run.channels[step.dst];
+
+        switch (step.op)
+        {
+        case RouteOp::Process:
+        {
+            const EffectSlot &slot = run.chain->effects[step.effect];
+            if (!slot.effect || !slot.effect->isActive())
+                break;
+
+            // Fold or widen the signal to what the effect handles
+            const ChannelLayout layout = slot.effect->channelLayout();
+            const size_t wanted = layout == ChannelLayout::Mono ? 1 : layout == ChannelLayout::Stereo ? 2 : channels;
+            matchChannels(dst, channels, wanted, frames);
+            channels = wanted;
+
+            slot.effect->setSidechain(run.input);
+            slot.effect->processChannels(dst, channels, frames);
+            if (sample)
+                sample->addEffect(slot.name);
+            break;
+        }
+        case RouteOp::Copy:
+            channels = run.channels[step.src];
+            for (size_t c = 0; c < channels; ++c)
+                std::memcpy(dst[c], src[c], frames * sizeof(float));
+            break;
+        case RouteOp::Scale:
+            for (size_t c = 0; c < channels; ++c)
+            {
+                float *plane = dst[c];
+                for (size_t i = 0; i < frames; ++i)
+                    plane[i] *= step.gain;
+            }
+            break;
+        case RouteOp::Mix:
+        {
+            // A wider branch widens the mix; a mono branch is mixed into every channel
+            const size_t from = run.channels[step.src];
+            if (from > channels)
+            {
+                matchChannels(dst, channels, from, frames);
+                channels = from;
+            }
+            for (size_t c = 0; c < channels; ++c)
+            {
+                float *plane = dst[c];
+                const float *mixed = src[std::min(c, from - 1)];
+                for (size_t i = 0; i < frames; ++i)
+                    plane[i] += mixed[i] * step.gain;
+            }
+            break;
+        }
+        case RouteOp::Fork:
+            if (workers && forked < workers->size())
+                workers->dispatch(forked++, &DigitalSignalChain::runBranch, &run, step.begin, step.end);
+            else
+                runSteps(run, step.begin, step.end, sample, nullptr); // No free helper: run it here
+            break;
+        case RouteOp::Join:
+            for (size_t i = 0; i < forked; ++i)
+                workers->wait(i);
+            forked = 0;
+            break;
+        }
+    }
+}
+
+void DigitalSignalChain::runBranch(void *context, uint16_t begin, uint16_t end)
+{
+    runSteps(*static_cast<RouteRun *>(context), begin, end, nullptr, nullptr);
+}
+
+void DigitalSignalChain::runChain(Chain &chain, float *const *channels, size_t planes, size_t outputChannels,
+                                  size_t frames, const DryInput &dry, Sample *sample, bool parallel)
+{
+    chain.route.update();
+
+    RouteRun run;
+    run.chain = &chain;
+    run.schedule = &chain.route.read();
+    run.frames = frames;
+    run.input = dry.mono;
+    for (size_t b = 0; b < MAX_ROUTE_BUFFERS; ++b)
+    {
+        for (size_t c = 0; c < MAX_CHANNELS; ++c)
+            run.buffers[b][c] = chain.buffers.data() + (b * MAX_CHANNELS + c) * MAX_BLOCK_SIZE;
+        run.channels[b] = 1;
+    }
+
+    // Buffer 0 is the caller's, widened into the chain's own planes past the ones it has
+    for (size_t c = 0; c < planes; ++c)
+        run.buffers[0][c] = channels[c];
+    run.channels[0] = dry.count;
+
+    BranchWorkers *helpers = parallel ? &workers : nullptr;
+    try
+    {
+        runSteps(run, 0, run.schedule->mainSteps, sample, helpers);
+    }
+    catch (...)
+    {
+        // Fail-safe: let forked branches finish, then pass the input through
+        for (size_t i = 0; helpers && i < helpers->size(); ++i)
+            helpers->wait(i);
+        for (size_t c = 0; c < dry.count; ++c)
+            std::memcpy(channels[c], dry.channels[c], frames * sizeof(float));
+        run.channels[0] = dry.count;
+    }
+
+    // Every channel asked for is in the caller's planes
+    matchChannels(run.buffers[0], run.channels[0], outputChannels, frames);
+}
+
+void DigitalSignalChain::pickUpChainSwitch()
+{
+    const size_t requested = requestedChainIndex.load(std::memory_order_acquire);
+    const size_t active = activeChainIndex.load(std::memory_order_relaxed);
+
+    // A request arriving mid-fade waits for the running fade to finish
+    if (requested != active && fadePosition >= CROSSFADE_SAMPLES)
+    {
+        previousChainIndex = active;
+        fadingChainIndex.store(active);
+        activeChainIndex.store(requested, std::memory_order_release);
+        fadePosition = 0;
+    }
+}
+
+void DigitalSignalChain::processChunk(float *const *channels, size_t inputChannels, size_t outputChannels,
+                                      size_t frames, Sample *sample, bool parallel)
+{
+    RealtimeScope realtime; // Nothing below may allocate, lock or block
+
+    // Effects being prepared or reset: pass the input through rather than wait
+    processing.store(true);
+    if (suspended.load())
+    {
+        matchChannels(channels, inputChannels, outputChannels, frames);
+        processing.store(false, std::memory_order_release);
+        return;
+    }
+
+    pickUpChainSwitch();
+
+    DryInput dry{};
+    dry.count = inputChannels;
+    for (size_t c = 0; c < inputChannels; ++c)
+    {
+        std::memcpy(dryInput[c], channels[c], frames * sizeof(float));
+        dry.channels[c] = dryInput[c];
+    }
+    dry.mono = dryInput[0];
+    if (inputChannels > 1)
+    {
+        foldToMono(dry.channels, inputChannels, dryMono, frames);
+        dry.mono = dryMono;
+    }
+
+    const size_t planes = std::max(inputChannels, outputChannels);
+    runChain(chains[activeChainIndex.load(std::memory_order_relaxed)], channels, planes, outputChannels, frames, dry,
+             sample, parallel);
+
+    if (fadePosition < CROSSFADE_SAMPLES)
+    {
+        float *fade[MAX_CHANNELS];
+        for (size_t c = 0; c < MAX_CHANNELS; ++c)
+            fade[c] = fadeInput[c];
+        for (size_t c = 0; c < inputChannels; ++c)
+            std::memcpy(fadeInput[c], dryInput[c], frames * sizeof(float));
+        runChain(chains[previousChainIndex], fade, MAX_CHANNELS, outputChannels, frames, dry, nullptr, parallel);
+
+        // A fade that ends mid-chunk leaves the rest to the incoming chain
+        const size_t start = fadePosition;
+        for (size_t c = 0; c < outputChannels; ++c)
+        {
+            float *out = channels[c];
+            const float *outgoing = fadeInput[c];
+            for (size_t i = 0, at = start; i < frames && at < CROSSFADE_SAMPLES; ++i, ++at)
+                out[i] = outgoing[i] * fadeGains[CROSSFADE_SAMPLES - at] + out[i] * fadeGains[at];
+        }
+        fadePosition = std::min(CROSSFADE_SAMPLES, start + frames);
+        if (fadePosition == CROSSFADE_SAMPLES)
+            fadingChainIndex.store(NO_CHAIN, std::memory_order_release);
+    }
+    processing.store(false, std::memory_order_release);
+}
+
+// Applies active effects to a sample
+void DigitalSignalChain::applyEffects(Sample &sample)
+{
+    float value = sample.getPcmValue();
+    float *channels[1] = {&value};
+    processChunk(channels, 1, 1, 1, &sample, false);
+    sample.setPcmValue(value);
+}
+
+void DigitalSignalChain::processBlock(float *samples, size_t frames)
+{
+    float *channels[1] = {samples};
+    processBlock(channels, 1, 1, frames);
+}
+
+void DigitalSignalChain::processBlock(float *const *channels, size_t inputChannels, size_t outputChannels, size_t frames)
+{
+    const size_t planes = std::max(inputChannels, outputChannels);
+    float *chunk[MAX_CHANNELS];
+    for (size_t done = 0; done < frames; done += MAX_BLOCK_SIZE)
+    {
+        for (size_t c = 0; c < planes; ++c)
+            chunk[c] = channels[c] + done;
+        processChunk(chunk, inputChannels, outputChannels, std::min(MAX_BLOCK_SIZE, frames - done), nullptr, true);
+    }
+}
+
+size_t DigitalSignalChain::loadPresets(const PresetBank &bank)
+{
+    std::lock_guard<std::recursive_mutex> lock(controlMutex);
+
+    // A preset chain still fading out is as audible as the playing one
+    if (activeChainIndex.load() != 0 || requestedChainIndex.load() != 0 || fadingChainIndex.load() != NO_CHAIN)
+    {
+        std::cerr << "[DigitalSignalChain] Cannot rebuild presets while one is playing\n";
+        return builtPresets;
+    }
+
+    presets.clear();
+    builtPresets = 0;
+
+    for (size_t i = 0; i < bank.size() && i < MAX_PRESETS; ++i)
+    {
+        Config snapshot;
+        bank[i].applyTo(snapshot);
+
+        Chain &chain = chains[i + 1];
+        buildChain(chain);
+        configureChain(chain, snapshot);
+        warmChain(chain);
+
+        presets.push_back(bank[i]);
+        ++builtPresets;
+        std::cout << "[DigitalSignalChain] Built preset " << i << ": " << bank[i].name << "\n";
+    }
+
+    if (bank.size() > MAX_PRESETS)
+    {
+        std::cerr << "[DigitalSignalChain] Only the first " << MAX_PRESETS << " presets were built\n";
+    }
+    return builtPresets;
+}
+
+bool DigitalSignalChain::selectPreset(size_t index, Config &config)
+{
+    std::lock_guard<std::recursive_mutex> lock(controlMutex);
+
+    if (index >= builtPresets)
+    {
+        std::cerr << "[DigitalSignalChain] No preset " << index << "\n";
+        return false;
+    }
+
+    const size_t chainIndex = index + 1;
+    presets[index].applyTo(config);
+
+    configureForSwitch(chainIndex, config);
+
+    requestedChainIndex.store(chainIndex, std::memory_order_release);
+    std::cout << "[DigitalSignalChain] Switching to preset " << index << ": " << presets[index].name << "\n";
+    return true;
+}
+
+void DigitalSignalChain::selectLiveChain(const Config &config)
+{
+    std::lock_guard<std::recursive_mutex> lock(controlMutex);
+
+    configureForSwitch(0, config);
+    requestedChainIndex.store(0, std::memory_order_release);
+    std::cout << "[DigitalSignalChain] Switching to the live chain\n";
+}
+
+void DigitalSignalChain::configureForSwitch(size_t chainIndex, const Config &config)
+{
+    // Only the requested chain can become active, and only the active one can start fading
+    // out, so a chain that is none of these three stays silent while it is reparsed
+    const bool audible = chainIndex == activeChainIndex.load() || chainIndex == requestedChainIndex.load() ||
+                         chainIndex == fadingChainIndex.load();
+    if (!audible)
+    {
+        configureChain(chains[chainIndex], config);
+        return;
+    }
+
+    const bool released = suspended.load();
+    suspendAudio();
+    configureChain(chains[chainIndex], config);
+    if (!released)
+        resumeAudio();
+}
+
+// Apply configuration to each effect
+void DigitalSignalChain::configureEffects(Config &config)
+{
+    std::lock_guard<std::recursive_mutex> lock(controlMutex);
+
+    if (!config.hasUpdate())
+        return;
+
+    // A changed "preset" key selects a preset rather than editing the current one
+    const uint64_t selector = config.revision("preset");
+    if (selector != presetRevision)
+    {
+        presetRevision = selector;
+        const int preset = config.get<int>("preset", -1);
+        if (config.contains("preset") && preset >= 0)
+            selectPreset(static_cast<size_t>(preset), config);
+        else
+            selectLiveChain(config);
+    }
+
+    Chain &chain = chains[requestedChainIndex.load()];
+    std::cout << "[DigitalSignalChain] Checking " << chain.count << " effect(s) for changes\n";
+    configureChain(chain, config);
 
     config.clearUpdate(); // Clear update flag after successful configuration
 }
@@ -2,20 +2,53 @@
 #define DIGITALSIGNALCHAIN_H
 
 #include <atomic>
+#include <functional>
+#include <limits>
+#include <mutex>
 #include <string>
 #include <memory>
+#include <utility>
+#include <vector>
+#include "BranchWorkers.h"
 #include "Effect.h"
+#include "EffectRegistry.h"
+#include "PresetBank.h"
+#include "RoutingGraph.h"
 #include "Sample.h"
+#include "TripleBuffer.h"
 
-constexpr size_t MAX_EFFECTS = 4; ///< Max number of effects in a signal chain
+constexpr size_t MAX_EFFECTS = EffectRegistry::slotCount; ///< One slot per registered or fused effect
+constexpr size_t MAX_PRESETS = 8;           ///< Max number of preset chains held in memory
+constexpr size_t CROSSFADE_SAMPLES = 512;   ///< Length of the equal-power crossfade on a chain switch
+constexpr size_t NO_CHAIN = static_cast<size_t>(-1); ///< fadingChainIndex when no fade is running
+constexpr size_t WARMUP_SAMPLES = 1024;     ///< Silence pushed through a preset chain when it is built
 
 /**
  * @class DigitalSignalChain
  * @brief Manages a hot-swappable chain of real-time-safe audio effects.
  *
- * This class supports atomic switching between two internal effect chains,
- * allowing effects to be loaded from a file and swapped in with no locking
- * or disruption to the audio processing loop.
+ * Chain 0 is built from the live configuration. Chains 1..MAX_PRESETS are
+ * fully built, pre-warmed copies for the presets of a PresetBank. Switching
+ * is requested from a control thread and picked up by the audio thread in
+ * O(1) (one atomic load and an index swap); the outgoing and incoming chains
+ * then run side by side for CROSSFADE_SAMPLES with an equal-power crossfade.
+ *
+ * Each chain runs its effects in the order given by the "route" config key (see
+ * RoutingGraph), or in registry order if it is not set. Parallel branches of a
+ * route are handed to helper threads when processing blocks.
+ *
+ * Signals are planar and carry up to MAX_CHANNELS channels. Each route buffer
+ * keeps its own channel count, adapted at every effect to the effect's
+ * ChannelLayout: a Stereo effect (e.g. panned Harmonizer voices) widens a mono
+ * signal, a Mono effect folds a wide one, and Any effects process the planes
+ * together in one pass. The result is folded or copied to the channels the
+ * caller asks for.
+ *
+ * Every effect is prepared for the stream's sample rate and block size when
+ * it is built and again whenever prepare() is given a new format (e.g. the
+ * codec runs at 48 kHz). Preparing happens on a control thread: the audio
+ * thread is kept out of the effects meanwhile, passing its input through
+ * rather than waiting, and never allocates.
  */
 class DigitalSignalChain
 {
@@ -32,30 +65,256 @@ public:
     void applyEffects(Sample &sample);
 
     /**
-     * @brief Updates all effects given a Config object
+     * @brief Processes a mono block of samples in place through the active chain.
+     *
+     * Forked route branches run on helper threads where available. A chain that
+     * widens the signal is folded back to mono.
+     * @param samples The samples to process.
+     * @param frames Number of samples.
+     */
+    void processBlock(float *samples, size_t frames);
+
+    /**
+     * @brief Processes a planar multichannel block in place through the active chain.
+     * @param channels max(inputChannels, outputChannels) planes of `frames` samples;
+     *        the first inputChannels hold the input.
+     * @param inputChannels Channels of the input (1..MAX_CHANNELS).
+     * @param outputChannels Channels written back (1..MAX_CHANNELS): the chain's
+     *        output is folded to mono or a mono output copied to match.
+     * @param frames Samples per plane.
+     */
+    void processBlock(float *const *channels, size_t inputChannels, size_t outputChannels, size_t frames);
+
+    /**
+     * @brief Prepares every effect of every built chain for a stream format, unless it already is.
+     *
+     * Allocates; call from a control thread. Mono effects are prepared for one
+     * channel and the rest for MAX_CHANNELS, since a stereo effect ahead of
+     * them can widen any signal. Blocks are capped at MAX_BLOCK_SIZE, the
+     * longest pass the chain makes. The audio thread passes its input through
+     * until the chains are ready.
+     * @param sampleRate Sample rate of the stream in Hz.
+     * @param maxBlockSize Most frames a processBlock() call will be given.
+     * @return true if the chains were prepared again.
+     */
+    bool prepare(float sampleRate, size_t maxBlockSize);
+
+    /**
+     * @brief Clears every effect's signal state (tails, envelopes, voices) without allocating.
+     */
+    void reset();
+
+    /**
+     * @brief Frees the effects' stream buffers. The audio thread passes its input
+     *        through until the chains are prepared again.
+     */
+    void release();
+
+    /**
+     * @brief Sample rate the chains were last prepared for (0 after release()).
+     */
+    float sampleRate() const { return preparedRate; }
+
+    /**
+     * @brief Updates effects whose configuration keys changed since the last call
+     *
+     * Changes go to the chain that is (or is about to become) active. A change of
+     * the "preset" key selects that preset instead.
      * @param config The Configuration object to be used.
      */
     void configureEffects(Config &config);
 
-private:
     /**
-     * @brief Registers all effects from factory
+     * @brief Builds and pre-warms one chain per preset (up to MAX_PRESETS).
+     *
+     * Allocates; call from a control thread. Refused while a preset chain is playing.
+     * @param bank The presets to build.
+     * @return Number of preset chains built.
      */
-    void registerAllEffects();
+    size_t loadPresets(const PresetBank &bank);
+
+    /**
+     * @brief Requests a crossfaded switch to a built preset chain.
+     *
+     * The preset's values are written into config so that later edits apply on
+     * top of it. The preset chain is brought in line with them before it
+     * becomes audible, so only values edited since it was built are re-parsed.
+     * @param index Preset index within the loaded bank.
+     * @param config The live configuration.
+     * @return false if no chain was built for that index.
+     */
+    bool selectPreset(size_t index, Config &config);
+
+    /**
+     * @brief Requests a crossfaded switch back to the live chain (chain 0).
+     *
+     * Used when the "preset" key is removed or set negative. The live chain is
+     * brought in line with config first, as a preset chain is by selectPreset().
+     * @param config The live configuration.
+     */
+    void selectLiveChain(const Config &config);
+
+    /**
+     * @brief Number of preset chains currently built.
+     */
+    size_t presetCount() const { return builtPresets; }
+
+    /**
+     * @brief Returns the live chain's instance of an effect, or nullptr if it has none.
+     */
+    Effect *getEffect(EffectId id) const;
+
+    /**
+     * @brief Returns the instance of an effect in the chain that is playing (or about to),
+     *        e.g. to drive a preset's Looper; nullptr if it has none.
+     *
+     * Shared, so the instance outlives a later loadPresets() rebuilding its chain.
+     */
+    std::shared_ptr<Effect> getPlayingEffect(EffectId id);
+
+    /**
+     * @brief Runs `setup` on every chain's instance of an effect, and on the instances
+     *        of chains built later by loadPresets() (e.g. to hand each Tuner to the display).
+     */
+    void forEachInstance(EffectId id, std::function<void(Effect &)> setup);
+
+    /**
+     * @brief Number of helper threads available to parallel route branches.
+     */
+    size_t helperThreads() const { return workers.size(); }
+
+private:
     struct EffectSlot
     {
-        std::shared_ptr<Effect> effect; ///< shared pointer to an effect (shared ownership lives elsewhere)
-        char name[64] = {0};      ///< Name of the effect for logging
+        std::shared_ptr<Effect> effect;     ///< shared pointer to an effect (shared ownership lives elsewhere)
+        EffectId id = INVALID_EFFECT_ID;    ///< Registry ID of the effect
+        const char *name = "";              ///< Registry name, for logging and Sample tagging
     };
 
     struct Chain
     {
-        EffectSlot effects[MAX_EFFECTS]; ///< Fixed array of effect slots
-        size_t count = 0;                ///< Number of active effects
+        EffectSlot effects[MAX_EFFECTS];  ///< Slots indexed by EffectId
+        size_t count = 0;                 ///< Number of slots filled
+        TripleBuffer<RouteSchedule> route; ///< Compiled route, published to the audio thread
+        uint64_t routeRevision = std::numeric_limits<uint64_t>::max(); ///< Revision of the "route" key compiled
+        std::vector<float> buffers;       ///< MAX_CHANNELS planes per route buffer, allocated once
+    };
+
+    /**
+     * @brief Unprocessed input of the chunk a chain runs on
+     */
+    struct DryInput
+    {
+        const float *channels[MAX_CHANNELS]; ///< Planes of the input
+        size_t count;                        ///< Channels in the input
+        const float *mono;                   ///< Mono fold of the input, handed to effects as their sidechain
+    };
+
+    /**
+     * @brief State shared by the threads running one pass of a chain's route
+     */
+    struct RouteRun
+    {
+        Chain *chain;
+        const RouteSchedule *schedule;
+        float *buffers[MAX_ROUTE_BUFFERS][MAX_CHANNELS];
+        size_t channels[MAX_ROUTE_BUFFERS]; ///< Channels each buffer currently carries
+        const float *input;                 ///< Mono fold of the chain's input (the effects' sidechain)
+        size_t frames;
     };
 
-    Chain chains[2];                      ///< Double buffer for hot-swapping
-    std::atomic<size_t> activeChainIndex; ///< Active chain index for lock-free switching
+    /**
+     * @brief Creates one instance of every registered and fused effect in a chain, in ID order
+     */
+    void buildChain(Chain &chain);
+
+    /**
+     * @brief Prepares every effect of a chain for the current stream format
+     */
+    void prepareChain(Chain &chain);
+
+    /**
+     * @brief Runs silence through a chain so its first audible block does not pay for cold memory
+     */
+    void warmChain(Chain &chain);
+
+    /**
+     * @brief Control thread: keeps the audio thread out of the effects, waiting for a block in progress
+     */
+    void suspendAudio();
+
+    /**
+     * @brief Control thread: lets the audio thread back into the effects
+     */
+    void resumeAudio();
+
+    /**
+     * @brief Recompiles the route (if its key changed) and reconfigures changed effects
+     */
+    void configureChain(Chain &chain, const Config &config);
+
+    /**
+     * @brief Brings a chain about to be switched to in line with config. A chain that is
+     *        playing, fading out or already requested is reparsed with the audio thread kept out.
+     */
+    void configureForSwitch(size_t chainIndex, const Config &config);
+
+    /**
+     * @brief Compiles the "route" key and publishes the schedule to the audio thread
+     */
+    void configureRoute(Chain &chain, const Config &config);
+
+    /**
+     * @brief Runs a chain's route over planar channels, recording applied effects on `sample` if given
+     * @param channels `planes` planes, the first dry.count holding the input; wider signals use the chain's own
+     * @param outputChannels Channels left in `channels` (at most `planes`)
+     * @param dry Unprocessed input: the effects' sidechain, and restored if an effect throws
+     * @param parallel Whether forked branches may go to helper threads
+     */
+    void runChain(Chain &chain, float *const *channels, size_t planes, size_t outputChannels, size_t frames,
+                  const DryInput &dry, Sample *sample, bool parallel);
+
+    /**
+     * @brief Executes steps [begin, end) of a route
+     */
+    static void runSteps(RouteRun &run, uint16_t begin, uint16_t end, Sample *sample, BranchWorkers *workers);
+
+    /**
+     * @brief BranchWorkers job: runs one forked branch
+     */
+    static void runBranch(void *context, uint16_t begin, uint16_t end);
+
+    /**
+     * @brief Processes up to MAX_BLOCK_SIZE frames, crossfading if a switch is in progress
+     */
+    void processChunk(float *const *channels, size_t inputChannels, size_t outputChannels, size_t frames,
+                      Sample *sample, bool parallel);
+
+    /**
+     * @brief Audio thread: adopts a pending chain switch if no crossfade is running
+     */
+    void pickUpChainSwitch();
+
+    Chain chains[MAX_PRESETS + 1];             ///< Live chain followed by the preset chains
+    std::atomic<size_t> activeChainIndex;      ///< Chain the audio thread is fading to / playing
+    std::atomic<size_t> requestedChainIndex;   ///< Chain requested by the control thread
+    size_t previousChainIndex = 0;             ///< Chain being faded out (audio thread only)
+    std::atomic<size_t> fadingChainIndex;      ///< previousChainIndex while a fade runs, NO_CHAIN otherwise
+    size_t fadePosition = CROSSFADE_SAMPLES;   ///< Crossfade progress, CROSSFADE_SAMPLES when idle
+    size_t builtPresets = 0;                   ///< Number of preset chains built
+    std::vector<Preset> presets;               ///< Presets the chains were built from
+    std::vector<std::pair<EffectId, std::function<void(Effect &)>>> instanceSetups; ///< Rerun by buildChain()
+    uint64_t presetRevision = 0;               ///< Last applied revision of the "preset" key
+    float fadeGains[CROSSFADE_SAMPLES + 1];    ///< sin(pi/2 * i/N); the outgoing gain reads it backwards
+    float dryInput[MAX_CHANNELS][MAX_BLOCK_SIZE];  ///< Copy of the current chunk's input
+    float dryMono[MAX_BLOCK_SIZE];                 ///< Mono fold of a multichannel input
+    float fadeInput[MAX_CHANNELS][MAX_BLOCK_SIZE]; ///< Input (then output) of the outgoing chain during a fade
+    float preparedRate = DEFAULT_SAMPLE_RATE;  ///< Stream format the effects are prepared for
+    size_t preparedBlock = MAX_BLOCK_SIZE;
+    std::atomic<bool> suspended{false};        ///< Audio thread passes its input through
+    std::atomic<bool> processing{false};       ///< Audio thread is inside processChunk()
+    std::recursive_mutex controlMutex;         ///< Serialises control threads (UI, config watcher)
+    BranchWorkers workers;                     ///< Declared last so its threads stop before the chains go
 };
 
 #endif // DIGITALSIGNALCHAIN_H
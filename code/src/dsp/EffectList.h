@@ -0,0 +1,15 @@
+#ifndef EFFECTLIST_H
+#define EFFECTLIST_H
+
+#include <cstddef>
+
+/**
+ * @brief Compile-time list of effect types.
+ */
+template <typename... Effects>
+struct EffectList
+{
+    static constexpr size_t size = sizeof...(Effects);
+};
+
+#endif // EFFECTLIST_H
@@ -1,50 +1,27 @@
 #pragma once
-#include "EffectFactory.h"
-#include <memory>
+#include "EffectRegistry.h"
 
 /**
- * @brief Automatically registers an Effect subclass with the EffectFactory at static initialization time.
+ * @brief Checks at compile time that an Effect subclass is listed in RegisteredEffects.
  *
- * This macro should be placed in the implementation file (.cpp) of an `Effect` subclass.
- * It ensures:
- *   - The effect is registered with the factory under its class name as a string.
- *   - A unique static initializer runs at program startup.
- *   - A visible linker symbol (`ForceLink_<CLASS_NAME>_Effect`) exists, allowing
- *     `ForceEffects()` to reference and include all available effects in the binary.
+ * Effects are no longer registered by static initialisers; the table in
+ * EffectRegistry.h is built from the RegisteredEffects type list. This macro
+ * stays in each effect's .cpp so that forgetting to add a new effect to that
+ * list is a build error rather than a silently missing effect.
  *
  * Example usage:
  * @code
  * class Gain : public Effect {
  * public:
- *     float process(float sample, float setting) override;
+ *     static constexpr const char *Name = "Gain";
+ *     float process(float sample) override;
  * };
  *
  * REGISTER_EFFECT_AUTO(Gain);
  * @endcode
  *
- * This makes `EffectFactory::createEffect("Gain")` valid at runtime.
- *
- * @param CLASS_NAME The name of the effect class to register.
+ * @param CLASS_NAME The name of the effect class.
  */
-#define REGISTER_EFFECT_AUTO(CLASS_NAME)                                      \
-    namespace {                                                               \
-        static void ensure_##CLASS_NAME##_registered() {                      \
-            static bool registered = [] {                                     \
-                EffectFactory::instance().registerEffect(#CLASS_NAME, [] {    \
-                    return std::make_shared<CLASS_NAME>();                    \
-                });                                                           \
-                return true;                                                  \
-            }();                                                              \
-            (void)registered;                                                 \
-        }                                                                     \
-        struct CLASS_NAME##_EffectRegistrar {                                 \
-            CLASS_NAME##_EffectRegistrar() { ensure_##CLASS_NAME##_registered(); } \
-        };                                                                    \
-        static CLASS_NAME##_EffectRegistrar CLASS_NAME##_registrar_instance; \
-                                                                              \
-        /**                                                                  \
-         * @brief Linkable symbol to ensure this effect is included in the binary. \
-         * Call ForceLink_<CLASS_NAME>_Effect() in ForceEffects.cpp to force inclusion. \
-         */                                                                   \
-        extern "C" void ForceLink_##CLASS_NAME##_Effect() {}                  \
-    }
+#define REGISTER_EFFECT_AUTO(CLASS_NAME)                                            \
+    static_assert(EffectRegistry::contains<CLASS_NAME>(),                           \
+                  #CLASS_NAME " must be added to RegisteredEffects in EffectRegistry.h")
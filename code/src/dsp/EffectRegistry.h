@@ -0,0 +1,212 @@
+#ifndef EFFECTREGISTRY_H
+#define EFFECTREGISTRY_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "Chorus.h"
+#include "Convolver.h"
+#include "Delay.h"
+#include "EQ.h"
+#include "Effect.h"
+#include "EffectList.h"
+#include "FusedChains.h"
+#include "Fuzz.h"
+#include "Gain.h"
+#include "Harmonizer.h"
+#include "Limiter.h"
+#include "Looper.h"
+#include "NoiseGate.h"
+#include "Reverb.h"
+#include "Tuner.h"
+#include "Waveshaper.h"
+
+/**
+ * @brief Every effect built into the pedal, in default chain order.
+ *
+ * An effect's ID is its position in this list. To add an effect, give the class
+ * a `static constexpr const char *Name` and append it here.
+ */
+using RegisteredEffects = EffectList<Fuzz, Gain, Harmonizer, Waveshaper, EQ, NoiseGate, Convolver, Chorus,
+                                      Delay, Reverb, Looper, Limiter, Tuner>;
+
+/**
+ * @brief StaticChains that stand in for a run of registered effects.
+ *
+ * Fused effects get IDs after the registered ones and are never run on their
+ * own: RoutingGraph substitutes one wherever a route names its stages in order.
+ */
+using FusedEffects = EffectList<GainFuzz>;
+
+using EffectId = uint8_t;                   ///< Index into the effect table
+constexpr EffectId INVALID_EFFECT_ID = 0xFF; ///< Returned when a name is not registered
+constexpr size_t MAX_FUSED_STAGES = 4;       ///< Longest StaticChain that can be listed in FusedEffects
+
+/**
+ * @struct EffectInfo
+ * @brief One row of the static effect table.
+ */
+struct EffectInfo
+{
+    EffectId id;                         ///< Position in RegisteredEffects
+    const char *name;                    ///< Class name, e.g. "Gain"
+    size_t size;                         ///< sizeof() the effect object
+    size_t alignment;                    ///< alignof() the effect object
+    std::shared_ptr<Effect> (*create)(); ///< Constructs a default instance
+    size_t stageCount;                   ///< Fused effects: number of stages, else 0
+    std::array<EffectId, MAX_FUSED_STAGES> stages; ///< Fused effects: IDs of the stages, in order
+};
+
+namespace effect_registry_detail
+{
+    template <typename E>
+    std::shared_ptr<Effect> create()
+    {
+        return std::make_shared<E>();
+    }
+
+    template <typename E, typename... Effects>
+    constexpr size_t indexOf(EffectList<Effects...>)
+    {
+        constexpr bool matches[] = {std::is_same_v<E, Effects>..., false};
+        size_t i = 0;
+        while (i < sizeof...(Effects) && !matches[i])
+            ++i;
+        return i;
+    }
+
+    template <typename E>
+    constexpr EffectInfo describe(size_t id, EffectList<>)
+    {
+        return EffectInfo{static_cast<EffectId>(id), E::Name, sizeof(E), alignof(E), &create<E>, 0, {}};
+    }
+
+    template <typename E, typename... Stages>
+    constexpr EffectInfo describe(size_t id, EffectList<Stages...>)
+    {
+        static_assert(sizeof...(Stages) <= MAX_FUSED_STAGES, "Raise MAX_FUSED_STAGES");
+        static_assert((... && (indexOf<Stages>(RegisteredEffects{}) < RegisteredEffects::size)),
+                      "Every stage of a fused effect must be in RegisteredEffects");
+        return EffectInfo{static_cast<EffectId>(id), E::Name, sizeof(E), alignof(E), &create<E>, sizeof...(Stages),
+                          {{static_cast<EffectId>(indexOf<Stages>(RegisteredEffects{}))...}}};
+    }
+
+    template <typename... Effects, size_t... Ids>
+    constexpr std::array<EffectInfo, sizeof...(Effects)> makeTable(EffectList<Effects...>, std::index_sequence<Ids...>)
+    {
+        return {{describe<Effects>(Ids, EffectList<>{})...}};
+    }
+
+    template <typename... Effects, size_t... Ids>
+    constexpr std::array<EffectInfo, sizeof...(Effects)> makeFusedTable(EffectList<Effects...>, std::index_sequence<Ids...>)
+    {
+        return {{describe<Effects>(RegisteredEffects::size + Ids, typename Effects::StageList{})...}};
+    }
+
+    constexpr bool sameName(const char *a, const char *b)
+    {
+        while (*a && *a == *b)
+        {
+            ++a;
+            ++b;
+        }
+        return *a == *b;
+    }
+
+    template <size_t N>
+    constexpr bool uniqueNames(const std::array<EffectInfo, N> &table)
+    {
+        for (size_t i = 0; i < N; ++i)
+            for (size_t j = i + 1; j < N; ++j)
+                if (sameName(table[i].name, table[j].name))
+                    return false;
+        return true;
+    }
+}
+
+/**
+ * @class EffectRegistry
+ * @brief Static table of all registered effects, built at compile time from RegisteredEffects.
+ *
+ * Replaces the old name-keyed factory map: there is no static initialisation,
+ * the table order is fixed, and the chain can refer to effects by EffectId.
+ */
+class EffectRegistry
+{
+public:
+    static constexpr size_t count = RegisteredEffects::size;       ///< Number of registered effects
+    static constexpr size_t fusedCount = FusedEffects::size;       ///< Number of fused effects
+    static constexpr size_t slotCount = count + fusedCount;         ///< IDs in use (registered, then fused)
+
+    static_assert(slotCount < INVALID_EFFECT_ID, "Too many effects for EffectId");
+
+    /**
+     * @brief The full table, indexed by EffectId.
+     */
+    static constexpr std::array<EffectInfo, count> table =
+        effect_registry_detail::makeTable(RegisteredEffects{}, std::make_index_sequence<count>{});
+
+    /**
+     * @brief Fused effects; fused[i] has ID count + i.
+     */
+    static constexpr std::array<EffectInfo, fusedCount> fused =
+        effect_registry_detail::makeFusedTable(FusedEffects{}, std::make_index_sequence<fusedCount>{});
+
+    /**
+     * @brief True if E appears in RegisteredEffects.
+     */
+    template <typename E>
+    static constexpr bool contains()
+    {
+        return effect_registry_detail::indexOf<E>(RegisteredEffects{}) < count;
+    }
+
+    /**
+     * @brief Compile-time ID of effect type E.
+     */
+    template <typename E>
+    static constexpr EffectId idOf()
+    {
+        static_assert(contains<E>(), "Effect is not listed in RegisteredEffects");
+        return static_cast<EffectId>(effect_registry_detail::indexOf<E>(RegisteredEffects{}));
+    }
+
+    /**
+     * @brief Looks up an effect by name (e.g. from a config file).
+     * @return The effect's ID, or INVALID_EFFECT_ID if it is not registered.
+     */
+    static constexpr EffectId find(const char *name)
+    {
+        for (const auto &info : table)
+        {
+            if (effect_registry_detail::sameName(info.name, name))
+                return info.id;
+        }
+        return INVALID_EFFECT_ID;
+    }
+
+    /**
+     * @brief Table row for any ID, registered or fused.
+     */
+    static constexpr const EffectInfo &info(EffectId id)
+    {
+        return id < count ? table[id] : fused[id - count];
+    }
+
+    /**
+     * @brief Creates a default instance of an effect.
+     * @return nullptr if id is not in use.
+     */
+    static std::shared_ptr<Effect> create(EffectId id)
+    {
+        return id < slotCount ? info(id).create() : nullptr;
+    }
+};
+
+static_assert(effect_registry_detail::uniqueNames(EffectRegistry::table), "Two registered effects share a Name");
+static_assert(effect_registry_detail::uniqueNames(EffectRegistry::fused), "Two fused effects share a Name");
+
+#endif // EFFECTREGISTRY_H
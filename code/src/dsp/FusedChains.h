@@ -0,0 +1,16 @@
+#ifndef FUSEDCHAINS_H
+#define FUSEDCHAINS_H
+
+#include "Fuzz.h"
+#include "Gain.h"
+#include "StaticChain.h"
+
+/**
+ * @brief Gain followed by Fuzz (boost into clipper), the most common pairing.
+ */
+struct GainFuzz : StaticChain<Gain, Fuzz>
+{
+    static constexpr const char *Name = "Gain+Fuzz"; ///< Name in the effect registry
+};
+
+#endif // FUSEDCHAINS_H
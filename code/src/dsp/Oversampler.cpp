@@ -0,0 +1,146 @@
+#include "Oversampler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr size_t FACTORS[] = {2, 4, 8};
+    constexpr size_t QUALITIES = 3;
+
+    size_t tapsFor(OversampleQuality quality)
+    {
+        switch (quality)
+        {
+        case OversampleQuality::Low:
+            return 8;
+        case OversampleQuality::High:
+            return 32;
+        default:
+            return 16;
+        }
+    }
+
+    double kaiserBeta(OversampleQuality quality)
+    {
+        switch (quality)
+        {
+        case OversampleQuality::Low:
+            return 5.0; // ~ -55 dB stopband
+        case OversampleQuality::High:
+            return 10.0; // ~ -100 dB
+        default:
+            return 8.0; // ~ -80 dB
+        }
+    }
+
+    // Zeroth-order modified Bessel function of the first kind (power series)
+    double besselI0(double x)
+    {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 50; ++k)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+            if (term < 1e-12 * sum)
+                break;
+        }
+        return sum;
+    }
+
+    Oversampler::Filter makeFilter(size_t factor, OversampleQuality quality)
+    {
+        Oversampler::Filter filter;
+        filter.factor = factor;
+        filter.taps = tapsFor(quality);
+
+        const size_t length = factor * filter.taps;
+        const double centre = (length - 1) / 2.0;
+        const double cutoff = 0.45 / factor; // Cycles per oversampled sample: 90% of the base Nyquist
+        const double beta = kaiserBeta(quality);
+
+        std::vector<double> h(length);
+        double sum = 0.0;
+        for (size_t i = 0; i < length; ++i)
+        {
+            const double t = i - centre;
+            const double sinc = t == 0.0 ? 2.0 * cutoff : std::sin(2.0 * M_PI * cutoff * t) / (M_PI * t);
+            const double ratio = t / (centre + 0.5);
+            const double window = besselI0(beta * std::sqrt(std::max(0.0, 1.0 - ratio * ratio))) / besselI0(beta);
+            h[i] = sinc * window;
+            sum += h[i];
+        }
+
+        filter.down.resize(length);
+        filter.up.resize(length);
+        for (size_t p = 0; p < factor; ++p)
+        {
+            for (size_t k = 0; k < filter.taps; ++k)
+            {
+                const double tap = h[p + factor * k] / sum;
+                filter.down[p * filter.taps + k] = static_cast<float>(tap);
+                // Zero-stuffing loses a factor L of energy; the interpolator puts it back
+                filter.up[p * filter.taps + k] = static_cast<float>(factor * tap);
+            }
+        }
+        return filter;
+    }
+}
+
+Oversampler::Oversampler()
+{
+    design(2, OversampleQuality::Medium); // Build the shared tables off the audio thread
+}
+
+const Oversampler::Filter &Oversampler::design(size_t factor, OversampleQuality quality)
+{
+    static const std::vector<Filter> filters = [] {
+        std::vector<Filter> all;
+        for (size_t f : FACTORS)
+            for (size_t q = 0; q < QUALITIES; ++q)
+                all.push_back(makeFilter(f, static_cast<OversampleQuality>(q)));
+        return all;
+    }();
+
+    const size_t index = factor == 2 ? 0 : factor == 4 ? 1 : 2;
+    return filters[index * QUALITIES + static_cast<size_t>(quality)];
+}
+
+bool Oversampler::isSupported(size_t factor)
+{
+    return factor == 1 || factor == 2 || factor == 4 || factor == 8;
+}
+
+OversampleQuality Oversampler::parseQuality(const std::string &name)
+{
+    if (name == "low")
+        return OversampleQuality::Low;
+    if (name == "high")
+        return OversampleQuality::High;
+    return OversampleQuality::Medium;
+}
+
+void Oversampler::select(size_t factor, OversampleQuality quality)
+{
+    if (factor == this->factor() && (factor == 1 || quality == selectedQuality))
+        return;
+
+    selectedQuality = quality;
+    filter = (factor > 1 && isSupported(factor)) ? &design(factor, quality) : nullptr;
+    reset();
+}
+
+size_t Oversampler::latency() const
+{
+    if (!filter)
+        return 0;
+    // Two linear-phase filters of N = L*T taps delay by N - 1 oversampled samples; each
+    // output is taken at the last of its L oversampled samples, which wins back L - 1
+    return filter->taps - 1;
+}
+
+void Oversampler::reset()
+{
+    std::fill(std::begin(input), std::end(input), 0.0f);
+    for (auto &phase : phases)
+        std::fill(std::begin(phase), std::end(phase), 0.0f);
+}
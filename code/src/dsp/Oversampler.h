@@ -0,0 +1,163 @@
+#ifndef OVERSAMPLER_H
+#define OVERSAMPLER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Anti-imaging/anti-aliasing filter length for an Oversampler.
+ */
+enum class OversampleQuality : uint8_t
+{
+    Low,    ///< 8 taps per phase
+    Medium, ///< 16 taps per phase
+    High,   ///< 32 taps per phase
+};
+
+/**
+ * @class Oversampler
+ * @brief Polyphase 2x/4x/8x up/down-sampling around a nonlinear per-sample kernel.
+ *
+ * Usage from an effect's processBlock():
+ * @code
+ * oversampler.select(factor, quality);
+ * oversampler.process(samples, count, kernel);
+ * @endcode
+ * The kernel (any `float(float)` callable) runs at factor x the sample rate
+ * between a polyphase interpolator and a polyphase decimator that share one
+ * Kaiser-windowed sinc low-pass. Filters for every factor and quality are
+ * designed once and shared; history buffers are sized for the largest
+ * configuration, so select() never allocates and is safe on the audio thread.
+ * Work is done a CHUNK at a time in three passes (interpolate, kernel,
+ * decimate). The oversampled signal is kept split into its L phases, so each
+ * filter tap is one multiply-add across the whole chunk: every inner loop is
+ * a contiguous, reduction-free loop that the compiler vectorises.
+ */
+class Oversampler
+{
+public:
+    static constexpr size_t MAX_FACTOR = 8; ///< Largest supported factor
+    static constexpr size_t MAX_TAPS = 32;  ///< Taps per phase at High quality
+    static constexpr size_t CHUNK = 64;     ///< Base-rate samples filtered per pass
+
+    /**
+     * @brief One designed filter, shared by every Oversampler.
+     */
+    struct Filter
+    {
+        size_t factor = 1;      ///< Oversampling factor L
+        size_t taps = 0;        ///< Taps per phase T (full filter is L * T)
+        std::vector<float> up;   ///< Interpolator phases: up[p * T + k] = L * h[p + L * k]
+        std::vector<float> down; ///< Decimator phases: down[r * T + k] = h[r + L * k]
+    };
+
+    Oversampler();
+
+    /**
+     * @brief Picks the factor and quality; clears the filter history if they changed.
+     *        Unsupported factors fall back to 1 (no oversampling).
+     */
+    void select(size_t factor, OversampleQuality quality);
+
+    /**
+     * @brief Current factor (1 = kernel runs at the base rate).
+     */
+    size_t factor() const { return filter ? filter->factor : 1; }
+
+    /**
+     * @brief Added latency in base-rate samples.
+     */
+    size_t latency() const;
+
+    /**
+     * @brief Clears the filter history.
+     */
+    void reset();
+
+    /**
+     * @brief Runs `kernel` on the signal at the selected rate, in place.
+     */
+    template <typename Kernel>
+    void process(float *samples, size_t count, const Kernel &kernel);
+
+    /**
+     * @brief True for 1, 2, 4 and 8.
+     */
+    static bool isSupported(size_t factor);
+
+    /**
+     * @brief Parses "low", "medium" or "high" (anything else is Medium).
+     */
+    static OversampleQuality parseQuality(const std::string &name);
+
+private:
+    /**
+     * @brief out[i] += gain * in[i] for i < n; the inner loop of every filter
+     */
+    static void multiplyAdd(float *out, const float *in, float gain, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+            out[i] += gain * in[i];
+    }
+
+    static const Filter &design(size_t factor, OversampleQuality quality);
+
+    const Filter *filter = nullptr;                 ///< nullptr = factor 1
+    OversampleQuality selectedQuality = OversampleQuality::Medium;
+    static constexpr size_t SPAN = MAX_TAPS - 1 + CHUNK; ///< T - 1 samples of history, then the chunk
+
+    float input[SPAN] = {};                   ///< Base-rate input
+    float phases[MAX_FACTOR][SPAN] = {};      ///< Oversampled signal: phases[p][i] is sample i * L + p
+    float output[CHUNK] = {};                 ///< Decimator accumulator
+};
+
+template <typename Kernel>
+void Oversampler::process(float *samples, size_t count, const Kernel &kernel)
+{
+    if (!filter)
+    {
+        for (size_t i = 0; i < count; ++i)
+            samples[i] = kernel(samples[i]);
+        return;
+    }
+
+    const size_t L = filter->factor;
+    const size_t T = filter->taps;
+    const float *up = filter->up.data();
+    const float *down = filter->down.data();
+
+    for (size_t done = 0; done < count; done += CHUNK)
+    {
+        const size_t n = std::min(CHUNK, count - done);
+        float *block = samples + done;
+        std::copy(block, block + n, input + T - 1);
+
+        // Interpolate, then shape: phases[p][i] = kernel(sum_k L h[p + L k] x[i - k])
+        for (size_t p = 0; p < L; ++p)
+        {
+            float *phase = phases[p] + T - 1;
+            std::fill(phase, phase + n, 0.0f);
+            for (size_t k = 0; k < T; ++k)
+                multiplyAdd(phase, input + T - 1 - k, up[p * T + k], n);
+            for (size_t i = 0; i < n; ++i)
+                phase[i] = kernel(phase[i]);
+        }
+
+        // Decimate, keeping the last oversampled sample of each input sample:
+        // y[i] = sum_r sum_k h[r + L k] phases[L - 1 - r][i - k]
+        std::fill(output, output + n, 0.0f);
+        for (size_t r = 0; r < L; ++r)
+            for (size_t k = 0; k < T; ++k)
+                multiplyAdd(output, phases[L - 1 - r] + T - 1 - k, down[r * T + k], n);
+        std::copy(output, output + n, block);
+
+        std::copy(input + n, input + n + T - 1, input);
+        for (size_t p = 0; p < L; ++p)
+            std::copy(phases[p] + n, phases[p] + n + T - 1, phases[p]);
+    }
+}
+
+#endif // OVERSAMPLER_H
@@ -0,0 +1,150 @@
+#include "PartitionCache.h"
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ull;
+    constexpr uint64_t FNV_PRIME = 0x100000001b3ull;
+
+    void put(uint8_t *at, uint64_t value, size_t bytes)
+    {
+        for (size_t i = 0; i < bytes; ++i)
+            at[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+
+    uint64_t get(const uint8_t *at, size_t bytes)
+    {
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; ++i)
+            value |= static_cast<uint64_t>(at[i]) << (8 * i);
+        return value;
+    }
+
+    // Header field offsets
+    constexpr size_t MAGIC = 0, VERSION = 4, HEADER = 6, HASH = 8, RATE = 16, PARTITION = 20, TAPS = 24,
+                     PARTITIONS = 28;
+
+    size_t floatsFor(size_t partitionSize, size_t partitions)
+    {
+        return partitionSize + 2 * partitions * (partitionSize + 1);
+    }
+}
+
+PartitionCache::PartitionCache(void *address, size_t length, const PartitionSpectra &view)
+    : address(address), length(length), view(view)
+{
+}
+
+PartitionCache::~PartitionCache()
+{
+    munmap(address, length);
+}
+
+std::string PartitionCache::pathFor(const std::string &irPath, const PartitionCacheKey &key)
+{
+    return irPath + "." + std::to_string(key.sampleRate) + "-" + std::to_string(key.partitionSize) + ".irc";
+}
+
+bool PartitionCache::hashFile(const std::string &path, uint64_t &hash)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    uint64_t h = FNV_OFFSET;
+    char buffer[1 << 16];
+    while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0)
+    {
+        const std::streamsize n = file.gcount();
+        for (std::streamsize i = 0; i < n; ++i)
+            h = (h ^ static_cast<uint8_t>(buffer[i])) * FNV_PRIME;
+    }
+    hash = h;
+    return true;
+}
+
+std::shared_ptr<const PartitionCache> PartitionCache::map(const std::string &path, const PartitionCacheKey &key)
+{
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < HEADER_SIZE)
+    {
+        close(fd);
+        return nullptr;
+    }
+    const size_t length = static_cast<size_t>(info.st_size);
+
+    // Populate now: the audio thread will read these pages and must not fault
+    void *address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED)
+        return nullptr;
+
+    const uint8_t *bytes = static_cast<const uint8_t *>(address);
+    const size_t partitionSize = get(bytes + PARTITION, 4);
+    const size_t taps = get(bytes + TAPS, 4);
+    const size_t partitions = get(bytes + PARTITIONS, 4);
+    const bool valid =
+        get(bytes + MAGIC, 4) == FILE_MAGIC && get(bytes + VERSION, 2) == FILE_VERSION &&
+        get(bytes + HEADER, 2) == HEADER_SIZE && get(bytes + HASH, 8) == key.hash &&
+        get(bytes + RATE, 4) == key.sampleRate && partitionSize == key.partitionSize && partitionSize >= 4 &&
+        (partitionSize & (partitionSize - 1)) == 0 &&
+        partitions == (taps > partitionSize ? (taps - 1) / partitionSize : 0) &&
+        length == HEADER_SIZE + sizeof(float) * floatsFor(partitionSize, partitions);
+    if (!valid)
+    {
+        munmap(address, length);
+        return nullptr;
+    }
+
+    const float *head = reinterpret_cast<const float *>(bytes + HEADER_SIZE);
+    const float *re = head + partitionSize;
+    const float *im = re + partitions * (partitionSize + 1);
+    const PartitionSpectra view{partitionSize, taps, partitions, head, re, im};
+    return std::shared_ptr<const PartitionCache>(new PartitionCache(address, length, view));
+}
+
+bool PartitionCache::write(const std::string &path, const PartitionCacheKey &key, const PartitionSpectra &spectra)
+{
+    uint8_t header[HEADER_SIZE] = {};
+    put(header + MAGIC, FILE_MAGIC, 4);
+    put(header + VERSION, FILE_VERSION, 2);
+    put(header + HEADER, HEADER_SIZE, 2);
+    put(header + HASH, key.hash, 8);
+    put(header + RATE, key.sampleRate, 4);
+    put(header + PARTITION, spectra.partitionSize, 4);
+    put(header + TAPS, spectra.taps, 4);
+    put(header + PARTITIONS, spectra.partitions, 4);
+
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+
+        const size_t bins = spectra.partitions * (spectra.partitionSize + 1);
+        file.write(reinterpret_cast<const char *>(header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(spectra.head), sizeof(float) * spectra.partitionSize);
+        file.write(reinterpret_cast<const char *>(spectra.re), sizeof(float) * bins);
+        file.write(reinterpret_cast<const char *>(spectra.im), sizeof(float) * bins);
+        if (!file.flush())
+        {
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,90 @@
+#ifndef PARTITIONCACHE_H
+#define PARTITIONCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "PartitionedConvolution.h"
+
+/**
+ * @struct PartitionCacheKey
+ * @brief What a cached set of partitions was built from.
+ */
+struct PartitionCacheKey
+{
+    uint64_t hash = 0;           ///< PartitionCache::hashFile() of the IR
+    uint32_t sampleRate = 0;     ///< Rate the IR was resampled to
+    uint32_t partitionSize = 0;  ///< Partition length B
+};
+
+/**
+ * @class PartitionCache
+ * @brief A PartitionedConvolution filter saved next to its IR and memory-mapped back.
+ *
+ * Transforming (and resampling) a long IR takes far longer than a preset switch
+ * should, so the prepared spectra are written once to a cache file beside the
+ * IR, named after the rate and partition size (e.g. cab.wav.44100-128.irc).
+ * Later loads map the file read-only with the pages populated up front (the
+ * audio thread must never take a page fault) and the engine reads the spectra
+ * straight from the mapping.
+ *
+ * File layout (native floats and little-endian integers; HEADER_SIZE bytes of
+ * header, so the float data is 64-byte aligned):
+ * @code
+ * u32 magic "SIRC" | u16 version | u16 header size | u64 IR hash | u32 sample rate
+ * u32 partition size B | u32 taps | u32 partitions P | zero padding
+ * f32 head[B] | f32 re[P * (B + 1)] | f32 im[P * (B + 1)]
+ * @endcode
+ * A file with another version, key or size is ignored and rewritten. Bump
+ * FILE_VERSION whenever RealFFT's output or the spectra layout changes.
+ */
+class PartitionCache
+{
+public:
+    static constexpr uint32_t FILE_MAGIC = 0x43524953; ///< "SIRC"
+    static constexpr uint16_t FILE_VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 64;
+
+    PartitionCache(const PartitionCache &) = delete;
+    PartitionCache &operator=(const PartitionCache &) = delete;
+    ~PartitionCache();
+
+    /**
+     * @brief Cache file for an IR at a given rate and partition size.
+     */
+    static std::string pathFor(const std::string &irPath, const PartitionCacheKey &key);
+
+    /**
+     * @brief 64-bit FNV-1a hash of a file's bytes.
+     * @return false if the file cannot be read.
+     */
+    static bool hashFile(const std::string &path, uint64_t &hash);
+
+    /**
+     * @brief Maps a cache file written for `key`.
+     * @return nullptr if it is missing, truncated, of another version or for another key.
+     */
+    static std::shared_ptr<const PartitionCache> map(const std::string &path, const PartitionCacheKey &key);
+
+    /**
+     * @brief Writes a filter to a cache file (via a temporary file and a rename, so a
+     *        crash never leaves a half-written cache behind).
+     * @return true on success.
+     */
+    static bool write(const std::string &path, const PartitionCacheKey &key, const PartitionSpectra &spectra);
+
+    /**
+     * @brief The mapped filter; valid while this object lives.
+     */
+    const PartitionSpectra &spectra() const { return view; }
+
+private:
+    PartitionCache(void *address, size_t length, const PartitionSpectra &view);
+
+    void *address;          ///< Start of the mapping
+    size_t length;          ///< Bytes mapped
+    PartitionSpectra view;  ///< Pointers into the mapping
+};
+
+#endif // PARTITIONCACHE_H
@@ -0,0 +1,139 @@
+#include "PartitionedConvolution.h"
+#include <algorithm>
+
+PartitionedConvolution::PartitionedConvolution(const std::vector<float> &impulse, size_t partitionSize)
+    : size(partitionSize), taps(impulse.size()),
+      partitions(impulse.size() > partitionSize ? (impulse.size() - 1) / partitionSize : 0),
+      bins(partitionSize + 1), fft(2 * partitionSize)
+{
+    // One block: head, then every partition's real parts, then their imaginary parts
+    owned.assign(size + 2 * partitions * bins, 0.0f);
+    float *head = owned.data();
+    float *re = head + size;
+    float *im = re + partitions * bins;
+    std::copy(impulse.begin(), impulse.begin() + std::min(taps, size), head);
+
+    // Tail partition p (from 1) is taps [pB, (p + 1)B), zero-padded to 2B. The 1 / 2B of
+    // the unnormalised inverse FFT is folded in here.
+    const float scale = 1.0f / (2 * size);
+    scratch.resize(2 * size);
+    for (size_t p = 0; p < partitions; ++p)
+    {
+        std::fill(scratch.begin(), scratch.end(), 0.0f);
+        const size_t start = (p + 1) * size;
+        const size_t end = std::min(start + size, taps);
+        for (size_t i = start; i < end; ++i)
+            scratch[i - start] = impulse[i] * scale;
+        fft.forward(scratch.data(), re + p * bins, im + p * bins);
+    }
+
+    filter = {size, taps, partitions, head, re, im};
+    allocateState();
+}
+
+PartitionedConvolution::PartitionedConvolution(const PartitionSpectra &prepared, std::shared_ptr<const void> storage)
+    : size(prepared.partitionSize), taps(prepared.taps), partitions(prepared.partitions),
+      bins(prepared.partitionSize + 1), fft(2 * prepared.partitionSize), filter(prepared),
+      storage(std::move(storage))
+{
+    allocateState();
+}
+
+void PartitionedConvolution::allocateState()
+{
+    spectraRe.resize(partitions * bins);
+    spectraIm.resize(partitions * bins);
+    sumRe.resize(bins);
+    sumIm.resize(bins);
+    input.resize(2 * size);
+    tail.resize(size);
+    scratch.resize(2 * size);
+    reset();
+}
+
+void PartitionedConvolution::reset()
+{
+    std::fill(spectraRe.begin(), spectraRe.end(), 0.0f);
+    std::fill(spectraIm.begin(), spectraIm.end(), 0.0f);
+    std::fill(sumRe.begin(), sumRe.end(), 0.0f);
+    std::fill(sumIm.begin(), sumIm.end(), 0.0f);
+    std::fill(input.begin(), input.end(), 0.0f);
+    std::fill(tail.begin(), tail.end(), 0.0f);
+    fill = 0;
+    newest = 0;
+    accumulated = 0;
+}
+
+void PartitionedConvolution::process(float *samples, size_t count)
+{
+    const size_t headTaps = std::min(taps, size);
+    for (size_t done = 0; done < count;)
+    {
+        const size_t n = std::min(count - done, size - fill);
+        float *block = samples + done;
+        float *current = input.data() + size + fill;
+        std::copy(block, block + n, current);
+
+        // Head, in the time domain: y[i] = tail[i] + sum_k h[k] x[i - k]
+        std::copy(tail.begin() + fill, tail.begin() + fill + n, block);
+        for (size_t k = 0; k < headTaps; ++k)
+            multiplyAdd(block, current - k, filter.head[k], n);
+
+        fill += n;
+        done += n;
+        if (partitions > 1)
+            accumulate((partitions - 1) * fill / size);
+        if (fill == size)
+        {
+            boundary();
+            fill = 0;
+        }
+    }
+}
+
+void PartitionedConvolution::accumulate(size_t target)
+{
+    // During input block m the newest spectrum is X_(m-1); the term for tail partition
+    // p = q + 2 of output block m + 1 is H_p * X_(m-1-q)
+    for (; accumulated < target; ++accumulated)
+    {
+        const size_t slot = (newest + partitions - accumulated) % partitions;
+        const float *hr = filter.re + (accumulated + 1) * bins;
+        const float *hi = filter.im + (accumulated + 1) * bins;
+        const float *xr = spectraRe.data() + slot * bins;
+        const float *xi = spectraIm.data() + slot * bins;
+        for (size_t k = 0; k < bins; ++k)
+        {
+            sumRe[k] += hr[k] * xr[k] - hi[k] * xi[k];
+            sumIm[k] += hr[k] * xi[k] + hi[k] * xr[k];
+        }
+    }
+}
+
+void PartitionedConvolution::boundary()
+{
+    if (partitions > 0)
+    {
+        newest = (newest + 1) % partitions;
+        float *xr = spectraRe.data() + newest * bins;
+        float *xi = spectraIm.data() + newest * bins;
+        fft.forward(input.data(), xr, xi);
+
+        accumulate(partitions - 1);
+        const float *hr = filter.re;
+        const float *hi = filter.im;
+        for (size_t k = 0; k < bins; ++k)
+        {
+            sumRe[k] += hr[k] * xr[k] - hi[k] * xi[k];
+            sumIm[k] += hr[k] * xi[k] + hi[k] * xr[k];
+        }
+
+        // Overlap-save: the second half of the circular convolution is the linear one
+        fft.inverse(sumRe.data(), sumIm.data(), scratch.data());
+        std::copy(scratch.begin() + size, scratch.end(), tail.begin());
+        std::fill(sumRe.begin(), sumRe.end(), 0.0f);
+        std::fill(sumIm.begin(), sumIm.end(), 0.0f);
+        accumulated = 0;
+    }
+    std::copy(input.begin() + size, input.end(), input.begin());
+}
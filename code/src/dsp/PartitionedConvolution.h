@@ -0,0 +1,129 @@
+#ifndef PARTITIONEDCONVOLUTION_H
+#define PARTITIONEDCONVOLUTION_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "RealFFT.h"
+
+/**
+ * @struct PartitionSpectra
+ * @brief A prepared impulse response: the head taps and the spectra of the tail partitions.
+ *
+ * Tail partition p (from 0) covers taps [(p + 1)B, (p + 2)B), zero-padded to 2B,
+ * transformed by RealFFT and scaled by 1 / 2B; its B + 1 bins start at
+ * re/im + p * (B + 1). The arrays belong to whoever produced the view.
+ */
+struct PartitionSpectra
+{
+    size_t partitionSize = 0;  ///< B
+    size_t taps = 0;           ///< Impulse response length
+    size_t partitions = 0;     ///< Tail partitions
+    const float *head = nullptr; ///< First B taps (zero-padded)
+    const float *re = nullptr;   ///< partitions x (B + 1) real parts
+    const float *im = nullptr;   ///< partitions x (B + 1) imaginary parts
+};
+
+/**
+ * @class PartitionedConvolution
+ * @brief Zero-latency convolution with a long impulse response (e.g. a speaker cabinet).
+ *
+ * The impulse response is cut into partitions of B samples. The first (the
+ * head) is applied directly in the time domain, so the output has no added
+ * latency. The rest (the tail) use uniformly partitioned overlap-save (UPOLS):
+ * every B input samples, the last 2B are transformed once and pushed onto a
+ * frequency-domain delay line, and the next B samples of tail output are the
+ * inverse transform of sum_p H_p * X_(m+1-p) (the last B samples of it).
+ *
+ * Only the p = 1 term needs the newest spectrum; the products for p >= 2 use
+ * spectra that already exist, so they are accumulated a few partitions at a
+ * time as samples arrive. The work at each partition boundary is then one
+ * forward FFT, one complex multiply-add and one inverse FFT whatever the IR
+ * length, and the cost of a period barely depends on where its boundaries fall.
+ *
+ * Everything is allocated by the constructor; process() never allocates. The
+ * filter can also be adopted ready-made (e.g. memory-mapped by a PartitionCache),
+ * in which case only the state is allocated and nothing is transformed.
+ */
+class PartitionedConvolution
+{
+public:
+    /**
+     * @param impulse Impulse response (any length; empty is silence).
+     * @param partitionSize Partition length B, a power of two of at least 4.
+     */
+    PartitionedConvolution(const std::vector<float> &impulse, size_t partitionSize);
+
+    /**
+     * @brief Uses prepared spectra in place, without copying them.
+     * @param storage Kept alive for as long as the engine (it owns the spectra's memory).
+     */
+    PartitionedConvolution(const PartitionSpectra &prepared, std::shared_ptr<const void> storage);
+
+    /**
+     * @brief Replaces samples with the input convolved with the impulse response.
+     */
+    void process(float *samples, size_t count);
+
+    /**
+     * @brief Clears the input history and any tail in flight.
+     */
+    void reset();
+
+    /**
+     * @brief The filter, e.g. to save it to a PartitionCache.
+     */
+    const PartitionSpectra &spectra() const { return filter; }
+
+    size_t partitionSize() const { return size; }
+    size_t length() const { return taps; }                 ///< Impulse response length
+    size_t tailPartitions() const { return partitions; }   ///< FFT partitions after the head
+
+private:
+    /**
+     * @brief out[i] += gain * in[i] for i < n; the inner loop of the head filter
+     */
+    static void multiplyAdd(float *out, const float *in, float gain, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+            out[i] += gain * in[i];
+    }
+
+    /**
+     * @brief Adds tail partitions 2.. to the accumulator until `target` of them are in.
+     */
+    void accumulate(size_t target);
+
+    /**
+     * @brief End of an input block: transform it and produce the next block of tail output.
+     */
+    void boundary();
+
+    /**
+     * @brief Sizes the state for the filter's partitions and clears it.
+     */
+    void allocateState();
+
+    size_t size;           ///< Partition length B
+    size_t taps;           ///< Impulse response length
+    size_t partitions;     ///< Tail partitions P
+    size_t bins;           ///< Spectrum bins of a 2B FFT
+    RealFFT fft;
+
+    PartitionSpectra filter;          ///< Head and tail spectra, in owned or storage
+    std::vector<float> owned;         ///< Filter memory when built from an impulse
+    std::shared_ptr<const void> storage; ///< Filter memory when adopted
+    std::vector<float> spectraRe; ///< Input spectra (frequency-domain delay line), P x bins
+    std::vector<float> spectraIm;
+    std::vector<float> sumRe;     ///< Tail spectrum of the next output block, being accumulated
+    std::vector<float> sumIm;
+    std::vector<float> input;     ///< Previous and current input blocks (2B); the head reads its history here
+    std::vector<float> tail;      ///< Tail output for the current block (B)
+    std::vector<float> scratch;   ///< Inverse FFT output (2B)
+
+    size_t fill = 0;        ///< Samples of the current block received
+    size_t newest = 0;      ///< Delay line slot of the newest input spectrum
+    size_t accumulated = 0; ///< Tail partitions (from p = 2) already summed for the next block
+};
+
+#endif // PARTITIONEDCONVOLUTION_H
@@ -0,0 +1,176 @@
+#include "PitchDetector.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr double SILENCE = 1e-8;  ///< Mean square below which a frame has no pitch (-80 dBFS)
+    constexpr size_t MIN_WINDOW = 64;
+
+    size_t clampDecimation(size_t decimation)
+    {
+        return std::min(std::max(decimation, size_t(1)), PitchDetector::MAX_DECIMATION);
+    }
+
+    // Smallest power of two holding the longest lag and its parabola's neighbour
+    size_t windowFor(float rate, float minHz)
+    {
+        const size_t longest = static_cast<size_t>(std::ceil(rate / std::max(minHz, 1.0f))) + 2;
+        size_t length = MIN_WINDOW;
+        while (length < longest)
+            length <<= 1;
+        return length;
+    }
+}
+
+PitchDetector::PitchDetector(float sampleRate, size_t decimation, float minHz, float maxHz, float threshold)
+    : rate(sampleRate / clampDecimation(decimation)), decimation(clampDecimation(decimation)),
+      windowLength(windowFor(rate, minHz)), hop(windowLength / 4), threshold(threshold), fft(2 * windowLength),
+      decimated(256), history(2 * windowLength, 0.0f), untilFrame(2 * windowLength), frame(2 * windowLength, 0.0f),
+      window(2 * windowLength, 0.0f), energy(2 * windowLength + 1, 0.0), frameRe(windowLength + 1),
+      frameIm(windowLength + 1), windowRe(windowLength + 1), windowIm(windowLength + 1),
+      correlation(2 * windowLength, 0.0f), normalised(windowLength + 1, 1.0f)
+{
+    maxLag = std::min(static_cast<size_t>(std::ceil(rate / minHz)), windowLength - 1);
+    minLag = std::min(std::max(static_cast<size_t>(rate / maxHz), size_t(2)), maxLag - 1);
+}
+
+void PitchDetector::push(const float *samples, size_t count)
+{
+    const size_t pushed = count;
+    if (decimation == 1)
+    {
+        append(samples, count);
+    }
+    else
+    {
+        while (count > 0)
+        {
+            const size_t n = std::min(count, decimated.size());
+            size_t m = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                sum += samples[i];
+                if (++summed == decimation)
+                {
+                    decimated[m++] = sum / static_cast<float>(decimation);
+                    sum = 0.0f;
+                    summed = 0;
+                }
+            }
+            append(decimated.data(), m);
+            samples += n;
+            count -= n;
+        }
+    }
+
+    // Keep pace with the input: STAGES steps per hop pushed, at least one per call
+    const size_t steps = std::max<size_t>(1, (pushed * STAGES + hopLength() - 1) / hopLength());
+    for (size_t i = 0; i < steps && stage < STAGES; ++i)
+        step();
+}
+
+void PitchDetector::append(const float *samples, size_t count)
+{
+    const size_t length = history.size();
+    while (count > 0)
+    {
+        const size_t n = std::min(count, untilFrame);
+        const size_t start = written & (length - 1);
+        const size_t first = std::min(n, length - start);
+        std::copy(samples, samples + first, history.data() + start);
+        std::copy(samples + first, samples + n, history.data());
+        written += n;
+        untilFrame -= n;
+        samples += n;
+        count -= n;
+
+        if (untilFrame == 0)
+        {
+            // Callers pushing more than a hop at once finish the previous analysis here
+            while (stage < STAGES)
+                step();
+            const size_t oldest = written & (length - 1);
+            std::copy(history.begin() + oldest, history.end(), frame.begin());
+            std::copy(history.begin(), history.begin() + oldest, frame.begin() + (length - oldest));
+            stage = 0;
+            untilFrame = hop;
+        }
+    }
+}
+
+void PitchDetector::step()
+{
+    const size_t W = windowLength;
+    switch (stage++)
+    {
+    case 0:
+        fft.forward(frame.data(), frameRe.data(), frameIm.data());
+        break;
+
+    case 1:
+        std::copy(frame.begin(), frame.begin() + W, window.begin());
+        fft.forward(window.data(), windowRe.data(), windowIm.data());
+        energy[0] = 0.0;
+        for (size_t i = 0; i < 2 * W; ++i)
+            energy[i + 1] = energy[i] + static_cast<double>(frame[i]) * frame[i];
+        break;
+
+    case 2:
+    {
+        // correlation[tau] = sum over the window of x[j] x[j + tau]: conj(W) * F, then back
+        const size_t bins = fft.bins();
+        for (size_t k = 0; k < bins; ++k)
+        {
+            const float re = windowRe[k] * frameRe[k] + windowIm[k] * frameIm[k];
+            const float im = windowRe[k] * frameIm[k] - windowIm[k] * frameRe[k];
+            windowRe[k] = re;
+            windowIm[k] = im;
+        }
+        fft.inverse(windowRe.data(), windowIm.data(), correlation.data());
+        break;
+    }
+
+    case 3:
+    {
+        const double windowEnergy = energy[W];
+        ++completed;
+        if (windowEnergy < SILENCE * W)
+        {
+            hz = 0.0f;
+            clarity = 0.0f;
+            break;
+        }
+
+        // Cumulative mean normalised difference
+        const double scale = 2.0 / static_cast<double>(2 * W); // inverse() is unnormalised
+        double running = 0.0;
+        for (size_t tau = 1; tau <= maxLag + 1; ++tau)
+        {
+            const double d = std::max(windowEnergy + (energy[tau + W] - energy[tau]) - scale * correlation[tau], 0.0);
+            running += d;
+            normalised[tau] = running > 0.0 ? static_cast<float>(d * tau / running) : 1.0f;
+        }
+
+        // First dip under the threshold, followed down to its minimum
+        size_t tau = minLag;
+        while (tau <= maxLag && normalised[tau] >= threshold)
+            ++tau;
+        if (tau > maxLag)
+        {
+            hz = 0.0f;
+            clarity = 1.0f - *std::min_element(normalised.begin() + minLag, normalised.begin() + maxLag + 1);
+            break;
+        }
+        while (tau < maxLag && normalised[tau + 1] < normalised[tau])
+            ++tau;
+
+        const float a = normalised[tau - 1], b = normalised[tau], c = normalised[tau + 1];
+        const float curvature = a - 2.0f * b + c;
+        const float shift = curvature > 0.0f ? std::min(std::max(0.5f * (a - c) / curvature, -0.5f), 0.5f) : 0.0f;
+        hz = rate / (static_cast<float>(tau) + shift);
+        clarity = 1.0f - b;
+        break;
+    }
+    }
+}
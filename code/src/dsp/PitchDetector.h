@@ -0,0 +1,122 @@
+#ifndef PITCHDETECTOR_H
+#define PITCHDETECTOR_H
+
+#include <cstddef>
+#include <vector>
+#include "RealFFT.h"
+
+/**
+ * @class PitchDetector
+ * @brief Monophonic pitch tracker (YIN) over a sliding window, updated every hop.
+ *
+ * YIN's difference function d(tau) = sum (x[j] - x[j + tau])^2 over a window
+ * of W samples is expanded into two energy terms and a cross-correlation. The
+ * energies come from a running sum of squares; the correlation of the window
+ * with the whole 2W-sample frame comes from one RealFFT of each, a spectrum
+ * product and an inverse FFT, so every lag is found in O(W log W) rather than
+ * O(W^2). The cumulative mean normalised difference is then searched for the
+ * first dip below the threshold, refined by parabolic interpolation.
+ *
+ * Input may be decimated first (each group of `decimation` samples averaged):
+ * guitar fundamentals sit far below the pedal's Nyquist frequency, and every
+ * halving of the rate halves the frame. W is the smallest power of two that
+ * holds the longest period asked for.
+ *
+ * A new frame is taken every W / 4 analysed samples, and its analysis is
+ * split into STAGES steps of similar cost that run on later push() calls, so
+ * a caller pushing a quarter hop at a time pays a quarter of an analysis per
+ * call instead of a whole one every fourth call. The estimate lags the input
+ * by about a frame and a hop.
+ *
+ * All memory is allocated by the constructor; push() is real-time safe.
+ */
+class PitchDetector
+{
+public:
+    static constexpr size_t STAGES = 4;      ///< Steps each analysis is split into
+    static constexpr size_t MAX_DECIMATION = 8;
+
+    /**
+     * @param sampleRate Rate of the pushed samples.
+     * @param decimation Input samples averaged into each analysed sample (1..MAX_DECIMATION).
+     * @param minHz Lowest pitch reported.
+     * @param maxHz Highest pitch reported.
+     * @param threshold YIN threshold on the normalised difference (lower is stricter).
+     */
+    explicit PitchDetector(float sampleRate, size_t decimation = 1, float minHz = 60.0f, float maxHz = 1500.0f,
+                           float threshold = 0.15f);
+
+    /**
+     * @brief Adds samples, taking a new frame every hop and running pending analysis steps.
+     */
+    void push(const float *samples, size_t count);
+
+    /**
+     * @brief Latest pitch in Hz, or 0 if the last frame had none (silence, noise, chords).
+     */
+    float frequency() const { return hz; }
+
+    /**
+     * @brief How periodic the last frame was, 0..1 (1 - the normalised difference at the pitch).
+     */
+    float periodicity() const { return clarity; }
+
+    /**
+     * @brief Number of analyses completed, so callers can tell a new estimate from an old one.
+     */
+    size_t estimates() const { return completed; }
+
+    /**
+     * @brief Input samples per analysed frame.
+     */
+    size_t frameLength() const { return frame.size() * decimation; }
+
+    /**
+     * @brief Input samples between frames.
+     */
+    size_t hopLength() const { return hop * decimation; }
+
+private:
+    /**
+     * @brief Appends analysed (decimated) samples, taking frames as hops complete.
+     */
+    void append(const float *samples, size_t count);
+
+    /**
+     * @brief Runs the next analysis step of the current frame.
+     */
+    void step();
+
+    float rate;                   ///< Analysed sample rate
+    size_t decimation;
+    size_t windowLength;          ///< W; the frame is 2W
+    size_t hop;                   ///< Analysed samples between frames
+    size_t minLag;
+    size_t maxLag;
+    float threshold;
+    RealFFT fft;
+
+    // Decimation
+    float sum = 0.0f;             ///< Samples of the group being averaged
+    size_t summed = 0;
+    std::vector<float> decimated;
+
+    std::vector<float> history;   ///< Last 2W analysed samples, circular
+    size_t written = 0;           ///< Analysed samples appended
+    size_t untilFrame;            ///< Samples to append before the next frame is taken
+    size_t stage = STAGES;        ///< Next step of the current analysis; STAGES when idle
+
+    // Analysis of the current frame
+    std::vector<float> frame;     ///< Oldest first
+    std::vector<float> window;    ///< First W samples of frame, zero-padded
+    std::vector<double> energy;   ///< energy[i] = sum of frame[j]^2 for j < i
+    std::vector<float> frameRe, frameIm, windowRe, windowIm;
+    std::vector<float> correlation;
+    std::vector<float> normalised;
+
+    float hz = 0.0f;
+    float clarity = 0.0f;
+    size_t completed = 0;
+};
+
+#endif // PITCHDETECTOR_H
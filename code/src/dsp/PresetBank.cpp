@@ -0,0 +1,250 @@
+#include "PresetBank.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <unordered_set>
+
+namespace
+{
+    enum ValueType : uint8_t
+    {
+        TYPE_NONE = 0,
+        TYPE_INT = 1,
+        TYPE_FLOAT = 2,
+        TYPE_BOOL = 3,
+        TYPE_STRING = 4
+    };
+
+    // Little-endian writer over a byte vector
+    struct Writer
+    {
+        std::vector<uint8_t> bytes;
+
+        void u8(uint8_t v) { bytes.push_back(v); }
+        void u16(uint16_t v)
+        {
+            u8(v & 0xFF);
+            u8(v >> 8);
+        }
+        void u32(uint32_t v)
+        {
+            u16(v & 0xFFFF);
+            u16(v >> 16);
+        }
+        void str8(const std::string &s)
+        {
+            u8(static_cast<uint8_t>(std::min<size_t>(s.size(), 0xFF)));
+            bytes.insert(bytes.end(), s.begin(), s.begin() + std::min<size_t>(s.size(), 0xFF));
+        }
+        void str16(const std::string &s)
+        {
+            u16(static_cast<uint16_t>(std::min<size_t>(s.size(), 0xFFFF)));
+            bytes.insert(bytes.end(), s.begin(), s.begin() + std::min<size_t>(s.size(), 0xFFFF));
+        }
+    };
+
+    // Bounds-checked little-endian reader; sets ok = false on truncation
+    struct Reader
+    {
+        const std::vector<uint8_t> &bytes;
+        size_t pos = 0;
+        bool ok = true;
+
+        bool need(size_t n)
+        {
+            if (pos + n > bytes.size())
+                ok = false;
+            return ok;
+        }
+        uint8_t u8() { return need(1) ? bytes[pos++] : 0; }
+        uint16_t u16()
+        {
+            uint16_t lo = u8();
+            return lo | static_cast<uint16_t>(u8() << 8);
+        }
+        uint32_t u32()
+        {
+            uint32_t lo = u16();
+            return lo | (static_cast<uint32_t>(u16()) << 16);
+        }
+        std::string str(size_t n)
+        {
+            if (!need(n))
+                return {};
+            std::string s(bytes.begin() + pos, bytes.begin() + pos + n);
+            pos += n;
+            return s;
+        }
+    };
+}
+
+void Preset::applyTo(Config &config) const
+{
+    std::unordered_set<std::string> mentioned;
+    for (const auto &entry : entries)
+    {
+        mentioned.insert(entry.key);
+        config.set(entry.key, entry.enabled, entry.value);
+    }
+
+    std::vector<std::string> others;
+    config.forEach([&](const std::string &key, bool enabled, const std::any &)
+                   {
+        if (enabled && key != "preset" && !mentioned.count(key))
+            others.push_back(key); });
+    for (const auto &key : others)
+        config.set(key, false, std::any{});
+}
+
+size_t PresetBank::capture(const std::string &name, const Config &config)
+{
+    Preset preset;
+    preset.name = name;
+    config.forEach([&](const std::string &key, bool enabled, const std::any &value)
+                   {
+        // The selector key is not part of the sound
+        if (enabled && key != "preset")
+            preset.entries.push_back({key, enabled, value}); });
+
+    // Deterministic order keeps saved files stable
+    std::sort(preset.entries.begin(), preset.entries.end(),
+              [](const Preset::Entry &a, const Preset::Entry &b)
+              { return a.key < b.key; });
+
+    return add(std::move(preset));
+}
+
+size_t PresetBank::add(Preset preset)
+{
+    presets.push_back(std::move(preset));
+    return presets.size() - 1;
+}
+
+bool PresetBank::save(const std::string &path) const
+{
+    Writer w;
+    w.u32(FILE_MAGIC);
+    w.u16(FILE_VERSION);
+    w.u16(static_cast<uint16_t>(presets.size()));
+
+    for (const auto &preset : presets)
+    {
+        w.str8(preset.name);
+        w.u16(static_cast<uint16_t>(preset.entries.size()));
+        for (const auto &entry : preset.entries)
+        {
+            w.str8(entry.key);
+            w.u8(entry.enabled ? 1 : 0);
+
+            const std::any &v = entry.value;
+            if (v.type() == typeid(int))
+            {
+                w.u8(TYPE_INT);
+                w.u32(static_cast<uint32_t>(std::any_cast<int>(v)));
+            }
+            else if (v.type() == typeid(float))
+            {
+                float f = std::any_cast<float>(v);
+                uint32_t bits;
+                std::memcpy(&bits, &f, sizeof(bits));
+                w.u8(TYPE_FLOAT);
+                w.u32(bits);
+            }
+            else if (v.type() == typeid(bool))
+            {
+                w.u8(TYPE_BOOL);
+                w.u8(std::any_cast<bool>(v) ? 1 : 0);
+            }
+            else if (v.type() == typeid(std::string))
+            {
+                w.u8(TYPE_STRING);
+                w.str16(std::any_cast<const std::string &>(v));
+            }
+            else
+            {
+                w.u8(TYPE_NONE);
+            }
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "[PresetBank] Failed to open " << path << " for writing\n";
+        return false;
+    }
+    file.write(reinterpret_cast<const char *>(w.bytes.data()), w.bytes.size());
+    return file.good();
+}
+
+bool PresetBank::load(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << "[PresetBank] No preset bank at " << path << "\n";
+        return false;
+    }
+    const std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    Reader r{bytes};
+    if (r.u32() != FILE_MAGIC)
+    {
+        std::cerr << "[PresetBank] " << path << " is not a preset bank\n";
+        return false;
+    }
+    const uint16_t version = r.u16();
+    if (version != FILE_VERSION)
+    {
+        std::cerr << "[PresetBank] Unsupported preset bank version " << version << "\n";
+        return false;
+    }
+
+    std::vector<Preset> loaded(r.u16());
+    for (auto &preset : loaded)
+    {
+        preset.name = r.str(r.u8());
+        preset.entries.resize(r.u16());
+        for (auto &entry : preset.entries)
+        {
+            entry.key = r.str(r.u8());
+            entry.enabled = r.u8() != 0;
+            switch (r.u8())
+            {
+            case TYPE_INT:
+                entry.value = static_cast<int>(r.u32());
+                break;
+            case TYPE_FLOAT:
+            {
+                uint32_t bits = r.u32();
+                float f;
+                std::memcpy(&f, &bits, sizeof(f));
+                entry.value = f;
+                break;
+            }
+            case TYPE_BOOL:
+                entry.value = r.u8() != 0;
+                break;
+            case TYPE_STRING:
+                entry.value = r.str(r.u16());
+                break;
+            default:
+                break;
+            }
+        }
+        if (!r.ok)
+            break;
+    }
+
+    if (!r.ok)
+    {
+        std::cerr << "[PresetBank] " << path << " is truncated\n";
+        return false;
+    }
+
+    presets = std::move(loaded);
+    std::cout << "[PresetBank] Loaded " << presets.size() << " preset(s) from " << path << "\n";
+    return true;
+}
@@ -0,0 +1,83 @@
+#ifndef PRESETBANK_H
+#define PRESETBANK_H
+
+#include <any>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Config.h"
+
+/**
+ * @struct Preset
+ * @brief A named snapshot of configuration entries from which a chain can be built.
+ */
+struct Preset
+{
+    struct Entry
+    {
+        std::string key;
+        bool enabled = false;
+        std::any value; ///< int, float, bool or std::string, as produced by Config
+    };
+
+    std::string name;
+    std::vector<Entry> entries;
+
+    /**
+     * @brief Writes every entry into a config. Keys the preset does not mention are disabled.
+     */
+    void applyTo(Config &config) const;
+};
+
+/**
+ * @class PresetBank
+ * @brief An ordered collection of presets with a compact, versioned binary file format.
+ *
+ * File layout (all integers little-endian):
+ * @code
+ * u32 magic "SPRB" | u16 version | u16 preset count
+ * per preset: u8 name length, name | u16 entry count
+ * per entry:  u8 key length, key | u8 enabled | u8 type | payload
+ *             type 1 = i32, 2 = f32, 3 = u8 bool, 4 = u16 length + bytes
+ * @endcode
+ */
+class PresetBank
+{
+public:
+    static constexpr uint32_t FILE_MAGIC = 0x42525053; ///< "SPRB"
+    static constexpr uint16_t FILE_VERSION = 1;
+
+    /**
+     * @brief Captures the enabled entries of a config as a new preset.
+     * @param name Display name of the preset.
+     * @param config The configuration to snapshot.
+     * @return Index of the new preset.
+     */
+    size_t capture(const std::string &name, const Config &config);
+
+    /**
+     * @brief Appends an existing preset.
+     * @return Index of the new preset.
+     */
+    size_t add(Preset preset);
+
+    size_t size() const { return presets.size(); }
+    const Preset &operator[](size_t index) const { return presets[index]; }
+
+    /**
+     * @brief Writes the bank to disk.
+     * @return true on success; false otherwise.
+     */
+    bool save(const std::string &path) const;
+
+    /**
+     * @brief Replaces the bank's contents with a file written by save().
+     * @return false if the file is missing, truncated or of another version.
+     */
+    bool load(const std::string &path);
+
+private:
+    std::vector<Preset> presets;
+};
+
+#endif // PRESETBANK_H
@@ -0,0 +1,142 @@
+#include "RealFFT.h"
+#include <cmath>
+
+namespace
+{
+    // Separate, restrict-qualified arrays: inline, GCC would need more run-time alias checks than it allows
+    inline void butterflies(float *__restrict r0, float *__restrict i0, float *__restrict r1, float *__restrict i1,
+                            const float *__restrict wr, const float *__restrict wi, size_t count)
+    {
+        for (size_t j = 0; j < count; ++j)
+        {
+            const float tr = wr[j] * r1[j] - wi[j] * i1[j];
+            const float ti = wr[j] * i1[j] + wi[j] * r1[j];
+            r1[j] = r0[j] - tr;
+            i1[j] = i0[j] - ti;
+            r0[j] += tr;
+            i0[j] += ti;
+        }
+    }
+
+    // Forward split of bins 1 .. half - 1: X[k] = E[k] + W^k O[k], with E = (Z[k] + conj Z[-k]) / 2
+    // and O = (Z[k] - conj Z[-k]) / 2i
+    inline void splitSpectrum(const float *__restrict zr, const float *__restrict zi, const float *__restrict wr,
+                              const float *__restrict wi, float *__restrict re, float *__restrict im, size_t half)
+    {
+        for (size_t k = 1; k < half; ++k)
+        {
+            const float ar = zr[k], ai = zi[k];
+            const float br = zr[half - k], bi = zi[half - k];
+            const float er = 0.5f * (ar + br), ei = 0.5f * (ai - bi);
+            const float orr = 0.5f * (ai + bi), oi = -0.5f * (ar - br);
+            re[k] = er + wr[k] * orr - wi[k] * oi;
+            im[k] = ei + wr[k] * oi + wi[k] * orr;
+        }
+    }
+
+    // Inverse of the split for bins 0 .. half - 1 (Z = E + i O, both doubled), with re/im swapped
+    // so the forward transform computes the inverse
+    inline void unsplitSpectrum(const float *__restrict re, const float *__restrict im, const float *__restrict wr,
+                                const float *__restrict wi, float *__restrict zr, float *__restrict zi, size_t half)
+    {
+        for (size_t k = 0; k < half; ++k)
+        {
+            const float ar = re[k], ai = im[k];
+            const float br = re[half - k], bi = -im[half - k];
+            const float er = ar + br, ei = ai + bi;
+            const float dr = ar - br, di = ai - bi;
+            const float orr = dr * wr[k] + di * wi[k];
+            const float oi = di * wr[k] - dr * wi[k];
+            zi[k] = er - oi;
+            zr[k] = ei + orr;
+        }
+    }
+}
+
+RealFFT::RealFFT(size_t size)
+    : n(size), half(size / 2), reversed(half), twiddleRe(half), twiddleIm(half), splitRe(half), splitIm(half),
+      workRe(half), workIm(half), unsplitRe(half), unsplitIm(half)
+{
+    size_t bits = 0;
+    while ((size_t{1} << bits) < half)
+        ++bits;
+    for (size_t i = 0; i < half; ++i)
+    {
+        size_t r = 0;
+        for (size_t b = 0; b < bits; ++b)
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        reversed[i] = r;
+    }
+
+    for (size_t span = 2; span <= half; span *= 2)
+    {
+        for (size_t j = 0; j < span / 2; ++j)
+        {
+            const double angle = -2.0 * M_PI * j / span;
+            twiddleRe[span / 2 + j] = static_cast<float>(std::cos(angle));
+            twiddleIm[span / 2 + j] = static_cast<float>(std::sin(angle));
+        }
+    }
+    for (size_t k = 0; k < half; ++k)
+    {
+        const double angle = -2.0 * M_PI * k / n;
+        splitRe[k] = static_cast<float>(std::cos(angle));
+        splitIm[k] = static_cast<float>(std::sin(angle));
+    }
+}
+
+void RealFFT::transform(float *re, float *im) const
+{
+    // First stage: the only twiddle is 1
+    for (size_t b = 0; b < half; b += 2)
+    {
+        const float r = re[b + 1], i = im[b + 1];
+        re[b + 1] = re[b] - r;
+        im[b + 1] = im[b] - i;
+        re[b] += r;
+        im[b] += i;
+    }
+
+    for (size_t span = 4; span <= half; span *= 2)
+    {
+        const size_t h = span / 2;
+        const float *wr = twiddleRe.data() + h;
+        const float *wi = twiddleIm.data() + h;
+        for (size_t b = 0; b < half; b += span)
+            butterflies(re + b, im + b, re + b + h, im + b + h, wr, wi, h);
+    }
+}
+
+void RealFFT::forward(const float *in, float *re, float *im)
+{
+    // Even samples as the real part, odd as the imaginary part
+    for (size_t m = 0; m < half; ++m)
+    {
+        workRe[reversed[m]] = in[2 * m];
+        workIm[reversed[m]] = in[2 * m + 1];
+    }
+    transform(workRe.data(), workIm.data());
+
+    re[0] = workRe[0] + workIm[0];
+    im[0] = 0.0f;
+    re[half] = workRe[0] - workIm[0];
+    im[half] = 0.0f;
+    splitSpectrum(workRe.data(), workIm.data(), splitRe.data(), splitIm.data(), re, im, half);
+}
+
+void RealFFT::inverse(const float *re, const float *im, float *out)
+{
+    unsplitSpectrum(re, im, splitRe.data(), splitIm.data(), unsplitRe.data(), unsplitIm.data(), half);
+    for (size_t k = 0; k < half; ++k)
+    {
+        workRe[reversed[k]] = unsplitRe[k];
+        workIm[reversed[k]] = unsplitIm[k];
+    }
+    transform(workRe.data(), workIm.data());
+
+    for (size_t m = 0; m < half; ++m)
+    {
+        out[2 * m] = workIm[m];
+        out[2 * m + 1] = workRe[m];
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef REALFFT_H
+#define REALFFT_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @class RealFFT
+ * @brief Power-of-two FFT of a real signal, with the spectrum in split (re/im) form.
+ *
+ * A size-N real transform runs as one N/2-point complex FFT of the even and
+ * odd samples packed as real and imaginary parts, followed by a split pass
+ * that separates their spectra. The complex FFT is an iterative radix-2
+ * decimation in time on split arrays with one contiguous twiddle table per
+ * stage, so every butterfly loop past the first few stages is a plain
+ * multiply-add over contiguous floats that the compiler vectorises.
+ *
+ * Tables and scratch are allocated by the constructor; forward() and
+ * inverse() never allocate and are safe on the audio thread.
+ */
+class RealFFT
+{
+public:
+    /**
+     * @param size Transform length N, a power of two of at least 4.
+     */
+    explicit RealFFT(size_t size);
+
+    /**
+     * @brief Transform length N.
+     */
+    size_t size() const { return n; }
+
+    /**
+     * @brief Number of spectrum bins, N / 2 + 1 (DC to Nyquist).
+     */
+    size_t bins() const { return n / 2 + 1; }
+
+    /**
+     * @brief Spectrum of N real samples into bins() values of re and im.
+     */
+    void forward(const float *in, float *re, float *im);
+
+    /**
+     * @brief Unnormalised inverse: inverse(forward(x)) is N * x.
+     */
+    void inverse(const float *re, const float *im, float *out);
+
+private:
+    /**
+     * @brief In-place complex FFT of the bit-reversed split arrays (size n / 2).
+     */
+    void transform(float *re, float *im) const;
+
+    size_t n;                      ///< Real transform size
+    size_t half;                   ///< Complex transform size n / 2
+    std::vector<size_t> reversed;  ///< Bit reversal of each index below half
+    std::vector<float> twiddleRe;  ///< Stage of span s uses [s / 2, s): cos(-2 pi j / s)
+    std::vector<float> twiddleIm;  ///< ... and sin(-2 pi j / s)
+    std::vector<float> splitRe;    ///< exp(-2 pi i k / n) for the split pass
+    std::vector<float> splitIm;
+    std::vector<float> workRe;     ///< Complex FFT scratch
+    std::vector<float> workIm;
+    std::vector<float> unsplitRe;  ///< inverse() scratch, before bit reversal
+    std::vector<float> unsplitIm;
+};
+
+#endif // REALFFT_H
@@ -0,0 +1,93 @@
+#include "RealtimeCheck.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <execinfo.h>
+#include <unistd.h>
+
+// Defined by rtcheck/RealtimeInterpose.cpp when it is linked in
+extern "C" __attribute__((weak)) void realtimeCheckInterposed();
+
+namespace
+{
+    constexpr int BACKTRACE_DEPTH = 32;
+    constexpr size_t MAX_REPORTS = 20; ///< Printed in full; later violations are only counted
+
+    thread_local unsigned depth = 0;      ///< Nested RealtimeScopes on this thread
+    thread_local bool reporting = false;  ///< Set while a violation is reported, which itself allocates
+    std::atomic<size_t> count{0};
+    std::atomic<int> abortSetting{-1};    ///< -1: not decided yet, read from RT_CHECK
+
+    bool abortOnViolation()
+    {
+        int setting = abortSetting.load(std::memory_order_relaxed);
+        if (setting < 0)
+        {
+            const char *mode = std::getenv("RT_CHECK");
+            setting = mode && std::strcmp(mode, "abort") == 0;
+            abortSetting.store(setting, std::memory_order_relaxed);
+        }
+        return setting != 0;
+    }
+}
+
+bool RealtimeCheck::inScope()
+{
+    return depth > 0 && !reporting;
+}
+
+void RealtimeCheck::check(const char *call)
+{
+    if (!inScope())
+        return;
+
+    reporting = true;
+    if (count.fetch_add(1, std::memory_order_relaxed) >= MAX_REPORTS && !abortOnViolation())
+    {
+        reporting = false;
+        return;
+    }
+
+    char line[128];
+    const int length = std::snprintf(line, sizeof(line), "[RealtimeCheck] %s on the audio thread\n", call);
+    if (length > 0 && write(STDERR_FILENO, line, static_cast<size_t>(length)) == length)
+    {
+        void *frames[BACKTRACE_DEPTH];
+        backtrace_symbols_fd(frames, backtrace(frames, BACKTRACE_DEPTH), STDERR_FILENO);
+    }
+
+    if (abortOnViolation())
+        std::abort();
+    reporting = false;
+}
+
+size_t RealtimeCheck::violations()
+{
+    return count.load(std::memory_order_relaxed);
+}
+
+void RealtimeCheck::clearViolations()
+{
+    count.store(0, std::memory_order_relaxed);
+}
+
+void RealtimeCheck::setAbort(bool abort)
+{
+    abortSetting.store(abort ? 1 : 0, std::memory_order_relaxed);
+}
+
+bool RealtimeCheck::enabled()
+{
+    return realtimeCheckInterposed != nullptr;
+}
+
+void RealtimeCheck::enter()
+{
+    ++depth;
+}
+
+void RealtimeCheck::leave()
+{
+    --depth;
+}
@@ -0,0 +1,74 @@
+#ifndef REALTIMECHECK_H
+#define REALTIMECHECK_H
+
+#include <cstddef>
+
+/**
+ * @class RealtimeCheck
+ * @brief Catches allocations, locks and blocking calls made while the audio thread processes.
+ *
+ * The audio path marks its processing with a RealtimeScope. In builds with the
+ * checker (cmake -DRT_SAFETY_CHECKS=ON, and always in the unit tests)
+ * rtcheck/RealtimeInterpose.cpp replaces malloc/free, operator new/delete,
+ * pthread_mutex_lock and the blocking calls behind stdio and iostream with
+ * versions that report themselves here when called inside a scope: the call
+ * and a backtrace go to stderr (the first 20 of them) and every violation is
+ * counted. With RT_CHECK=abort
+ * in the environment (or setAbort(true)) the first violation aborts instead.
+ *
+ * Without the interposer only the scope depth is kept, a thread-local counter.
+ */
+class RealtimeCheck
+{
+public:
+    /**
+     * @brief True while this thread is inside a RealtimeScope.
+     */
+    static bool inScope();
+
+    /**
+     * @brief Reports `call` if this thread is in scope. Called by the interposer.
+     */
+    static void check(const char *call);
+
+    /**
+     * @brief Violations reported so far, on any thread.
+     */
+    static size_t violations();
+
+    /**
+     * @brief Clears the violation count (e.g. between tests).
+     */
+    static void clearViolations();
+
+    /**
+     * @brief Abort on the first violation instead of reporting and carrying on.
+     */
+    static void setAbort(bool abort);
+
+    /**
+     * @brief True if the interposer is linked in, so violations can be seen at all.
+     */
+    static bool enabled();
+
+private:
+    friend class RealtimeScope;
+
+    static void enter();
+    static void leave();
+};
+
+/**
+ * @class RealtimeScope
+ * @brief Marks the enclosing block as audio processing. Scopes nest.
+ */
+class RealtimeScope
+{
+public:
+    RealtimeScope() { RealtimeCheck::enter(); }
+    ~RealtimeScope() { RealtimeCheck::leave(); }
+    RealtimeScope(const RealtimeScope &) = delete;
+    RealtimeScope &operator=(const RealtimeScope &) = delete;
+};
+
+#endif // REALTIMECHECK_H
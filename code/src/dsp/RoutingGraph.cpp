@@ -0,0 +1,294 @@
+#include "RoutingGraph.h"
+#include "EffectRegistry.h"
+#include <algorithm>
+#include <cctype>
+#include <strings.h>
+#include <vector>
+
+namespace
+{
+    /**
+     * @brief Recursive-descent compiler for route descriptions.
+     *
+     * Steps for the caller's thread go to `out`; the bodies of forked branches go
+     * to `bodies` and are appended after the main steps once parsing is done.
+     */
+    struct RouteCompiler
+    {
+        const std::string &text;
+        size_t pos = 0;
+        std::vector<RouteStep> bodies;
+        bool used[EffectRegistry::count] = {};
+        uint8_t nextBuffer = 1;
+        uint8_t maxBuffers = 1;
+        uint8_t peakBuffer = 1;  ///< Highest nextBuffer reached within the split being compiled
+        std::string error;
+
+        explicit RouteCompiler(const std::string &route) : text(route) {}
+
+        char peek()
+        {
+            while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos])))
+                ++pos;
+            return pos < text.size() ? text[pos] : '\0';
+        }
+
+        bool fail(const std::string &message)
+        {
+            if (error.empty())
+                error = message + " at column " + std::to_string(pos + 1);
+            return false;
+        }
+
+        // sequence := (name | split)*
+        bool sequence(uint8_t buffer, bool forkable, std::vector<RouteStep> &out)
+        {
+            while (true)
+            {
+                const char c = peek();
+                if (c == '\0' || c == '|' || c == ']')
+                    return true;
+                if (c == '[')
+                {
+                    ++pos;
+                    if (!split(buffer, forkable, out))
+                        return false;
+                    continue;
+                }
+                if (!effect(buffer, out))
+                    return false;
+            }
+        }
+
+        bool effect(uint8_t buffer, std::vector<RouteStep> &out)
+        {
+            const size_t start = pos;
+            while (pos < text.size() && (std::isalnum(static_cast<unsigned char>(text[pos])) || text[pos] == '_'))
+                ++pos;
+            if (pos == start)
+                return fail(std::string("Unexpected '") + text[pos] + "'");
+
+            const std::string name = text.substr(start, pos - start);
+            const auto match = std::find_if(EffectRegistry::table.begin(), EffectRegistry::table.end(),
+                                            [&](const EffectInfo &info) { return strcasecmp(info.name, name.c_str()) == 0; });
+            if (match == EffectRegistry::table.end())
+                return fail("Unknown effect '" + name + "'");
+            if (used[match->id])
+                return fail("Effect '" + name + "' used twice");
+            used[match->id] = true;
+
+            RouteStep step;
+            step.op = RouteOp::Process;
+            step.effect = match->id;
+            step.dst = buffer;
+            out.push_back(step);
+            fuse(out);
+            return true;
+        }
+
+        // Replaces a just-completed run of effects with the fused effect covering it
+        void fuse(std::vector<RouteStep> &out)
+        {
+            for (const EffectInfo &info : EffectRegistry::fused)
+            {
+                const size_t n = info.stageCount;
+                if (out.size() < n)
+                    continue;
+
+                const size_t first = out.size() - n;
+                bool matches = true;
+                for (size_t i = 0; i < n && matches; ++i)
+                {
+                    const RouteStep &step = out[first + i];
+                    matches = step.op == RouteOp::Process && step.dst == out.back().dst && step.effect == info.stages[i];
+                }
+                if (!matches)
+                    continue;
+
+                RouteStep fused = out.back();
+                fused.effect = info.id;
+                out.resize(first);
+                out.push_back(fused);
+                return;
+            }
+        }
+
+        // Top-level branches of the split starting at pos, counted ahead of parsing them
+        size_t branchCount() const
+        {
+            size_t count = 1;
+            int depth = 0;
+            for (size_t i = pos; i < text.size() && depth >= 0; ++i)
+            {
+                if (text[i] == '[')
+                    ++depth;
+                else if (text[i] == ']')
+                    --depth;
+                else if (text[i] == '|' && depth == 0)
+                    ++count;
+            }
+            return count;
+        }
+
+        // split := '[' sequence ('|' sequence)* ']'
+        bool split(uint8_t buffer, bool forkable, std::vector<RouteStep> &out)
+        {
+            std::vector<std::vector<RouteStep>> branches;
+            std::vector<uint8_t> branchBuffers;
+
+            // Every branch's input is copied before any branch runs, and forked branches
+            // run at once, so all of the split's buffers stay reserved until its mix, and
+            // a split nested in one branch takes buffers above those of its siblings
+            const uint8_t entry = nextBuffer;
+            const size_t reserved = branchCount() - 1;
+            if (entry + reserved > MAX_ROUTE_BUFFERS)
+                return fail("Too many parallel branches");
+            nextBuffer = static_cast<uint8_t>(entry + reserved);
+            maxBuffers = std::max(maxBuffers, nextBuffer);
+            const uint8_t outerPeak = peakBuffer;
+            peakBuffer = nextBuffer;
+
+            while (true)
+            {
+                // The first branch works in place; the others get a copy of the input
+                const uint8_t branchBuffer = branches.empty() ? buffer : static_cast<uint8_t>(entry + branches.size() - 1);
+
+                branches.emplace_back();
+                branchBuffers.push_back(branchBuffer);
+                if (!sequence(branchBuffer, false, branches.back()))
+                    return false;
+                nextBuffer = peakBuffer;
+
+                const char c = peek();
+                ++pos;
+                if (c == ']')
+                    break;
+                if (c != '|')
+                    return fail("Missing ']'");
+            }
+
+            peakBuffer = std::max(outerPeak, peakBuffer);
+            nextBuffer = entry;
+            const size_t count = branches.size();
+
+            if (count == 1)
+            {
+                out.insert(out.end(), branches[0].begin(), branches[0].end());
+                return true;
+            }
+
+            for (size_t i = 1; i < count; ++i)
+            {
+                RouteStep copy;
+                copy.op = RouteOp::Copy;
+                copy.src = buffer;
+                copy.dst = branchBuffers[i];
+                out.push_back(copy);
+            }
+
+            if (forkable)
+            {
+                // Other branches run elsewhere while this thread runs the first one
+                size_t forked = 0;
+                for (size_t i = 1; i < count; ++i)
+                {
+                    if (branches[i].empty())
+                        continue; // A dry path needs no work
+                    RouteStep fork;
+                    fork.op = RouteOp::Fork;
+                    fork.begin = static_cast<uint16_t>(bodies.size());
+                    bodies.insert(bodies.end(), branches[i].begin(), branches[i].end());
+                    fork.end = static_cast<uint16_t>(bodies.size());
+                    out.push_back(fork);
+                    ++forked;
+                }
+                out.insert(out.end(), branches[0].begin(), branches[0].end());
+                if (forked > 0)
+                {
+                    RouteStep join;
+                    join.op = RouteOp::Join;
+                    out.push_back(join);
+                }
+            }
+            else
+            {
+                for (const auto &branch : branches)
+                    out.insert(out.end(), branch.begin(), branch.end());
+            }
+
+            const float gain = 1.0f / static_cast<float>(count);
+            RouteStep scale;
+            scale.op = RouteOp::Scale;
+            scale.dst = buffer;
+            scale.gain = gain;
+            out.push_back(scale);
+
+            for (size_t i = 1; i < count; ++i)
+            {
+                RouteStep mix;
+                mix.op = RouteOp::Mix;
+                mix.src = branchBuffers[i];
+                mix.dst = buffer;
+                mix.gain = gain;
+                out.push_back(mix);
+            }
+            return true;
+        }
+    };
+}
+
+bool RoutingGraph::compile(const std::string &route, RouteSchedule &schedule, std::string &error)
+{
+    RouteCompiler compiler(route);
+    std::vector<RouteStep> main;
+
+    bool ok = compiler.sequence(0, true, main);
+    if (ok && compiler.peek() != '\0')
+        ok = compiler.fail(std::string("Unexpected '") + compiler.peek() + "'");
+    if (ok && main.size() + compiler.bodies.size() > MAX_ROUTE_STEPS)
+        ok = compiler.fail("Route too long");
+    if (!ok)
+    {
+        error = compiler.error;
+        return false;
+    }
+
+    RouteSchedule result;
+    size_t forksSinceJoin = 0;
+    for (size_t i = 0; i < main.size(); ++i)
+    {
+        RouteStep step = main[i];
+        if (step.op == RouteOp::Fork)
+        {
+            // Branch bodies are stored after the main steps
+            step.begin = static_cast<uint16_t>(step.begin + main.size());
+            step.end = static_cast<uint16_t>(step.end + main.size());
+            result.forks = static_cast<uint8_t>(std::max(++forksSinceJoin, static_cast<size_t>(result.forks)));
+        }
+        else if (step.op == RouteOp::Join)
+        {
+            forksSinceJoin = 0;
+        }
+        result.steps[i] = step;
+    }
+    std::copy(compiler.bodies.begin(), compiler.bodies.end(), result.steps + main.size());
+
+    result.mainSteps = static_cast<uint16_t>(main.size());
+    result.totalSteps = static_cast<uint16_t>(main.size() + compiler.bodies.size());
+    result.buffers = compiler.maxBuffers;
+    schedule = result;
+    return true;
+}
+
+RouteSchedule RoutingGraph::serial()
+{
+    RouteSchedule schedule;
+    for (const EffectInfo &info : EffectRegistry::table)
+    {
+        RouteStep &step = schedule.steps[schedule.mainSteps++];
+        step.op = RouteOp::Process;
+        step.effect = info.id;
+    }
+    schedule.totalSteps = schedule.mainSteps;
+    return schedule;
+}
@@ -0,0 +1,91 @@
+#ifndef ROUTINGGRAPH_H
+#define ROUTINGGRAPH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+constexpr size_t MAX_ROUTE_STEPS = 64;   ///< Capacity of a compiled schedule
+constexpr size_t MAX_ROUTE_BUFFERS = 8;  ///< Branch buffers, including the caller's buffer 0
+
+/**
+ * @brief Operations of a compiled route.
+ */
+enum class RouteOp : uint8_t
+{
+    Process, ///< Run effect `effect` in place on buffer `dst`
+    Copy,    ///< dst = src (feeds a branch)
+    Scale,   ///< dst *= gain
+    Mix,     ///< dst += src * gain
+    Fork,    ///< Hand steps [begin, end) to a helper thread, or run them inline if none is free
+    Join,    ///< Wait for every branch forked since the previous Join
+};
+
+/**
+ * @struct RouteStep
+ * @brief One instruction of a compiled route.
+ */
+struct RouteStep
+{
+    RouteOp op = RouteOp::Process;
+    uint8_t effect = 0;  ///< EffectId (Process)
+    uint8_t src = 0;     ///< Source buffer (Copy, Mix)
+    uint8_t dst = 0;     ///< Destination buffer
+    uint16_t begin = 0;  ///< First step of a forked branch (Fork)
+    uint16_t end = 0;    ///< One past the last step of a forked branch (Fork)
+    float gain = 1.0f;   ///< Scale, Mix
+};
+
+/**
+ * @struct RouteSchedule
+ * @brief Flat, fixed-size execution schedule compiled from a route description.
+ *
+ * Steps [0, mainSteps) run on the audio thread; the bodies of forked branches
+ * follow them. The schedule holds no pointers, so it can be copied into a
+ * TripleBuffer and handed to the audio thread.
+ */
+struct RouteSchedule
+{
+    RouteStep steps[MAX_ROUTE_STEPS];
+    uint16_t mainSteps = 0;  ///< Steps run directly by the caller
+    uint16_t totalSteps = 0; ///< mainSteps plus the forked branch bodies
+    uint8_t buffers = 1;     ///< Buffers used, including buffer 0
+    uint8_t forks = 0;       ///< Most branches forked at once (helper threads that can be used)
+};
+
+/**
+ * @class RoutingGraph
+ * @brief Compiles a route description into a RouteSchedule.
+ *
+ * A route lists effects by registry name (case-insensitive) in processing order.
+ * Square brackets split the signal into parallel branches separated by '|',
+ * which are mixed back together at equal gain (1/branches). An empty branch is
+ * a dry path. Branches can nest. For example:
+ * @code
+ * route, true, gain [harmonizer | fuzz]
+ * @endcode
+ * runs Gain, then Harmonizer and Fuzz in parallel on copies of its output.
+ * Top-level branches other than the first are forked so that they can run on
+ * other cores. Each effect may appear at most once; effects not named are not run.
+ * Consecutive effects that match a fused StaticChain (FusedEffects) are compiled
+ * to a single step running that chain.
+ */
+class RoutingGraph
+{
+public:
+    /**
+     * @brief Compiles a route description.
+     * @param route The route text (the value of the "route" config key).
+     * @param schedule Receives the schedule; untouched on failure.
+     * @param error Receives a description of the problem on failure.
+     * @return true on success.
+     */
+    static bool compile(const std::string &route, RouteSchedule &schedule, std::string &error);
+
+    /**
+     * @brief Every registered effect in series, in registry order (the default route).
+     */
+    static RouteSchedule serial();
+};
+
+#endif // ROUTINGGRAPH_H
@@ -0,0 +1,42 @@
+#include "ShaperTable.h"
+
+namespace
+{
+    // 5-point Gauss-Legendre nodes and weights on [-1, 1]
+    constexpr double NODES[] = {0.0, -0.5384693101056831, 0.5384693101056831, -0.9061798459386640, 0.9061798459386640};
+    constexpr double WEIGHTS[] = {0.5688888888888889, 0.4786286704993665, 0.4786286704993665, 0.2369268850561891, 0.2369268850561891};
+
+    // Integral of f over [a, b]
+    template <typename F>
+    double integrate(const F &f, double a, double b)
+    {
+        const double half = 0.5 * (b - a), mid = 0.5 * (a + b);
+        double sum = 0.0;
+        for (size_t i = 0; i < 5; ++i)
+            sum += WEIGHTS[i] * f(mid + half * NODES[i]);
+        return half * sum;
+    }
+}
+
+ShaperTable::ShaperTable(Curve curve)
+    : f0(INTERVALS + 1), f1(INTERVALS + 1), f2(INTERVALS + 1)
+{
+    const size_t zero = INTERVALS / 2; // Grid point at x = 0, where F1 = F2 = 0
+    auto at = [](size_t j) { return -RANGE + j * STEP; };
+
+    for (size_t j = 0; j <= INTERVALS; ++j)
+        f0[j] = curve(at(j));
+
+    // Walk outwards from 0; within an interval F1(x) = F1(x_j) + integral of f from x_j
+    auto step = [&](size_t from, size_t to) {
+        const double a = at(from), b = at(to);
+        const double F1a = f1[from];
+        f1[to] = F1a + integrate(curve, a, b);
+        f2[to] = f2[from] + integrate([&](double x) { return F1a + integrate(curve, a, x); }, a, b);
+    };
+    f1[zero] = f2[zero] = 0.0;
+    for (size_t j = zero; j < INTERVALS; ++j)
+        step(j, j + 1);
+    for (size_t j = zero; j > 0; --j)
+        step(j, j - 1);
+}
@@ -0,0 +1,101 @@
+#ifndef SHAPERTABLE_H
+#define SHAPERTABLE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @class ShaperTable
+ * @brief Lookup tables of a waveshaping curve f and its first two antiderivatives.
+ *
+ * Built once from f alone: F1 = integral of f and F2 = integral of F1 (both
+ * zero at 0) are integrated numerically with Gauss-Legendre quadrature on a
+ * uniform grid over [-RANGE, RANGE]. Because each table's derivative is the
+ * previous table, F1 and F2 are read back with cubic Hermite interpolation,
+ * which keeps the errors far below what antiderivative anti-aliasing (ADAA)
+ * amplifies when it divides their differences. Outside the grid the curve is
+ * taken as flat (all supported curves saturate), which extends F1 and F2
+ * exactly. Lookups are inline and branch-free so block loops vectorise.
+ */
+class ShaperTable
+{
+public:
+    static constexpr double RANGE = 16.0;      ///< Tabulated input range is [-RANGE, RANGE]
+    static constexpr size_t INTERVALS = 4096;  ///< Grid intervals across the range
+
+    using Curve = double (*)(double);
+
+    explicit ShaperTable(Curve curve);
+
+    /**
+     * @brief The curve itself (linear interpolation).
+     */
+    double f(double x) const
+    {
+        size_t j;
+        double t;
+        locate(x, j, t);
+        return lerp(f0, j, t);
+    }
+
+    /**
+     * @brief First antiderivative (Hermite interpolation).
+     */
+    double F1(double x) const
+    {
+        size_t j;
+        double t;
+        const double beyond = locate(x, j, t);
+        // Flat curve beyond the grid: F1 grows linearly
+        return hermite(f1, f0, j, t) + lerp(f0, j, t) * beyond;
+    }
+
+    /**
+     * @brief Second antiderivative (Hermite interpolation).
+     */
+    double F2(double x) const
+    {
+        size_t j;
+        double t;
+        const double beyond = locate(x, j, t);
+        return hermite(f2, f1, j, t) + (hermite(f1, f0, j, t) + 0.5 * lerp(f0, j, t) * beyond) * beyond;
+    }
+
+private:
+    static constexpr double STEP = 2.0 * RANGE / INTERVALS;
+
+    /**
+     * @brief Clamps x to the grid and splits it into an interval index and fraction.
+     * @return x minus its clamped value (0 inside the grid)
+     */
+    static double locate(double x, size_t &index, double &t)
+    {
+        const double clamped = std::min(std::max(x, -RANGE), RANGE);
+        const double position = (clamped + RANGE) * (1.0 / STEP);
+        index = std::min(static_cast<size_t>(position), INTERVALS - 1);
+        t = position - static_cast<double>(index);
+        return x - clamped;
+    }
+
+    static double lerp(const std::vector<double> &v, size_t j, double t)
+    {
+        return v[j] + t * (v[j + 1] - v[j]);
+    }
+
+    /**
+     * @brief Cubic Hermite interpolation of v on interval j, whose derivative is dv.
+     */
+    static double hermite(const std::vector<double> &v, const std::vector<double> &dv, size_t j, double t)
+    {
+        const double t2 = t * t, t3 = t2 * t;
+        return (2 * t3 - 3 * t2 + 1) * v[j] + (-2 * t3 + 3 * t2) * v[j + 1] +
+               STEP * ((t3 - 2 * t2 + t) * dv[j] + (t3 - t2) * dv[j + 1]);
+    }
+
+    std::vector<double> f0; ///< f at each grid point
+    std::vector<double> f1; ///< F1 at each grid point
+    std::vector<double> f2; ///< F2 at each grid point
+};
+
+#endif // SHAPERTABLE_H
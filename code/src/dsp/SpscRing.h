@@ -0,0 +1,91 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @class SpscRing
+ * @brief Lock-free single-producer/single-consumer ring of trivially copyable values.
+ *
+ * Each side owns one index and only reads the other's, so a write or read is a
+ * memcpy (two at the wrap) and one release store. The producer never waits: a
+ * write that does not fit is truncated, so a stalled consumer costs it samples,
+ * never time. Capacity is a power of two, allocated by allocate().
+ *
+ * @tparam T Element type; copied with memcpy.
+ */
+template <typename T>
+class SpscRing
+{
+    static_assert(std::is_trivially_copyable_v<T>, "SpscRing copies with memcpy");
+
+public:
+    /**
+     * @brief Allocates room for at least `count` elements and empties the ring.
+     *        Not thread-safe: call before either side starts.
+     */
+    void allocate(size_t count)
+    {
+        size_t size = 1;
+        while (size < count)
+            size <<= 1;
+        slots.assign(size, T{});
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Producer: copies in as many of `count` elements as fit.
+     * @return Number of elements written.
+     */
+    size_t write(const T *values, size_t count)
+    {
+        const size_t written = head.load(std::memory_order_relaxed);
+        const size_t room = slots.size() - (written - tail.load(std::memory_order_acquire));
+        const size_t n = std::min(count, room);
+        const size_t start = written & (slots.size() - 1);
+        const size_t first = std::min(n, slots.size() - start);
+        std::memcpy(slots.data() + start, values, first * sizeof(T));
+        std::memcpy(slots.data(), values + first, (n - first) * sizeof(T));
+        head.store(written + n, std::memory_order_release);
+        return n;
+    }
+
+    /**
+     * @brief Consumer: copies out up to `count` of the oldest elements.
+     * @return Number of elements read.
+     */
+    size_t read(T *values, size_t count)
+    {
+        const size_t consumed = tail.load(std::memory_order_relaxed);
+        const size_t n = std::min(count, head.load(std::memory_order_acquire) - consumed);
+        const size_t start = consumed & (slots.size() - 1);
+        const size_t first = std::min(n, slots.size() - start);
+        std::memcpy(values, slots.data() + start, first * sizeof(T));
+        std::memcpy(values + first, slots.data(), (n - first) * sizeof(T));
+        tail.store(consumed + n, std::memory_order_release);
+        return n;
+    }
+
+    /**
+     * @brief Elements waiting to be read (exact for the consumer, a lower bound for the producer).
+     */
+    size_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Number of elements the ring holds.
+     */
+    size_t capacity() const { return slots.size(); }
+
+private:
+    std::vector<T> slots;
+    alignas(64) std::atomic<size_t> head{0}; ///< Elements written; stored by the producer
+    alignas(64) std::atomic<size_t> tail{0}; ///< Elements read; stored by the consumer
+};
+
+#endif // SPSCRING_H
@@ -0,0 +1,150 @@
+#ifndef STATICCHAIN_H
+#define STATICCHAIN_H
+
+#include <algorithm>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "Effect.h"
+#include "EffectList.h"
+#include "Oversampler.h"
+
+namespace static_chain_detail
+{
+    template <typename Stage, typename = void>
+    struct Oversamples : std::false_type
+    {
+    };
+
+    template <typename Stage>
+    struct Oversamples<Stage, std::void_t<decltype(std::declval<const Stage &>().oversampleFactor())>> : std::true_type
+    {
+    };
+}
+
+/**
+ * @class StaticChain
+ * @brief A fixed series of effects fused into a single Effect.
+ *
+ * Each stage must provide a `Kernel kernel() const` returning a small functor
+ * that processes one sample and is the identity when the stage is inactive
+ * (see Gain and Fuzz). The kernels are captured once per block, so the block
+ * loop has no virtual calls, no branches on the active flags and no
+ * intermediate passes over the buffer, and the compiler can inline and
+ * vectorise the whole chain.
+ *
+ * Stages that oversample (provide oversampleFactor()/oversampleQuality(), like
+ * Fuzz) make the whole fused kernel run inside one Oversampler at the highest
+ * factor requested by any stage.
+ *
+ * A StaticChain is hosted by DigitalSignalChain as one slot: list it in
+ * FusedEffects (EffectRegistry.h) and any route that names its stages
+ * consecutively uses it instead of the individual effects.
+ *
+ * @tparam Stages Effect types in processing order.
+ */
+template <typename... Stages>
+class StaticChain : public Effect
+{
+public:
+    using StageList = EffectList<Stages...>; ///< The fused effects, in order
+
+    StaticChain()
+    {
+        IsActive = (std::get<Stages>(stages).isActive() || ...);
+    }
+
+    float process(float sample) override
+    {
+        processBlock(&sample, 1);
+        return sample;
+    }
+
+    void processBlock(float *samples, size_t count) override
+    {
+        const auto fused = kernels();
+        size_t factor = 1;
+        OversampleQuality quality = OversampleQuality::Low;
+        (oversampling(std::get<Stages>(stages), factor, quality), ...);
+
+        if (factor > 1)
+        {
+            oversampler.select(factor, quality);
+            oversampler.process(samples, count, [&fused](float sample) { return apply(fused, sample); });
+            return;
+        }
+        oversampler.select(1, quality);
+        for (size_t i = 0; i < count; ++i)
+            samples[i] = apply(fused, samples[i]);
+    }
+
+    /**
+     * @brief Configures every stage from its own key; active if any stage is.
+     */
+    bool configure(const Config &config) override
+    {
+        const bool changed = (std::get<Stages>(stages).configure(config) | ...);
+        IsActive = (std::get<Stages>(stages).isActive() || ...);
+        return changed;
+    }
+
+    /**
+     * @brief Prepares every stage for the stream.
+     */
+    void prepare(float sampleRate, size_t maxBlockSize, size_t channels) override
+    {
+        Effect::prepare(sampleRate, maxBlockSize, channels);
+        (std::get<Stages>(stages).prepare(sampleRate, maxBlockSize, channels), ...);
+        oversampler.reset();
+    }
+
+    void reset() override
+    {
+        (std::get<Stages>(stages).reset(), ...);
+        oversampler.reset();
+    }
+
+    void release() override
+    {
+        (std::get<Stages>(stages).release(), ...);
+    }
+
+    /**
+     * @brief Access to one stage (e.g. for tests).
+     */
+    template <typename Stage>
+    const Stage &stage() const { return std::get<Stage>(stages); }
+
+protected:
+    void parseConfig(const Config &) override {}
+    const char *configKey() const override { return ""; }
+
+private:
+    auto kernels() const
+    {
+        return std::make_tuple(std::get<Stages>(stages).kernel()...);
+    }
+
+    template <typename Kernels>
+    static float apply(const Kernels &fused, float sample)
+    {
+        std::apply([&sample](const auto &...kernel) { ((sample = kernel(sample)), ...); }, fused);
+        return sample;
+    }
+
+    template <typename Stage>
+    static void oversampling(const Stage &stage, size_t &factor, OversampleQuality &quality)
+    {
+        if constexpr (static_chain_detail::Oversamples<Stage>::value)
+        {
+            factor = std::max(factor, stage.oversampleFactor());
+            quality = std::max(quality, stage.oversampleQuality());
+        }
+    }
+
+    std::tuple<Stages...> stages;
+    Oversampler oversampler; ///< Shared by all stages when any of them oversamples
+};
+
+#endif // STATICCHAIN_H
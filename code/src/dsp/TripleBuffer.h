@@ -0,0 +1,73 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @class TripleBuffer
+ * @brief Wait-free single-writer/single-reader hand-off of a value.
+ *
+ * The writer fills its private slot and publishes it with one atomic exchange;
+ * the reader adopts the newest published slot with one atomic exchange. Neither
+ * side ever blocks or sees a half-written value, so the reader can be the audio
+ * thread. Values that are published faster than they are read are skipped.
+ *
+ * @tparam T Value type; copied into place by the writer.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+    /**
+     * @brief Writer: slot to fill before calling publish().
+     */
+    T &writeBuffer() { return slots[writeIndex]; }
+
+    /**
+     * @brief Writer: makes the write buffer the newest value.
+     */
+    void publish()
+    {
+        const uint8_t previous = middle.exchange(writeIndex | DIRTY, std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+    }
+
+    /**
+     * @brief Writer: copies value into the write buffer and publishes it.
+     */
+    void publish(const T &value)
+    {
+        writeBuffer() = value;
+        publish();
+    }
+
+    /**
+     * @brief Reader: adopts the newest published value, if any.
+     * @return true if a new value was adopted.
+     */
+    bool update()
+    {
+        if (!(middle.load(std::memory_order_relaxed) & DIRTY))
+            return false;
+        const uint8_t previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+    /**
+     * @brief Reader: the value adopted by the last update().
+     */
+    const T &read() const { return slots[readIndex]; }
+
+private:
+    static constexpr uint8_t DIRTY = 0x4;      ///< Set on the middle index when it holds an unread value
+    static constexpr uint8_t INDEX_MASK = 0x3; ///< Slot index bits
+
+    T slots[3] = {};
+    uint8_t writeIndex = 0;             ///< Owned by the writer
+    std::atomic<uint8_t> middle{1};     ///< Exchanged between writer and reader
+    uint8_t readIndex = 2;              ///< Owned by the reader
+};
+
+#endif // TRIPLEBUFFER_H
@@ -0,0 +1,114 @@
+#ifndef WAVETABLELFO_H
+#define WAVETABLELFO_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class WavetableLFO
+ * @brief Sine oscillator read from one shared table instead of calling std::sin.
+ *
+ * The table (one cycle, SIZE points plus a guard point) is built once, on first
+ * use, and shared by every LFO in the chain. The phase is a 32-bit fixed-point
+ * fraction of a cycle, so it wraps for free; its top BITS select the table
+ * interval and the rest interpolate linearly within it (error below 2e-6).
+ *
+ * render() reads the table only every SEGMENT samples and draws straight
+ * lines between those points, so the per-sample work is a vector
+ * multiply-add rather than a table gather (which NEON cannot do). At 5 Hz
+ * the straight segments stay within 4e-6 of the sine.
+ */
+class WavetableLFO
+{
+public:
+    static constexpr unsigned BITS = 11;
+    static constexpr size_t SIZE = size_t(1) << BITS; ///< Table intervals per cycle
+    static constexpr size_t SEGMENT = 8;              ///< Samples between table reads in render()
+
+    WavetableLFO() { table(); } // Build the table here, not on the audio thread
+
+    /**
+     * @brief sin(2 pi cycles), for any cycles (e.g. a float phase kept in [0, 1)).
+     */
+    static float sine(float cycles)
+    {
+        return lookup(table(), static_cast<uint32_t>(static_cast<int64_t>(std::floor(cycles * 4294967296.0))));
+    }
+
+    /**
+     * @brief Sets the frequency.
+     */
+    void setRate(float hz, float sampleRate)
+    {
+        increment = static_cast<uint32_t>(std::llround(hz / sampleRate * 4294967296.0));
+    }
+
+    /**
+     * @brief Sets the phase, in cycles.
+     */
+    void setPhase(float cycles) { phase = toPhase(cycles); }
+
+    /**
+     * @brief Converts cycles to a phase (or phase offset).
+     */
+    static uint32_t toPhase(float cycles)
+    {
+        return static_cast<uint32_t>(static_cast<int64_t>(std::floor((cycles - std::floor(cycles)) * 4294967296.0)));
+    }
+
+    /**
+     * @brief Writes the next `count` values, shifted by `offset`, without advancing.
+     */
+    void render(float *out, size_t count, uint32_t offset = 0) const
+    {
+        const float *t = table();
+        const uint32_t stride = increment * static_cast<uint32_t>(SEGMENT);
+        uint32_t p = phase + offset;
+        float from = lookup(t, p);
+        for (size_t s = 0; s < count; s += SEGMENT)
+        {
+            p += stride;
+            const float to = lookup(t, p);
+            const float slope = (to - from) * (1.0f / SEGMENT);
+            float line[SEGMENT];
+            for (size_t i = 0; i < SEGMENT; ++i)
+                line[i] = from + slope * static_cast<float>(i);
+            std::copy(line, line + std::min(SEGMENT, count - s), out + s);
+            from = to;
+        }
+    }
+
+    /**
+     * @brief Moves the phase on by `count` samples.
+     */
+    void advance(size_t count) { phase += static_cast<uint32_t>(count) * increment; }
+
+private:
+    static constexpr unsigned FRACTION_BITS = 32 - BITS;
+
+    static const float *table()
+    {
+        static const std::array<float, SIZE + 1> values = [] {
+            std::array<float, SIZE + 1> v{};
+            for (size_t j = 0; j <= SIZE; ++j)
+                v[j] = static_cast<float>(std::sin(2.0 * M_PI * static_cast<double>(j) / SIZE));
+            return v;
+        }();
+        return values.data();
+    }
+
+    static float lookup(const float *t, uint32_t p)
+    {
+        const uint32_t j = p >> FRACTION_BITS;
+        const float u = static_cast<float>(p & ((uint32_t(1) << FRACTION_BITS) - 1)) * (1.0f / (1 << FRACTION_BITS));
+        return t[j] + u * (t[j + 1] - t[j]);
+    }
+
+    uint32_t phase = 0;     ///< Fraction of a cycle, 2^32 = one cycle
+    uint32_t increment = 0; ///< Phase advance per sample
+};
+
+#endif // WAVETABLELFO_H
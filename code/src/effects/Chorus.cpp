@@ -0,0 +1,173 @@
+#include "Chorus.h"
+#include "EffectRegistration.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+    // Restrict-qualified so GCC vectorises without run-time alias checks
+    void mixStereo(float *__restrict left, float *__restrict right, float *__restrict lineInput,
+                   const float *__restrict wetLeft, const float *__restrict wetRight,
+                   float wetLevel, float feedbackLevel, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            const float input = 0.5f * (left[i] + right[i]);
+            lineInput[i] = input + feedbackLevel * 0.5f * (wetLeft[i] + wetRight[i]);
+            left[i] += wetLevel * wetLeft[i];
+            right[i] += wetLevel * wetRight[i];
+        }
+    }
+}
+
+Chorus::Chorus()
+{
+    IsActive = false;
+    Setting = rateHz;
+    prepare(DEFAULT_SAMPLE_RATE, MAX_BLOCK_SIZE, MAX_CHANNELS);
+}
+
+void Chorus::prepare(float sampleRate, size_t maxBlockSize, size_t channels)
+{
+    Effect::prepare(sampleRate, maxBlockSize, channels);
+    // The only allocation: the longest delay, plus a chunk and the cubic's taps
+    line.allocate(static_cast<size_t>(MAX_DELAY_MS * 0.001f * SampleRate) + CHUNK + 4);
+    settingChanged();
+    lfo.setPhase(0.0f);
+}
+
+void Chorus::reset()
+{
+    line.clear();
+    lfo.setPhase(0.0f);
+}
+
+void Chorus::release()
+{
+    line.release();
+}
+
+float Chorus::process(float sample)
+{
+    processBlock(&sample, 1);
+    return sample;
+}
+
+void Chorus::processBlock(float *samples, size_t count)
+{
+    processChannels(&samples, 1, count);
+}
+
+void Chorus::processChannels(float *const *channels, size_t channelCount, size_t frames)
+{
+    if (!IsActive)
+        return;
+    const bool stereo = channelCount > 1;
+
+    // One consistent set of parameters per block
+    const size_t v = voices, longest = span;
+    const float c = centre, d = depth, g = voiceGain;
+    const float wetLevel = mix * g, feedbackLevel = feedback * g;
+
+    for (size_t done = 0; done < frames; done += longest)
+    {
+        const size_t n = std::min(longest, frames - done);
+        const float minimum = static_cast<float>(n + 1);
+        const float maximum = static_cast<float>(line.capacity() - n - 4);
+
+        std::fill(wet, wet + n, 0.0f);
+        std::fill(wetRight, wetRight + (stereo ? n : 0), 0.0f);
+        for (size_t k = 0; k < v; ++k)
+        {
+            lfo.render(delays, n, offsets[k]);
+            for (size_t i = 0; i < n; ++i)
+                delays[i] = std::min(std::max(c + d * delays[i], minimum), maximum);
+            line.readModulated(voice, delays, n);
+            if (!stereo)
+            {
+                for (size_t i = 0; i < n; ++i)
+                    wet[i] += voice[i];
+                continue;
+            }
+            const float left = panLeft[k], right = panRight[k];
+            for (size_t i = 0; i < n; ++i)
+            {
+                wet[i] += left * voice[i];
+                wetRight[i] += right * voice[i];
+            }
+        }
+        lfo.advance(n);
+
+        if (stereo)
+        {
+            // The line takes the mono fold of both the input and the voices
+            mixStereo(channels[0] + done, channels[1] + done, voice, wet, wetRight, wetLevel, feedbackLevel, n);
+        }
+        else
+        {
+            float *block = channels[0] + done;
+            for (size_t i = 0; i < n; ++i)
+            {
+                const float input = block[i];
+                voice[i] = input + feedbackLevel * wet[i]; // The line's input
+                block[i] = input + wetLevel * wet[i];
+            }
+        }
+        line.write(voice, n);
+    }
+}
+
+void Chorus::settingChanged()
+{
+    try
+    {
+        rateHz = std::any_cast<float>(Setting);
+    }
+    catch (...)
+    {
+        rateHz = flanger ? 0.25f : 0.8f; // Fallback rate
+    }
+
+    const float shortest = MIN_DELAY_MS * 0.001f * SampleRate;
+    const float longest = MAX_DELAY_MS * 0.001f * SampleRate;
+    centre = std::min(std::max(delayMs * 0.001f * SampleRate, shortest), longest);
+    depth = std::min(std::max(depthMs * 0.001f * SampleRate, 0.0f), std::min(centre - shortest, longest - centre));
+    voiceGain = 1.0f / static_cast<float>(voices);
+    for (size_t k = 0; k < MAX_VOICES; ++k)
+    {
+        offsets[k] = WavetableLFO::toPhase(static_cast<float>(k) / static_cast<float>(voices));
+        // Linear pan from left to right: the two gains always sum to 2, so the mono fold is unchanged
+        const float pan = voices > 1 ? spread * (2.0f * static_cast<float>(k) / static_cast<float>(voices - 1) - 1.0f) : 0.0f;
+        panLeft[k] = 1.0f - pan;
+        panRight[k] = 1.0f + pan;
+    }
+
+    // Every read in a chunk must already be in the line: chunk + 1 <= shortest delay
+    span = std::min(std::max(static_cast<size_t>(centre - depth), size_t(2)) - 1, CHUNK);
+    lfo.setRate(std::max(rateHz, 0.0f), SampleRate);
+}
+
+Chorus::~Chorus()
+{
+    std::cout << "[Chorus] Chorus destroyed cleanly\n";
+}
+
+void Chorus::parseConfig(const Config &config)
+{
+    IsActive = config.contains("chorus");
+    flanger = config.get<std::string>("chorus_mode", "chorus") == "flanger";
+    Setting = config.getNumber("chorus", flanger ? 0.25f : 0.8f);
+
+    // The mode only picks defaults; every parameter can still be set
+    const float voicesWanted = config.getNumber("chorus_voices", flanger ? 1.0f : 2.0f);
+    voices = static_cast<size_t>(std::min(std::max(voicesWanted, 1.0f), static_cast<float>(MAX_VOICES)));
+    delayMs = config.getNumber("chorus_delay", flanger ? 2.5f : 15.0f);
+    depthMs = config.getNumber("chorus_depth", flanger ? 2.0f : 3.0f);
+    mix = std::max(config.getNumber("chorus_mix", flanger ? 0.7f : 0.5f), 0.0f);
+    feedback = std::min(std::max(config.getNumber("chorus_feedback", flanger ? 0.6f : 0.0f), -0.95f), 0.95f);
+    spread = std::min(std::max(config.getNumber("chorus_spread", 0.5f), 0.0f), 1.0f);
+    settingChanged();
+}
+
+REGISTER_EFFECT_AUTO(Chorus);
@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdint>
+#include "DelayLine.h"
+#include "Effect.h"
+#include "WavetableLFO.h"
+
+/**
+ * @class Chorus
+ * @brief Chorus (up to MAX_VOICES modulated voices) or flanger (short delay with feedback).
+ *
+ * Every voice reads the same DelayLine, allocated by prepare() for the
+ * longest delay at the stream's rate, at a delay swept by a WavetableLFO; the voices share one LFO and
+ * are spread evenly around its cycle. Per block, the LFO values and read
+ * positions are computed for a whole chunk at a time and the interpolated
+ * reads are vectorised across the chunk (DelayLine::readModulated).
+ *
+ * A chunk never reaches past the shortest delay, so a flanger sweeping down
+ * to a fraction of a millisecond is processed in correspondingly short chunks
+ * and its feedback stays sample-exact.
+ *
+ * In stereo the voices are panned evenly across the image, with a linear law
+ * whose mono fold is exactly the mono chorus. The line is fed the mono fold of
+ * the input; the dry channels pass through as they are. A single voice (the
+ * flanger's default) stays in the centre.
+ *
+ * Config: "chorus" (LFO rate in Hz), "chorus_mode" (chorus or flanger, which
+ * picks the defaults below), "chorus_voices" (1..4), "chorus_delay" (centre
+ * delay in ms), "chorus_depth" (sweep either side of it in ms), "chorus_mix"
+ * (wet level), "chorus_feedback" (-0.95..0.95) and "chorus_spread" (stereo
+ * width of the voices, 0..1).
+ */
+class Chorus : public Effect
+{
+public:
+    static constexpr const char *Name = "Chorus"; ///< Name in the effect registry
+    static constexpr size_t MAX_VOICES = 4;
+    static constexpr float MAX_DELAY_MS = 40.0f;  ///< Longest delay a voice reaches
+    static constexpr float MIN_DELAY_MS = 0.25f;  ///< Shortest delay a voice reaches
+    static constexpr size_t CHUNK = 32;           ///< Longest pass
+
+    Chorus();
+    float process(float sample) override;
+    void processBlock(float *samples, size_t count) override;
+    ChannelLayout channelLayout() const override { return ChannelLayout::Stereo; }
+    void processChannels(float *const *channels, size_t channelCount, size_t frames) override;
+    void prepare(float sampleRate, size_t maxBlockSize, size_t channels) override;
+    void reset() override;
+    void release() override;
+    ~Chorus();
+
+    /**
+     * @brief Voices in use.
+     */
+    size_t voiceCount() const { return voices; }
+
+protected:
+    void parseConfig(const Config &config) override;
+    const char *configKey() const override { return "chorus"; }
+    void settingChanged() override;
+
+private:
+    float rateHz = 0.8f;           ///< Setting
+    bool flanger = false;
+    float delayMs = 15.0f;
+    float depthMs = 3.0f;
+    float mix = 0.5f;
+    float feedback = 0.0f;
+    float spread = 0.5f;
+
+    // Derived in settingChanged(), off the audio path
+    size_t voices = 2;
+    float centre = 0.0f;           ///< Centre delay in samples
+    float depth = 0.0f;            ///< Sweep either side of the centre, in samples
+    float voiceGain = 0.5f;        ///< Wet level per voice
+    size_t span = CHUNK;           ///< Longest chunk the shortest delay allows
+    uint32_t offsets[MAX_VOICES] = {}; ///< LFO phase of each voice
+    float panLeft[MAX_VOICES] = {};    ///< Stereo gains of each voice; each pair sums to 2
+    float panRight[MAX_VOICES] = {};
+
+    // Audio thread state
+    DelayLine line;
+    WavetableLFO lfo;
+    float wet[CHUNK] = {};         ///< Wet signal (left channel in stereo)
+    float wetRight[CHUNK] = {};
+    float voice[CHUNK] = {};
+    float delays[CHUNK] = {};
+};
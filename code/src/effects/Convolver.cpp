@@ -0,0 +1,214 @@
+#include "Convolver.h"
+#include "EffectRegistration.h"
+#include "PartitionCache.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <sndfile.h>
+
+namespace
+{
+    constexpr size_t DEFAULT_PARTITION = 128;
+    constexpr size_t MIN_PARTITION = 32;
+    constexpr size_t MAX_PARTITION = 1024;
+    constexpr int RESAMPLE_ZEROS = 16; ///< Sinc zero crossings on each side of a resampled tap
+
+    // Windowed-sinc resampling by `ratio` (output rate / input rate). An IR's samples
+    // are scaled by 1 / ratio so the filter keeps its gain at the new rate.
+    std::vector<float> resample(const std::vector<float> &in, double ratio)
+    {
+        const double cutoff = std::min(1.0, ratio); // Relative to the input Nyquist
+        const double reach = RESAMPLE_ZEROS / cutoff;
+        std::vector<float> out(static_cast<size_t>(std::ceil(in.size() * ratio)));
+        for (size_t m = 0; m < out.size(); ++m)
+        {
+            const double t = m / ratio;
+            const long first = std::max(0L, static_cast<long>(std::ceil(t - reach)));
+            const long last = std::min(static_cast<long>(in.size()) - 1, static_cast<long>(std::floor(t + reach)));
+            double sum = 0.0;
+            for (long k = first; k <= last; ++k)
+            {
+                const double x = (t - k) * cutoff;
+                const double sinc = x == 0.0 ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+                const double window = 0.42 + 0.5 * std::cos(M_PI * x / RESAMPLE_ZEROS) +
+                                      0.08 * std::cos(2.0 * M_PI * x / RESAMPLE_ZEROS); // Blackman
+                sum += in[k] * cutoff * sinc * window;
+            }
+            out[m] = static_cast<float>(sum / ratio);
+        }
+        return out;
+    }
+}
+
+Convolver::Convolver()
+{
+    IsActive = false;
+    Setting = std::string();
+}
+
+bool Convolver::loadImpulse(const std::string &path, float sampleRate, std::vector<float> &impulse)
+{
+    SF_INFO info = {};
+    SNDFILE *file = sf_open(path.c_str(), SFM_READ, &info);
+    if (!file)
+    {
+        std::cerr << "[Convolver] Failed to open IR " << path << ": " << sf_strerror(nullptr) << "\n";
+        return false;
+    }
+
+    const size_t channels = static_cast<size_t>(std::max(info.channels, 1));
+    std::vector<float> frames(static_cast<size_t>(info.frames) * channels);
+    const sf_count_t read = sf_readf_float(file, frames.data(), info.frames);
+    sf_close(file);
+    if (read <= 0)
+    {
+        std::cerr << "[Convolver] IR " << path << " has no samples\n";
+        return false;
+    }
+
+    // Mix down to mono
+    std::vector<float> mono(static_cast<size_t>(read));
+    for (size_t i = 0; i < mono.size(); ++i)
+    {
+        float sum = 0.0f;
+        for (size_t c = 0; c < channels; ++c)
+            sum += frames[i * channels + c];
+        mono[i] = sum / channels;
+    }
+
+    if (info.samplerate > 0 && static_cast<float>(info.samplerate) != sampleRate)
+    {
+        std::cout << "[Convolver] Resampling IR from " << info.samplerate << " Hz to " << sampleRate << " Hz\n";
+        mono = resample(mono, sampleRate / info.samplerate);
+    }
+    if (mono.size() > MAX_TAPS)
+    {
+        std::cerr << "[Convolver] IR " << path << " truncated to " << MAX_TAPS << " taps\n";
+        mono.resize(MAX_TAPS);
+    }
+    impulse = std::move(mono);
+    return true;
+}
+
+Convolver::Engine Convolver::buildEngine(const std::string &path, size_t partition) const
+{
+    PartitionCacheKey key;
+    key.sampleRate = static_cast<uint32_t>(SampleRate);
+    key.partitionSize = static_cast<uint32_t>(partition);
+    const bool cached = useCache && PartitionCache::hashFile(path, key.hash);
+    const std::string cachePath = PartitionCache::pathFor(path, key);
+
+    if (cached)
+    {
+        if (std::shared_ptr<const PartitionCache> cache = PartitionCache::map(cachePath, key))
+            return std::make_unique<PartitionedConvolution>(cache->spectra(), cache);
+    }
+
+    std::vector<float> impulse;
+    if (!loadImpulse(path, SampleRate, impulse))
+        return nullptr;
+
+    Engine built = std::make_unique<PartitionedConvolution>(impulse, partition);
+    if (cached && !PartitionCache::write(cachePath, key, built->spectra()))
+        std::cerr << "[Convolver] Could not write partition cache " << cachePath << "\n";
+    return built;
+}
+
+void Convolver::prepare(float sampleRate, size_t maxBlockSize, size_t channels)
+{
+    const bool resampled = sampleRate != SampleRate;
+    Effect::prepare(sampleRate, maxBlockSize, channels);
+    // The IR (and its cached partitions) were made for the old rate
+    if (resampled && !loadedPath.empty())
+        load(loadedPath, loadedPartition);
+    reset();
+}
+
+void Convolver::reset()
+{
+    if (engine)
+        engine->reset();
+}
+
+float Convolver::process(float sample)
+{
+    processBlock(&sample, 1);
+    return sample;
+}
+
+void Convolver::processBlock(float *samples, size_t count)
+{
+    if (!IsActive)
+        return;
+    if (engines.update())
+        engine = engines.read().get();
+    if (!engine)
+        return;
+
+    if (mix == 1.0f && wetGain == 1.0f)
+    {
+        engine->process(samples, count);
+        return;
+    }
+
+    for (size_t done = 0; done < count; done += CHUNK)
+    {
+        const size_t n = std::min(CHUNK, count - done);
+        float *block = samples + done;
+        std::copy(block, block + n, dry);
+        engine->process(block, n);
+        for (size_t i = 0; i < n; ++i)
+            block[i] = dry[i] + mix * (wetGain * block[i] - dry[i]);
+    }
+}
+
+Convolver::~Convolver()
+{
+    std::cout << "[Convolver] Convolver destroyed cleanly\n";
+}
+
+void Convolver::parseConfig(const Config &config)
+{
+    IsActive = config.contains("convolver");
+    const std::string path = config.get<std::string>("convolver", "");
+    Setting = path;
+    mix = std::min(std::max(config.getNumber("convolver_mix", 1.0f), 0.0f), 1.0f);
+    wetGain = std::pow(10.0f, config.getNumber("convolver_gain", 0.0f) / 20.0f);
+    useCache = config.get<bool>("convolver_cache", true);
+
+    size_t partition = static_cast<size_t>(std::max(config.getNumber("convolver_partition", DEFAULT_PARTITION), 0.0f));
+    if (partition < MIN_PARTITION || partition > MAX_PARTITION || (partition & (partition - 1)) != 0)
+    {
+        std::cerr << "[Convolver] Unsupported partition size " << partition << ", using " << DEFAULT_PARTITION
+                  << "\n";
+        partition = DEFAULT_PARTITION;
+    }
+
+    // Rebuild only when the IR itself changes; level edits keep the tail ringing
+    if (!IsActive || path.empty() || (path == loadedPath && partition == loadedPartition))
+        return;
+    load(path, partition);
+}
+
+bool Convolver::load(const std::string &path, size_t partition)
+{
+    const auto start = std::chrono::steady_clock::now();
+    Engine built = buildEngine(path, partition);
+    if (!built)
+        return false; // Keep playing the previous IR
+
+    latest = built.get();
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "[Convolver] Loaded " << path << ": " << built->length() << " taps, " << built->tailPartitions()
+              << " partitions of " << partition << " in " << ms << " ms\n";
+
+    // The slot being overwritten holds an engine the audio thread has already let go of
+    engines.writeBuffer() = std::move(built);
+    engines.publish();
+    loadedPath = path;
+    loadedPartition = partition;
+    return true;
+}
+
+REGISTER_EFFECT_AUTO(Convolver);
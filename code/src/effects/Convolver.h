@@ -0,0 +1,86 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "Effect.h"
+#include "PartitionedConvolution.h"
+#include "TripleBuffer.h"
+
+/**
+ * @class Convolver
+ * @brief Cabinet/room simulation by convolution with an impulse response (IR) WAV.
+ *
+ * The IR is read with libsndfile, mixed down to mono and resampled to the
+ * rate the effect is prepared for (and again if that changes), then handed to a PartitionedConvolution: no added latency and
+ * roughly the same cost every period, whatever the IR length. Loading and
+ * transforming happen in configure(), on the config thread; the finished
+ * engine is published to the audio thread through a TripleBuffer, and the
+ * engine it replaces is freed by the config thread on a later publish. If an
+ * IR fails to load, the previous one keeps playing.
+ *
+ * The prepared partitions are saved in a PartitionCache beside the IR, so the
+ * next load (e.g. a preset switch, or the next start) only maps that file.
+ *
+ * Config: "convolver" (IR path), "convolver_partition" (partition size, a
+ * power of two from 32 to 1024), "convolver_mix" (wet level, 0..1),
+ * "convolver_gain" (wet gain in dB) and "convolver_cache" (false to always
+ * rebuild from the WAV).
+ */
+class Convolver : public Effect
+{
+public:
+    static constexpr const char *Name = "Convolver"; ///< Name in the effect registry
+    static constexpr size_t MAX_TAPS = 1 << 16;      ///< Longer IRs are truncated
+    static constexpr size_t CHUNK = 64;              ///< Samples per pass (dry copy for the mix)
+
+    Convolver();
+    float process(float sample) override;
+    void processBlock(float *samples, size_t count) override;
+    void prepare(float sampleRate, size_t maxBlockSize, size_t channels) override;
+    void reset() override;
+    ~Convolver();
+
+    /**
+     * @brief Reads a WAV IR as mono at sampleRate (resampled if the file's rate differs).
+     * @return false (with impulse untouched) if the file cannot be read.
+     */
+    static bool loadImpulse(const std::string &path, float sampleRate, std::vector<float> &impulse);
+
+    /**
+     * @brief The engine last built by configure() (nullptr if no IR has loaded).
+     */
+    const PartitionedConvolution *built() const { return latest; }
+
+protected:
+    void parseConfig(const Config &config) override;
+    const char *configKey() const override { return "convolver"; }
+
+private:
+    using Engine = std::unique_ptr<PartitionedConvolution>;
+
+    /**
+     * @brief Maps the cached partitions of an IR, or builds them (and the cache) from the WAV.
+     * @return nullptr if the IR cannot be read.
+     */
+    Engine buildEngine(const std::string &path, size_t partition) const;
+
+    /**
+     * @brief Builds the engine for an IR and publishes it to the audio thread.
+     * @return false (previous IR kept) if the IR cannot be read.
+     */
+    bool load(const std::string &path, size_t partition);
+
+    float mix = 1.0f;
+    float wetGain = 1.0f;
+    bool useCache = true;
+
+    // Config thread
+    std::string loadedPath;              ///< IR the latest engine was built from
+    size_t loadedPartition = 0;
+    const PartitionedConvolution *latest = nullptr;
+    TripleBuffer<Engine> engines;        ///< Hands new engines to the audio thread
+
+    // Audio thread state
+    PartitionedConvolution *engine = nullptr; ///< Adopted from engines
+    float dry[CHUNK] = {};
+};
@@ -0,0 +1,140 @@
+#include "Delay.h"
+#include "EffectRegistration.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+    constexpr float GLIDE_MS = 60.0f; ///< Time constant of a delay time change
+}
+
+Delay::Delay()
+{
+    IsActive = false;
+    Setting = timeMs;
+    prepare(DEFAULT_SAMPLE_RATE, MAX_BLOCK_SIZE, MAX_CHANNELS);
+}
+
+void Delay::prepare(float sampleRate, size_t maxBlockSize, size_t channels)
+{
+    Effect::prepare(sampleRate, maxBlockSize, channels);
+    // The only allocation: MAX_SECONDS, plus room for a chunk and the cubic's taps
+    line.allocate(static_cast<size_t>(MAX_SECONDS * SampleRate) + CHUNK + 4);
+    settingChanged();
+    reset();
+}
+
+void Delay::reset()
+{
+    line.clear();
+    currentDelay = targetDelay;
+    phase = 0.0f;
+    toneState = 0.0f;
+}
+
+void Delay::release()
+{
+    line.release();
+}
+
+float Delay::process(float sample)
+{
+    processBlock(&sample, 1);
+    return sample;
+}
+
+void Delay::processBlock(float *samples, size_t count)
+{
+    if (!IsActive)
+        return;
+
+    for (size_t done = 0; done < count; done += CHUNK)
+    {
+        const size_t n = std::min(CHUNK, count - done);
+        float *block = samples + done;
+
+        // Glide towards the target time; snap once the remaining distance is inaudible
+        const float start = currentDelay;
+        currentDelay += (targetDelay - currentDelay) * glideCoefficient;
+        if (std::abs(targetDelay - currentDelay) < 1e-3f)
+            currentDelay = targetDelay;
+
+        if (start == currentDelay && depth == 0.0f)
+        {
+            line.readFractional(wet, n, currentDelay);
+        }
+        else
+        {
+            // Per-sample read position: glide plus the LFO, both linear across the chunk, kept in range
+            const float lfoStart = depth * (1.0f + WavetableLFO::sine(phase));
+            phase += phaseStep * n;
+            phase -= std::floor(phase);
+            const float lfoEnd = depth * (1.0f + WavetableLFO::sine(phase));
+
+            const float minimum = static_cast<float>(n + 1);
+            const float maximum = static_cast<float>(line.capacity() - n - 4);
+            const float slope = (currentDelay + lfoEnd - start - lfoStart) / n;
+            for (size_t i = 0; i < n; ++i)
+                delays[i] = std::min(std::max(start + lfoStart + slope * (i + 1), minimum), maximum);
+            line.readModulated(wet, delays, n);
+        }
+
+        // Feed back through the tone filter. Only the one-pole recursion is serial,
+        // and it is a single multiply-add per sample; the rest vectorises.
+        const float pole = 1.0f - toneCoefficient;
+        for (size_t i = 0; i < n; ++i)
+            filtered[i] = feedback * toneCoefficient * wet[i];
+        for (size_t i = 0; i < n; ++i)
+            filtered[i] = toneState = pole * toneState + filtered[i];
+        for (size_t i = 0; i < n; ++i)
+        {
+            const float input = block[i];
+            filtered[i] += input;         // The line's input
+            block[i] = input + mix * wet[i];
+        }
+        line.write(filtered, n);
+    }
+}
+
+void Delay::settingChanged()
+{
+    try
+    {
+        timeMs = std::any_cast<float>(Setting);
+    }
+    catch (...)
+    {
+        timeMs = 350.0f; // Fallback time
+    }
+
+    // Shortest time keeps a whole chunk (and the cubic's taps) already in the line
+    const float longest = static_cast<float>(line.capacity() - CHUNK - 4);
+    depth = std::max(0.0f, depthMs) * 0.001f * SampleRate * 0.5f; // LFO spans 0..2 * depth
+    targetDelay = std::min(std::max(timeMs * 0.001f * SampleRate, static_cast<float>(CHUNK + 1)), longest - 2.0f * depth);
+    phaseStep = std::max(0.0f, rateHz) / SampleRate;
+    toneCoefficient = 1.0f - std::exp(-2.0f * static_cast<float>(M_PI) * std::min(toneHz, 0.45f * SampleRate) / SampleRate);
+    glideCoefficient = 1.0f - std::exp(-static_cast<float>(CHUNK) / (GLIDE_MS * 0.001f * SampleRate));
+}
+
+Delay::~Delay()
+{
+    std::cout << "[Delay] Delay destroyed cleanly\n";
+}
+
+void Delay::parseConfig(const Config &config)
+{
+    // Parameters only: the line keeps its contents so echoes ring on through edits
+    IsActive = config.contains("delay");
+    Setting = config.getNumber("delay", 350.0f);
+    feedback = std::min(std::max(config.getNumber("delay_feedback", 0.35f), 0.0f), 0.95f);
+    mix = std::max(config.getNumber("delay_mix", 0.35f), 0.0f);
+    toneHz = config.getNumber("delay_tone", 4000.0f);
+    rateHz = config.getNumber("delay_rate", 0.0f);
+    depthMs = config.getNumber("delay_depth", 0.0f);
+    settingChanged();
+    if (line.written() == 0)
+        currentDelay = targetDelay; // Nothing played yet: nothing to glide from
+}
+
+REGISTER_EFFECT_AUTO(Delay);
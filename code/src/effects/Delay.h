@@ -0,0 +1,69 @@
+#pragma once
+#include "DelayLine.h"
+#include "Effect.h"
+#include "WavetableLFO.h"
+
+/**
+ * @class Delay
+ * @brief Echo with feedback, a tone filter in the feedback path and optional modulation.
+ *
+ * Up to MAX_SECONDS of history is allocated once, by prepare();
+ * changing the delay time (e.g. from the encoder) only moves the read
+ * position, which glides to the new time like a tape head. At a steady,
+ * unmodulated time each CHUNK is read as two contiguous spans and
+ * interpolated with a vectorised cubic; while gliding or modulated the read
+ * position is computed per sample.
+ *
+ * Config: "delay" (time in ms), "delay_feedback" (0..0.95), "delay_mix" (wet
+ * level), "delay_tone" (feedback low-pass in Hz), "delay_rate" (modulation Hz)
+ * and "delay_depth" (modulation ms).
+ */
+class Delay : public Effect
+{
+public:
+    static constexpr const char *Name = "Delay"; ///< Name in the effect registry
+    static constexpr float MAX_SECONDS = 2.0f;   ///< Longest delay time
+    static constexpr size_t CHUNK = 32;          ///< Samples per pass; also the shortest delay
+
+    Delay();
+    float process(float sample) override;
+    void processBlock(float *samples, size_t count) override;
+    void prepare(float sampleRate, size_t maxBlockSize, size_t channels) override;
+    void reset() override;
+    void release() override;
+    ~Delay();
+
+    /**
+     * @brief Samples of history allocated (a power of two).
+     */
+    size_t capacity() const { return line.capacity(); }
+
+protected:
+    void parseConfig(const Config &config) override;
+    const char *configKey() const override { return "delay"; }
+    void settingChanged() override;
+
+private:
+    float timeMs = 350.0f;         ///< Setting
+    float feedback = 0.35f;
+    float mix = 0.35f;
+    float toneHz = 4000.0f;
+    float rateHz = 0.0f;
+    float depthMs = 0.0f;
+
+    // Derived in settingChanged(), off the audio path
+    float targetDelay = 0.0f;      ///< Delay time in samples
+    float depth = 0.0f;            ///< Modulation depth in samples
+    float phaseStep = 0.0f;        ///< Modulation phase advance per sample (cycles)
+    float toneCoefficient = 0.0f;  ///< One-pole low-pass coefficient
+    float glideCoefficient = 0.0f; ///< Fraction of the remaining glide covered per chunk
+
+    // Audio thread state
+    DelayLine line;
+    float currentDelay = 0.0f;     ///< Delay time being played, gliding to targetDelay
+    float phase = 0.0f;            ///< Modulation phase (cycles)
+    float toneState = 0.0f;        ///< Tone filter output, scaled by the feedback
+    float wet[CHUNK] = {};
+    float filtered[CHUNK] = {};
+    float delays[CHUNK] = {};
+};
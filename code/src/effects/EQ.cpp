@@ -0,0 +1,273 @@
+#include "EQ.h"
+#include "EffectRegistration.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+    constexpr size_t LANES = EQ::MAX_SECTIONS;
+
+    // One lane per section: a single SIMD register on x86 (AVX), two NEON registers on the Pi
+    typedef float Lanes __attribute__((vector_size(LANES * sizeof(float))));
+    typedef int32_t LaneMask __attribute__((vector_size(LANES * sizeof(int32_t))));
+
+    struct Taps
+    {
+        Lanes b0, b1, b2, a1, a2;
+    };
+
+    Lanes load(const float *from)
+    {
+        Lanes v;
+        std::memcpy(&v, from, sizeof(v));
+        return v;
+    }
+
+    /**
+     * @brief Advances every section by one sample: lane s filters sample t - s, fed by lane
+     *        s - 1's previous output. Lanes outside `active` (filling or draining) keep their state.
+     * @return The new section outputs.
+     */
+    template <bool Masked>
+    inline Lanes step(const Taps &c, Lanes y, Lanes &z1, Lanes &z2, float input, LaneMask active)
+    {
+#if defined(__clang__)
+        const Lanes shifted = __builtin_shufflevector(y, y, 0, 0, 1, 2, 3, 4, 5, 6);
+#else
+        const Lanes shifted = __builtin_shuffle(y, LaneMask{0, 0, 1, 2, 3, 4, 5, 6});
+#endif
+        const LaneMask first = {-1, 0, 0, 0, 0, 0, 0, 0};
+        const Lanes x = first ? Lanes{} + input : shifted; // A blend, not a lane insert
+
+        // Only one multiply-add per recursion sits on the sample-to-sample path
+        const Lanes out = c.b0 * x + z1;
+        const Lanes feed1 = c.b1 * x + z2;
+        const Lanes feed2 = c.b2 * x;
+        const Lanes next1 = feed1 - c.a1 * out;
+        const Lanes next2 = feed2 - c.a2 * out;
+        if (!Masked)
+        {
+            z1 = next1;
+            z2 = next2;
+            return out;
+        }
+        z1 = active ? next1 : z1;
+        z2 = active ? next2 : z2;
+        return active ? out : y;
+    }
+
+    /**
+     * @brief Lanes with a sample of this block at step t: s <= t < s + count.
+     */
+    LaneMask activeAt(size_t t, size_t count)
+    {
+        const LaneMask lane = {0, 1, 2, 3, 4, 5, 6, 7};
+        const LaneMask step = LaneMask{} + static_cast<int32_t>(t);
+        return (lane <= step) & (step - lane < static_cast<int32_t>(count));
+    }
+}
+
+EQ::EQ()
+{
+    IsActive = false;
+    Setting = levelDb;
+    publish();
+}
+
+void EQ::prepare(float sampleRate, size_t maxBlockSize, size_t channels)
+{
+    Effect::prepare(sampleRate, maxBlockSize, channels);
+    publish();
+    reset();
+}
+
+void EQ::reset()
+{
+    std::fill(std::begin(z1), std::end(z1), 0.0f);
+    std::fill(std::begin(z2), std::end(z2), 0.0f);
+}
+
+bool EQ::parseBand(const std::string &name, EQBand &type)
+{
+    if (name == "peak")
+        type = EQBand::Peak;
+    else if (name == "lowshelf")
+        type = EQBand::LowShelf;
+    else if (name == "highshelf")
+        type = EQBand::HighShelf;
+    else if (name == "highpass")
+        type = EQBand::HighPass;
+    else if (name == "lowpass")
+        type = EQBand::LowPass;
+    else
+        return false;
+    return true;
+}
+
+void EQ::design(Coefficients &c, size_t section, EQBand type, float hz, float db, float q, float sampleRate)
+{
+    // RBJ audio EQ cookbook, in double and normalised by a0
+    const double w = 2.0 * M_PI * std::min(std::max(static_cast<double>(hz), 10.0), 0.49 * sampleRate) / sampleRate;
+    const double cosw = std::cos(w);
+    const double alpha = std::sin(w) / (2.0 * std::max(static_cast<double>(q), 0.05));
+    const double A = std::pow(10.0, db / 40.0);
+    const double root = 2.0 * std::sqrt(A) * alpha;
+
+    double b0 = 1, b1 = 0, b2 = 0, a0 = 1, a1 = 0, a2 = 0;
+    switch (type)
+    {
+    case EQBand::Peak:
+        b0 = 1 + alpha * A, b1 = -2 * cosw, b2 = 1 - alpha * A;
+        a0 = 1 + alpha / A, a1 = -2 * cosw, a2 = 1 - alpha / A;
+        break;
+    case EQBand::LowShelf:
+        b0 = A * ((A + 1) - (A - 1) * cosw + root), b1 = 2 * A * ((A - 1) - (A + 1) * cosw);
+        b2 = A * ((A + 1) - (A - 1) * cosw - root);
+        a0 = (A + 1) + (A - 1) * cosw + root, a1 = -2 * ((A - 1) + (A + 1) * cosw);
+        a2 = (A + 1) + (A - 1) * cosw - root;
+        break;
+    case EQBand::HighShelf:
+        b0 = A * ((A + 1) + (A - 1) * cosw + root), b1 = -2 * A * ((A - 1) + (A + 1) * cosw);
+        b2 = A * ((A + 1) + (A - 1) * cosw - root);
+        a0 = (A + 1) - (A - 1) * cosw + root, a1 = 2 * ((A - 1) - (A + 1) * cosw);
+        a2 = (A + 1) - (A - 1) * cosw - root;
+        break;
+    case EQBand::HighPass:
+        b0 = (1 + cosw) / 2, b1 = -(1 + cosw), b2 = (1 + cosw) / 2;
+        a0 = 1 + alpha, a1 = -2 * cosw, a2 = 1 - alpha;
+        break;
+    case EQBand::LowPass:
+        b0 = (1 - cosw) / 2, b1 = 1 - cosw, b2 = (1 - cosw) / 2;
+        a0 = 1 + alpha, a1 = -2 * cosw, a2 = 1 - alpha;
+        break;
+    }
+
+    c.b0[section] = static_cast<float>(b0 / a0);
+    c.b1[section] = static_cast<float>(b1 / a0);
+    c.b2[section] = static_cast<float>(b2 / a0);
+    c.a1[section] = static_cast<float>(a1 / a0);
+    c.a2[section] = static_cast<float>(a2 / a0);
+}
+
+float EQ::process(float sample)
+{
+    processBlock(&sample, 1);
+    return sample;
+}
+
+void EQ::processBlock(float *samples, size_t count)
+{
+    if (!IsActive)
+        return;
+
+    coefficients.update();
+    const Coefficients &c = coefficients.read();
+    const size_t k = c.sections;
+    if (k == 0)
+    {
+        for (size_t i = 0; i < count; ++i)
+            samples[i] *= c.gain;
+        return;
+    }
+
+    // Section k - 1 delivers sample t - (k - 1) at step t. Steps before k - 1 fill the
+    // pipeline and steps from `count` drain it; only those need masking.
+    const Taps taps{load(c.b0), load(c.b1), load(c.b2), load(c.a1), load(c.a2)};
+    Lanes y = {};
+    Lanes s1 = load(z1), s2 = load(z2);
+
+    const size_t last = k - 1;
+    const size_t steps = count + last;
+    const size_t fill = std::min(last, count);
+    size_t t = 0;
+    for (; t < fill; ++t)
+        y = step<true>(taps, y, s1, s2, samples[t], activeAt(t, count));
+    for (; t < count; ++t)
+    {
+        y = step<false>(taps, y, s1, s2, samples[t], LaneMask{});
+        samples[t - last] = c.gain * y[last];
+    }
+    for (; t < steps; ++t)
+    {
+        y = step<true>(taps, y, s1, s2, 0.0f, activeAt(t, count));
+        if (t >= last)
+            samples[t - last] = c.gain * y[last];
+    }
+
+    std::memcpy(z1, &s1, sizeof(s1));
+    std::memcpy(z2, &s2, sizeof(s2));
+}
+
+EQ::~EQ()
+{
+    std::cout << "[EQ] EQ destroyed cleanly\n";
+}
+
+void EQ::publish()
+{
+    Coefficients &c = coefficients.writeBuffer();
+    for (size_t s = 0; s < LANES; ++s)
+    {
+        c.b0[s] = 1.0f;
+        c.b1[s] = c.b2[s] = c.a1[s] = c.a2[s] = 0.0f;
+    }
+    for (size_t s = 0; s < bandCount; ++s)
+        design(c, s, bands[s].type, bands[s].hz, bands[s].db, bands[s].q, SampleRate);
+    c.sections = bandCount;
+    c.gain = std::pow(10.0f, levelDb / 20.0f);
+    coefficients.publish();
+    published = bandCount;
+}
+
+void EQ::settingChanged()
+{
+    try
+    {
+        levelDb = std::any_cast<float>(Setting);
+    }
+    catch (...)
+    {
+        levelDb = 0.0f; // Fallback level
+    }
+    publish();
+}
+
+void EQ::parseConfig(const Config &config)
+{
+    IsActive = config.contains("eq");
+    Setting = config.getNumber("eq", 0.0f);
+
+    // Bands keep their order; disabled or malformed ones are skipped
+    bandCount = 0;
+    for (size_t i = 1; i <= MAX_SECTIONS; ++i)
+    {
+        const std::string key = "eq_" + std::to_string(i);
+        if (!config.contains(key))
+            continue;
+
+        const std::string spec = config.get<std::string>(key, "");
+        std::istringstream in(spec);
+        std::string name;
+        Band band{EQBand::Peak, 0.0f, 0.0f, 0.707f};
+        if (!(in >> name >> band.hz) || !parseBand(name, band.type))
+        {
+            std::cerr << "[EQ] Ignoring " << key << ": expected \"<type> <Hz> [<dB> [<Q>]]\", got \"" << spec
+                      << "\"\n";
+            continue;
+        }
+        float db, q;
+        if (in >> db)
+        {
+            band.db = db;
+            if (in >> q)
+                band.q = q;
+        }
+        bands[bandCount++] = band;
+    }
+    settingChanged();
+}
+
+REGISTER_EFFECT_AUTO(EQ);
@@ -0,0 +1,108 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "Effect.h"
+#include "TripleBuffer.h"
+
+/**
+ * @brief Response of one EQ band.
+ */
+enum class EQBand : uint8_t
+{
+    Peak,      ///< Bell boost/cut around the frequency
+    LowShelf,  ///< Boost/cut below the frequency
+    HighShelf, ///< Boost/cut above the frequency
+    HighPass,  ///< 12 dB/octave high-pass
+    LowPass,   ///< 12 dB/octave low-pass
+};
+
+/**
+ * @class EQ
+ * @brief Parametric equaliser: a cascade of up to MAX_SECTIONS biquads.
+ *
+ * Each band is a biquad in transposed direct form II (RBJ cookbook designs).
+ * The cascade is evaluated with SIMD across sections as a one-sample
+ * pipeline: lane s holds section s, and at step t it filters sample t - s,
+ * taking its input from lane s - 1's output of the previous step. One step
+ * advances every section at once with a handful of vector multiply-adds. Each
+ * block fills and drains the pipeline (inactive lanes keep their state), so
+ * the EQ adds no latency.
+ *
+ * Coefficients are computed where the config is parsed, never on the audio
+ * thread, and published as one set through a TripleBuffer; the audio thread
+ * adopts a new set at the start of a block.
+ *
+ * Config: "eq" (output level in dB) and "eq_1" .. "eq_8", one band each:
+ * "<type> <Hz> [<dB> [<Q>]]" with type peak, lowshelf, highshelf, highpass
+ * or lowpass, e.g. "eq_1, true, peak 800 -4.0 1.2".
+ */
+class EQ : public Effect
+{
+public:
+    static constexpr const char *Name = "EQ"; ///< Name in the effect registry
+    static constexpr size_t MAX_SECTIONS = 8;  ///< Bands; also the SIMD width of the pipeline
+
+    /**
+     * @brief One published coefficient set, laid out one lane per section.
+     *        Lanes past `sections` are identity filters.
+     */
+    struct Coefficients
+    {
+        alignas(32) float b0[MAX_SECTIONS];
+        alignas(32) float b1[MAX_SECTIONS];
+        alignas(32) float b2[MAX_SECTIONS];
+        alignas(32) float a1[MAX_SECTIONS];
+        alignas(32) float a2[MAX_SECTIONS];
+        size_t sections = 0;
+        float gain = 1.0f; ///< Output level
+    };
+
+    EQ();
+    float process(float sample) override;
+    void processBlock(float *samples, size_t count) override;
+    void prepare(float sampleRate, size_t maxBlockSize, size_t channels) override;
+    void reset() override;
+    ~EQ();
+
+    /**
+     * @brief Sets lane `section` of `c` to a band designed at `sampleRate`.
+     */
+    static void design(Coefficients &c, size_t section, EQBand type, float hz, float db, float q, float sampleRate);
+
+    /**
+     * @brief Parses a band type name; false if it is not one.
+     */
+    static bool parseBand(const std::string &name, EQBand &type);
+
+    /**
+     * @brief Number of bands in the last published set.
+     */
+    size_t sectionCount() const { return published; }
+
+protected:
+    void parseConfig(const Config &config) override;
+    const char *configKey() const override { return "eq"; }
+    void settingChanged() override;
+
+private:
+    /**
+     * @brief Designs every band and the output level, then publishes them.
+     */
+    void publish();
+
+    struct Band
+    {
+        EQBand type;
+        float hz, db, q;
+    };
+
+    float levelDb = 0.0f;           ///< Setting
+    Band bands[MAX_SECTIONS] = {};
+    size_t bandCount = 0;
+    size_t published = 0;
+    TripleBuffer<Coefficients> coefficients;
+
+    // Audio thread state (transposed direct form II)
+    alignas(32) float z1[MAX_SECTIONS] = {};
+    alignas(32) float z2[MAX_SECTIONS] = {};
+};
@@ -2,9 +2,29 @@
 #define EFFECT_H
 
 #include <any>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <string>
 #include "Config.h"
 
+constexpr size_t MAX_CHANNELS = 2;           ///< Most channels a signal carries through the chain
+constexpr size_t MAX_BLOCK_SIZE = 256;       ///< Frames processed per pass; longer blocks are split
+constexpr float DEFAULT_SAMPLE_RATE = 44100.0f; ///< Rate effects are built for, until prepared for another
+
+/**
+ * @brief How an effect handles the channels of the signal reaching it.
+ *
+ * Buffers are planar: one contiguous plane of frames per channel. The chain
+ * adapts the signal to the layout before calling processChannels().
+ */
+enum class ChannelLayout : uint8_t
+{
+    Mono,   ///< One channel in and out; a multichannel signal is folded to mono first
+    Any,    ///< Processes however many channels reach it (e.g. a linked limiter)
+    Stereo, ///< Two channels out; a mono signal is copied to both first (e.g. panned voices)
+};
+
 /**
  * @class Effect
  * @brief Abstract base class for all audio effects.
@@ -12,6 +32,11 @@
  * This interface defines the contract for DSP effects used in the signal chain.
  * Each concrete effect must implement the `process()` method, which modifies
  * a sample according to its internal state (setting and activation flag).
+ *
+ * Effects are built ready for DEFAULT_SAMPLE_RATE, MAX_BLOCK_SIZE frames and
+ * MAX_CHANNELS channels. prepare() sizes them for the actual stream, off the
+ * audio thread, and is the only place an effect allocates audio buffers;
+ * reset() clears their contents and release() gives them back.
  */
 class Effect
 {
@@ -25,13 +50,101 @@ public:
      */
     virtual float process(float sample) = 0;
 
+    /**
+     * @brief Processes a block of samples in place.
+     *        The default calls process() per sample; effects can override it to
+     *        avoid the per-sample virtual call.
+     * @param samples The samples to process.
+     * @param count Number of samples.
+     */
+    virtual void processBlock(float *samples, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            samples[i] = process(samples[i]);
+    }
+
+    /**
+     * @brief Channel handling the chain arranges for (see ChannelLayout). Mono unless overridden.
+     */
+    virtual ChannelLayout channelLayout() const
+    {
+        return ChannelLayout::Mono;
+    }
+
+    /**
+     * @brief Processes planar channels in place, as arranged for by channelLayout().
+     *        The default processes the first plane with processBlock(), which is all
+     *        a Mono effect is given.
+     * @param channels One plane of `frames` samples per channel.
+     * @param channelCount Number of planes (MAX_CHANNELS at most).
+     * @param frames Samples per plane.
+     */
+    virtual void processChannels(float *const *channels, size_t channelCount, size_t frames)
+    {
+        (void)channelCount;
+        processBlock(channels[0], frames);
+    }
+
+    /**
+     * @brief Sizes the effect for a stream and re-derives everything that depends on its rate.
+     *        Called by DigitalSignalChain off the audio thread (with the audio thread kept
+     *        out of the chain), whenever the stream format changes. Overrides allocate
+     *        here and call Effect::prepare() first. Signal state is cleared.
+     * @param sampleRate Sample rate in Hz.
+     * @param maxBlockSize Most frames a single call will process.
+     * @param channels Most channels processChannels() will be given.
+     */
+    virtual void prepare(float sampleRate, size_t maxBlockSize, size_t channels)
+    {
+        SampleRate = sampleRate;
+        MaxBlockSize = maxBlockSize;
+        Channels = channels;
+    }
+
+    /**
+     * @brief Clears signal state (delay lines, envelopes, filter history) without allocating,
+     *        so the effect continues as if it had just been prepared. Not for the audio thread
+     *        while it is processing the effect.
+     */
+    virtual void reset() {}
+
+    /**
+     * @brief Frees what prepare() allocated; the effect must be prepared again before it runs.
+     */
+    virtual void release() {}
+
+    /**
+     * @brief Sample rate the effect was last prepared for.
+     */
+    float sampleRate() const
+    {
+        return SampleRate;
+    }
+
+    /**
+     * @brief Delay the effect adds to the signal, in samples (e.g. lookahead or filter delay).
+     */
+    virtual size_t latency() const
+    {
+        return 0;
+    }
+
     /**
      * @brief Configures the effect from global configuration.
      *        Will be called once during initialisation or when config is updated.
+     *        The effect is only re-parsed if its key (or a "key_*" sub-key) changed
+     *        since the last call, so untouched effects keep their running state.
+     *        Composite effects (e.g. a StaticChain) override it to configure their stages.
+     * @return true if the effect was reconfigured.
      */
-    void configure(const Config &config)
+    virtual bool configure(const Config &config)
     {
+        const uint64_t revision = config.revision(configKey());
+        if (revision == configRevision)
+            return false;
+        configRevision = revision;
         parseConfig(config);
+        return true;
     }
 
     /**
@@ -50,6 +163,18 @@ public:
         return IsActive;
     }
 
+    /**
+     * @brief Points the effect at the chain's unprocessed input for the block it is about to process.
+     *        Set by DigitalSignalChain before each processBlock(); effects keyed from the
+     *        dry signal (e.g. a NoiseGate sidechain) read it, the rest ignore it.
+     *        A multichannel input is given folded to mono.
+     * @param key Same number of frames as the block, or nullptr outside a chain.
+     */
+    void setSidechain(const float *key)
+    {
+        Sidechain = key;
+    }
+
     /**
      * @brief Sets the internal configuration value for the effect.
      * @param value The new configuration value as std::any.
@@ -57,6 +182,7 @@ public:
     void setSetting(const std::any &value)
     {
         Setting = value;
+        settingChanged();
     }
 
 protected:
@@ -65,8 +191,25 @@ protected:
      */
     virtual void parseConfig(const Config &config) = 0;
 
+    /**
+     * @brief The config.cfg key this effect reads (e.g. "gain").
+     */
+    virtual const char *configKey() const = 0;
+
+    /**
+     * @brief Called after setSetting() so effects can refresh values cached from Setting.
+     */
+    virtual void settingChanged() {}
+
     bool IsActive = true; ///< Whether the effect should be applied.
     std::any Setting;     ///< Stored parameter value (e.g. gain, pitch, threshold).
+    const float *Sidechain = nullptr; ///< Chain input for the current block (see setSidechain()).
+    float SampleRate = DEFAULT_SAMPLE_RATE; ///< Stream format last given to prepare()
+    size_t MaxBlockSize = MAX_BLOCK_SIZE;
+    size_t Channels = MAX_CHANNELS;
+
+private:
+    uint64_t configRevision = std::numeric_limits<uint64_t>::max(); ///< Revision last parsed (max = never)
 };
 
 #endif // EFFECT_H
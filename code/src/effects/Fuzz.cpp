@@ -11,27 +11,26 @@ Fuzz::Fuzz()
 
 float Fuzz::process(float sample)
 {
-    if (!IsActive)
-    {
-        return sample;
-    }
+    processBlock(&sample, 1);
+    return sample;
+}
 
-    float threshold = 0.01f;
+void Fuzz::processBlock(float *samples, size_t count)
+{
+    oversampler.select(oversampleFactor(), quality);
+    oversampler.process(samples, count, kernel());
+}
+
+void Fuzz::settingChanged()
+{
     try
     {
-        //std::cout << "[Fuzz] Applying Fuzz\n";
-        threshold *= std::any_cast<float>(Setting);
+        threshold = 0.01f * std::any_cast<float>(Setting);
     }
     catch (...)
     {
         threshold = 1.0f; // Fallback threshold
     }
-
-    if (sample > threshold)
-        return threshold;
-    if (sample < -threshold)
-        return -threshold;
-    return sample;
 }
 
 Fuzz::~Fuzz()
@@ -43,6 +42,19 @@ void Fuzz::parseConfig(const Config &config)
 {
     IsActive = config.contains("fuzz");
     Setting = config.get<float>("fuzz", 1.0f);
+    settingChanged();
+
+    const int requested = config.contains("fuzz_oversample") ? config.get<int>("fuzz_oversample", 1) : 1;
+    if (requested < 1 || !Oversampler::isSupported(static_cast<size_t>(requested)))
+    {
+        std::cerr << "[Fuzz] Unsupported oversampling factor " << requested << ", using 1\n";
+        factor = 1;
+    }
+    else
+    {
+        factor = static_cast<size_t>(requested);
+    }
+    quality = Oversampler::parseQuality(config.get<std::string>("fuzz_quality", "medium"));
 }
 
 REGISTER_EFFECT_AUTO(Fuzz);
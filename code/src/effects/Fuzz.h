@@ -1,12 +1,54 @@
 #pragma once
+#include <algorithm>
+#include <limits>
 #include "Effect.h"
+#include "Oversampler.h"
 
+/**
+ * @class Fuzz
+ * @brief Hard clipper. Can run oversampled ("fuzz_oversample" 2/4/8 and
+ *        "fuzz_quality" low/medium/high) to keep high-drive aliasing down.
+ */
 class Fuzz : public Effect {
 public:
+    static constexpr const char *Name = "Fuzz"; ///< Name in the effect registry
+
+    /**
+     * @brief Branch-free per-sample kernel (hard clip), inlined by StaticChain.
+     */
+    struct Kernel
+    {
+        float threshold; ///< +infinity when the effect is inactive
+
+        float operator()(float sample) const { return std::min(std::max(sample, -threshold), threshold); }
+    };
+
     Fuzz();
     float process(float sample) override;
+    void processBlock(float *samples, size_t count) override;
+    size_t latency() const override { return oversampler.latency(); }
+    void reset() override { oversampler.reset(); }
     ~Fuzz();
 
+    /**
+     * @brief Kernel for the current setting (identity when inactive).
+     */
+    Kernel kernel() const { return {IsActive ? threshold : std::numeric_limits<float>::infinity()}; }
+
+    /**
+     * @brief Oversampling the kernel should run at (also honoured by StaticChain).
+     */
+    size_t oversampleFactor() const { return IsActive ? factor : 1; }
+    OversampleQuality oversampleQuality() const { return quality; }
+
 protected:
     void parseConfig(const Config &config) override;
-};
\ No newline at end of file
+    const char *configKey() const override { return "fuzz"; }
+    void settingChanged() override;
+
+private:
+    float threshold = 0.03f; ///< Clip level (Setting / 100), cached off the audio path
+    size_t factor = 1;       ///< Oversampling factor (1 = off)
+    OversampleQuality quality = OversampleQuality::Medium;
+    Oversampler oversampler;
+};
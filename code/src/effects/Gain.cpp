@@ -11,22 +11,32 @@ Gain::Gain()
 
 float Gain::process(float sample)
 {
-    if (!IsActive){
-        //std::cout << "[Gain] Skipping process()\n";
-        return sample;
-    }
-        
+    return kernel()(sample);
+}
+
+void Gain::processBlock(float *samples, size_t count)
+{
+    const Kernel apply = kernel();
+    for (size_t i = 0; i < count; ++i)
+        samples[i] = apply(samples[i]);
+}
 
+void Gain::processChannels(float *const *channels, size_t channelCount, size_t frames)
+{
+    for (size_t c = 0; c < channelCount; ++c)
+        processBlock(channels[c], frames);
+}
+
+void Gain::settingChanged()
+{
     try
     {
-        //std::cout << "[Gain] Applying Gain\n";
-        float gain = std::any_cast<float>(Setting);
-        return sample * (0.01f * gain);
+        factor = 0.01f * std::any_cast<float>(Setting);
     }
     catch (const std::bad_any_cast &)
     {
         //std::cerr << "[Gain] Invalid setting type\n";
-        return sample;
+        factor = 1.0f;
     }
 }
 
@@ -37,6 +47,7 @@ void Gain::parseConfig(const Config &config)
     //std::cout << "[Gain] IsActive: ";
     //std::cout << IsActive;
     Setting = config.get<float>("gain", 100.0f); // Default to 100% gain
+    settingChanged();
 
 }
 
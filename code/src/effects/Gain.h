@@ -8,10 +8,35 @@
 class Gain : public Effect
 {
 public:
+    static constexpr const char *Name = "Gain"; ///< Name in the effect registry
+
+    /**
+     * @brief Branch-free per-sample kernel, inlined by StaticChain.
+     */
+    struct Kernel
+    {
+        float factor; ///< 1.0 when the effect is inactive
+
+        float operator()(float sample) const { return sample * factor; }
+    };
+
     Gain();
     float process(float sample) override;
+    void processBlock(float *samples, size_t count) override;
+    ChannelLayout channelLayout() const override { return ChannelLayout::Any; }
+    void processChannels(float *const *channels, size_t channelCount, size_t frames) override;
     ~Gain();
 
+    /**
+     * @brief Kernel for the current setting (identity when inactive).
+     */
+    Kernel kernel() const { return {IsActive ? factor : 1.0f}; }
+
 protected:
     void parseConfig(const Config &config) override;
+    const char *configKey() const override { return "gain"; }
+    void settingChanged() override;
+
+private:
+    float factor = 1.0f; ///< Setting as a multiplier, cached off the audio path
 };
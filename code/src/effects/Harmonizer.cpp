@@ -5,13 +5,74 @@
 #include <cmath>
 #include <filesystem>
 #include <algorithm>
+#include <cctype>
+#include <cstdlib>
 
 Harmonizer::Harmonizer(const std::string &inputWav, const std::string &outputWav, const std::vector<int> &semitones)
-    : inputWav("assets/" + inputWav),
+    : detector(DEFAULT_SAMPLE_RATE, 2), // Half rate: guitar fundamentals stay far below Nyquist
+      inputWav("assets/" + inputWav),
       outputWav("assets/" + outputWav),
       semitones(semitones)
 {
     IsActive = false;
+    publishIntervals(semitones);
+    prepare(DEFAULT_SAMPLE_RATE, MAX_BLOCK_SIZE, MAX_CHANNELS);
+}
+
+bool Harmonizer::parseKey(const std::string &text, HarmonyKey &key)
+{
+    static const int naturals[] = {9, 11, 0, 2, 4, 5, 7}; // A .. G
+    static const std::pair<const char *, std::array<int, 7>> scales[] = {
+        {"major", {{0, 2, 4, 5, 7, 9, 11}}},      {"ionian", {{0, 2, 4, 5, 7, 9, 11}}},
+        {"dorian", {{0, 2, 3, 5, 7, 9, 10}}},     {"phrygian", {{0, 1, 3, 5, 7, 8, 10}}},
+        {"lydian", {{0, 2, 4, 6, 7, 9, 11}}},     {"mixolydian", {{0, 2, 4, 5, 7, 9, 10}}},
+        {"minor", {{0, 2, 3, 5, 7, 8, 10}}},      {"aeolian", {{0, 2, 3, 5, 7, 8, 10}}},
+        {"locrian", {{0, 1, 3, 5, 6, 8, 10}}},    {"harmonic minor", {{0, 2, 3, 5, 7, 8, 11}}},
+    };
+
+    size_t i = text.find_first_not_of(' ');
+    if (i == std::string::npos)
+        return false;
+    const char letter = static_cast<char>(std::toupper(static_cast<unsigned char>(text[i])));
+    if (letter < 'A' || letter > 'G')
+        return false;
+    int tonic = naturals[letter - 'A'];
+    ++i;
+    if (i < text.size() && (text[i] == '#' || text[i] == 'b'))
+        tonic += text[i++] == '#' ? 1 : -1;
+
+    std::string scale = text.substr(std::min(text.size(), text.find_first_not_of(' ', i)));
+    while (!scale.empty() && scale.back() == ' ')
+        scale.pop_back();
+    std::transform(scale.begin(), scale.end(), scale.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (scale.empty())
+        scale = "major";
+
+    for (const auto &entry : scales)
+    {
+        if (scale == entry.first)
+        {
+            key.enabled = true;
+            key.tonic = (tonic + 12) % 12;
+            key.scale = entry.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+int Harmonizer::diatonicShift(const HarmonyKey &key, int note, int steps)
+{
+    // Degree of the note (or of the scale note below it)
+    const int pitch = ((note - key.tonic) % 12 + 12) % 12;
+    int degree = 6;
+    while (key.scale[degree] > pitch)
+        --degree;
+
+    const int target = degree + steps;
+    const int octave = target >= 0 ? target / 7 : -((6 - target) / 7);
+    return key.scale[target - 7 * octave] + 12 * octave - pitch;
 }
 
 void Harmonizer::updateInputs(const std::string &in, const std::string &out, const std::vector<int> &newSemitones)
@@ -19,76 +80,213 @@ void Harmonizer::updateInputs(const std::string &in, const std::string &out, con
     inputWav = in;
     outputWav = out;
     semitones = newSemitones;
+    publishIntervals(semitones);
 }
 
-void Harmonizer::initRealtimeStretch()
+void Harmonizer::prepare(float sampleRate, size_t maxBlockSize, size_t channels)
 {
-    if (stretchInitialized) return;
+    const bool rebuild = !stretchInitialized || sampleRate != SampleRate;
+    if (sampleRate != SampleRate)
+        detector = PitchDetector(sampleRate, 2);
+    Effect::prepare(sampleRate, maxBlockSize, channels);
+    if (!rebuild)
+    {
+        reset();
+        return;
+    }
 
-    stretches.resize(semitones.size());
-    outputBuffers.resize(semitones.size());
-    for (size_t i = 0; i < semitones.size(); ++i)
+    // Every voice exists from here on; the intervals only choose how many run
+    stretches.clear();
+    outputBuffers.clear();
+    stretches.resize(maxVoices);
+    outputBuffers.resize(maxVoices);
+    for (size_t i = 0; i < maxVoices; ++i)
     {
-        stretches[i].presetDefault(1, sampleRate);
+        stretches[i].presetDefault(1, SampleRate);
         outputBuffers[i].assign(blockSize, 0.0f);
     }
 
-    inputBuffer.resize(blockSize);
+    inputBuffer.assign(blockSize, 0.0f);
+    stretchInitialized = true;
+    reset();
+}
+
+void Harmonizer::reset()
+{
+    for (auto &voice : stretches)
+        voice.reset();
+    for (auto &buffer : outputBuffers)
+        std::fill(buffer.begin(), buffer.end(), 0.0f);
     inputWriteIndex = 0;
     outputReadIndex = blockSize;
-    stretchInitialized = true;
+    heldNote = -1;
+}
+
+void Harmonizer::release()
+{
+    std::vector<signalsmith::stretch::SignalsmithStretch<float>>().swap(stretches);
+    std::vector<std::vector<float>>().swap(outputBuffers);
+    std::vector<float>().swap(inputBuffer);
+    stretchInitialized = false;
+}
+
+void Harmonizer::publishIntervals(const std::vector<int> &values)
+{
+    Intervals &next = intervalSets.writeBuffer();
+    next.count = std::min(values.size(), maxVoices);
+    std::copy(values.begin(), values.begin() + next.count, next.values.begin());
+    intervalSets.publish();
+}
+
+const Harmonizer::Intervals &Harmonizer::adoptIntervals()
+{
+    intervalSets.update();
+    const Intervals &current = intervalSets.read();
+
+    // Voices joining the chord start from silence, not from whatever they held when last used
+    for (size_t i = activeVoices; i < current.count; ++i)
+    {
+        stretches[i].reset();
+        std::fill(outputBuffers[i].begin(), outputBuffers[i].end(), 0.0f);
+    }
+    activeVoices = current.count;
+    return current;
 }
 
 float Harmonizer::process(float sample)
 {
-    if (!IsActive)
+    if (!IsActive || !stretchInitialized)
     {
         return sample;
     }
-    initRealtimeStretch();
 
     if (samplesProcessed++ == 0)
     {
         realtimeStart = std::chrono::high_resolution_clock::now();
     }
 
-    inputBuffer[inputWriteIndex++] = sample;
+    const Intervals &active = adoptIntervals();
+    const size_t voices = active.count;
+    if (voices == 0)
+    {
+        return sample;
+    }
 
-    if (outputReadIndex < blockSize)
+    if (!advance(sample, active))
+    {
+        return 0.0f;
+    }
+
+    float mixed = 0.0f;
+    for (size_t i = 0; i < voices; ++i)
     {
-        float mixed = 0.0f;
-        for (const auto &buffer : outputBuffers)
+        mixed += outputBuffers[i][outputReadIndex];
+    }
+    ++outputReadIndex;
+    return mixed / voices;
+}
+
+void Harmonizer::processChannels(float *const *channels, size_t channelCount, size_t frames)
+{
+    if (!IsActive || !stretchInitialized)
+    {
+        return;
+    }
+    if (channelCount < 2)
+    {
+        Effect::processChannels(channels, channelCount, frames);
+        return;
+    }
+
+    if (samplesProcessed == 0)
+    {
+        realtimeStart = std::chrono::high_resolution_clock::now();
+    }
+    samplesProcessed += frames;
+
+    const Intervals &active = adoptIntervals();
+    const size_t voices = active.count;
+    if (voices == 0)
+    {
+        return;
+    }
+
+    // Linear pan from left to right: each voice's gains sum to 2, so the mono fold is the mono mix
+    float left[maxVoices], right[maxVoices];
+    for (size_t i = 0; i < voices; ++i)
+    {
+        const float pan = voices > 1 ? spread * (2.0f * i / (voices - 1) - 1.0f) : 0.0f;
+        left[i] = (1.0f - pan) / voices;
+        right[i] = (1.0f + pan) / voices;
+    }
+
+    float *leftOut = channels[0];
+    float *rightOut = channels[1];
+    for (size_t n = 0; n < frames; ++n)
+    {
+        if (!advance(0.5f * (leftOut[n] + rightOut[n]), active))
         {
-            mixed += buffer[outputReadIndex];
+            leftOut[n] = rightOut[n] = 0.0f;
+            continue;
+        }
+
+        float mixedLeft = 0.0f, mixedRight = 0.0f;
+        for (size_t i = 0; i < voices; ++i)
+        {
+            const float shifted = outputBuffers[i][outputReadIndex];
+            mixedLeft += left[i] * shifted;
+            mixedRight += right[i] * shifted;
         }
         ++outputReadIndex;
-        return mixed / outputBuffers.size();
+        leftOut[n] = mixedLeft;
+        rightOut[n] = mixedRight;
+    }
+}
+
+bool Harmonizer::advance(float sample, const Intervals &voices)
+{
+    inputBuffer[inputWriteIndex++] = sample;
+
+    if (outputReadIndex < blockSize)
+    {
+        return true;
     }
 
     if (inputWriteIndex >= blockSize)
     {
 
+        // In key mode, follow the played note; a frame without a clear pitch keeps the last one
+        keys.update();
+        const HarmonyKey &key = keys.read();
+        if (key.enabled)
+        {
+            detector.push(inputBuffer.data(), blockSize);
+            if (detector.estimates() != lastEstimate)
+            {
+                lastEstimate = detector.estimates();
+                const float hz = detector.frequency();
+                if (hz > 0.0f)
+                    heldNote = static_cast<int>(std::lround(69.0f + 12.0f * std::log2(hz / 440.0f)));
+            }
+        }
+        const int note = heldNote >= 0 ? heldNote : 60 + key.tonic;
+
         float *inputs[1] = {inputBuffer.data()};
-        for (size_t i = 0; i < semitones.size(); ++i)
+        for (size_t i = 0; i < voices.count; ++i)
         {
-            stretches[i].setTransposeSemitones(semitones[i], tonality / sampleRate);
+            const int steps = voices.values[i];
+            const int shift = key.enabled ? diatonicShift(key, note, steps) : steps;
+            stretches[i].setTransposeSemitones(shift, tonality / SampleRate);
             float *outputs[1] = {outputBuffers[i].data()};
             stretches[i].process(inputs, blockSize, outputs, blockSize);
         }
 
         inputWriteIndex = 0;
         outputReadIndex = 0;
-
-        float mixed = 0.0f;
-        for (const auto &buffer : outputBuffers)
-        {
-            mixed += buffer[outputReadIndex];
-        }
-        ++outputReadIndex;
-        return mixed / outputBuffers.size();
+        return true;
     }
 
-    return 0.0f;
+    return false;
 }
 
 void Harmonizer::setupStretch(int currentSemitone)
@@ -149,27 +347,60 @@ void Harmonizer::parseConfig(const Config &config)
 {
     IsActive = config.contains("harmonizer");
 
-    std::string intervalsStr = config.get<std::string>("harmonizer", "0");
-    std::stringstream ss(intervalsStr);
-    std::string token;
-    semitones.clear();
+    const std::string intervalsStr = config.get<std::string>("harmonizer", "0");
+    std::vector<int> intervals;
 
     std::cout << "[Harmonizer] Raw interval string: \"" << intervalsStr << "\"\n";
 
-    while (ss >> token) // space-separated
+    // Space-separated integers, parsed in place
+    const char *cursor = intervalsStr.c_str();
+    while (*cursor != '\0')
     {
-        try
+        char *end = nullptr;
+        long value = std::strtol(cursor, &end, 10);
+        if (end != cursor)
         {
-            int val = std::stoi(token);
-            semitones.push_back(val);
-            std::cout << "[Harmonizer] Parsed semitone: " << val << "\n";
+            intervals.push_back(static_cast<int>(value));
+            cursor = end;
+            continue;
         }
-        catch (...)
+
+        const char *tokenEnd = cursor;
+        while (*tokenEnd != '\0' && !std::isspace(static_cast<unsigned char>(*tokenEnd)))
+            ++tokenEnd;
+        if (tokenEnd == cursor)
         {
-            std::cerr << "[Harmonizer] Warning: invalid interval \"" << token << "\"\n";
+            ++cursor; // trailing whitespace
+            continue;
         }
+        std::cerr << "[Harmonizer] Warning: invalid interval \"" << std::string(cursor, tokenEnd) << "\"\n";
+        cursor = tokenEnd;
+    }
+
+    if (intervals.size() > maxVoices)
+    {
+        std::cerr << "[Harmonizer] Warning: only the first " << maxVoices << " intervals are used\n";
+        intervals.resize(maxVoices);
     }
 
+    // Diatonic mode: the intervals become scale steps
+    HarmonyKey key;
+    const std::string keyName = config.get<std::string>("harmonizer_key", "");
+    if (config.contains("harmonizer_key") && !parseKey(keyName, key))
+        std::cerr << "[Harmonizer] Warning: unknown key \"" << keyName << "\", using fixed intervals\n";
+    keys.publish(key);
+    spread = std::min(std::max(config.getNumber("harmonizer_pan", 0.5f), 0.0f), 1.0f);
+
+    if (intervals == semitones)
+    {
+        std::cout << "[Harmonizer] Intervals unchanged, keeping voices\n";
+        return;
+    }
+
+    // Voices that keep sounding keep their stretch state; the audio thread adopts the set per block
+    publishIntervals(intervals);
+    semitones = std::move(intervals);
+
     std::cout << "[Harmonizer] Total intervals loaded: " << semitones.size() << "\n";
 }
 
@@ -182,7 +413,7 @@ Harmonizer::~Harmonizer()
         auto end = high_resolution_clock::now();
         double elapsed = duration<double>(end - realtimeStart).count();
         double perSampleUs = (elapsed / samplesProcessed) * 1e6;
-        double realtimeRatio = (samplesProcessed / static_cast<double>(sampleRate)) / elapsed;
+        double realtimeRatio = (samplesProcessed / static_cast<double>(SampleRate)) / elapsed;
 
         std::cout << "[Harmonizer] Real-time stretch stats:\n";
         std::cout << "\tSamples processed: " << samplesProcessed << "\n";
@@ -1,11 +1,14 @@
 #ifndef HARMONIZER_H
 #define HARMONIZER_H
 
+#include <array>
 #include <string>
 #include <vector>
 #include <chrono>
 #include <sndfile.h>
 #include "Effect.h"
+#include "PitchDetector.h"
+#include "TripleBuffer.h"
 #include "../lib/signalsmith-stretch/signalsmith-stretch.h"
 #include "../lib/signalsmith-stretch/cmd/util/stopwatch.h"
 // #include "../lib/signalsmith-stretch/cmd/util/memory-tracker.h"
@@ -17,9 +20,30 @@
  *
  * This class supports both offline (block-based) and real-time (sample-by-sample) pitch shifting.
  * It can also layer multiple pitch-shifted voices to form chords and export the result as a WAV file.
+ *
+ * By default each voice is shifted by a fixed number of semitones. With "harmonizer_key" set
+ * (e.g. "A minor"), the values are scale steps instead (2 = a third, 4 = a fifth, 7 = an
+ * octave): a PitchDetector follows the note being played and each voice is shifted to the
+ * note that many steps up (or down) the scale, so the harmony stays in key.
+ *
+ * In stereo the voices are shifted from the mono fold of the input and panned
+ * evenly from left to right, as wide as "harmonizer_pan" (0..1) sets.
  */
+/**
+ * @struct HarmonyKey
+ * @brief Key of the Harmonizer's diatonic mode.
+ */
+struct HarmonyKey
+{
+    bool enabled = false;                             ///< False: fixed semitone shifts
+    int tonic = 0;                                    ///< Pitch class of the tonic, 0 = C
+    std::array<int, 7> scale{{0, 2, 4, 5, 7, 9, 11}}; ///< Semitones of each degree above the tonic
+};
+
 class Harmonizer : public Effect {
 public:
+    static constexpr const char *Name = "Harmonizer"; ///< Name in the effect registry
+
     /**
      * @brief Constructs a harmonizer with specified input/output WAV files and pitch semitone values.
      * @param inputWav Input WAV filename relative to "assets/".
@@ -60,7 +84,35 @@ public:
      * @return The pitch-shifted output sample.
      */
     float process(float sample) override;
-    
+
+    ChannelLayout channelLayout() const override { return ChannelLayout::Stereo; }
+
+    /**
+     * @brief Shifts the mono fold of the channels and pans the voices across the first two.
+     */
+    void processChannels(float *const *channels, size_t channelCount, size_t frames) override;
+
+    /**
+     * @brief Creates all maxVoices stretch voices (and the pitch tracker) for the stream's rate,
+     *        so changing the intervals never creates or moves one while audio runs.
+     *        After release() it passes its input through until prepared again.
+     */
+    void prepare(float sampleRate, size_t maxBlockSize, size_t channels) override;
+    void reset() override;
+    void release() override;
+
+    /**
+     * @brief Parses a key such as "E", "F# dorian" or "Bb harmonic minor" (major if no scale is given).
+     * @return false (key untouched) if the tonic or scale is not recognised.
+     */
+    static bool parseKey(const std::string &text, HarmonyKey &key);
+
+    /**
+     * @brief Semitones from MIDI note `note` to the note `steps` scale degrees away in `key`.
+     *        Notes outside the scale are harmonised from the scale degree below them.
+     */
+    static int diatonicShift(const HarmonyKey &key, int note, int steps);
+
     ~Harmonizer();
 private:
     // === Real-time processing state ===
@@ -72,20 +124,53 @@ private:
     size_t inputWriteIndex = 0;
     size_t outputReadIndex = 0;
     size_t blockSize = 64;
-    int sampleRate = 44100;
+    float spread = 0.5f;    ///< Stereo width of the voices, 0..1
 
     std::chrono::high_resolution_clock::time_point realtimeStart;
     size_t samplesProcessed = 0;
 
+    static constexpr size_t maxVoices = 8; ///< Upper bound on simultaneous voices
+
+    /**
+     * @struct Intervals
+     * @brief One voice per entry: semitones, or scale steps in diatonic mode.
+     */
+    struct Intervals
+    {
+        std::array<int, maxVoices> values{};
+        size_t count = 0;
+    };
+
+    TripleBuffer<Intervals> intervalSets; ///< Published by parseConfig(), adopted once per call on the audio thread
+    size_t activeVoices = 0;           ///< Voices the audio thread is running (audio thread only)
+
+    /**
+     * @brief Audio thread: adopts newly published intervals, clearing voices that start sounding.
+     * @return The intervals to run this call.
+     */
+    const Intervals &adoptIntervals();
+
+    /**
+     * @brief Publishes `values` (at most maxVoices of them) to the audio thread.
+     */
+    void publishIntervals(const std::vector<int> &values);
+
+    // === Diatonic mode ===
+    TripleBuffer<HarmonyKey> keys;  ///< Published by parseConfig(), adopted once per block
+    PitchDetector detector;
+    size_t lastEstimate = 0;        ///< detector.estimates() when the note was last updated
+    int heldNote = -1;              ///< Last detected MIDI note, held through unpitched frames
+
     /**
-     * @brief Initializes internal buffers and the stretch object for real-time streaming.
+     * @brief Queues an input sample and shifts the next block for every voice once a block is in.
+     * @return false while the first block is still filling (there is no output yet).
      */
-    void initRealtimeStretch();
+    bool advance(float sample, const Intervals &voices);
 
     // === Offline processing configuration ===
     std::string inputWav;
     std::string outputWav;
-    std::vector<int> semitones;
+    std::vector<int> semitones;     ///< Config thread's copy of the intervals, also used offline
     std::vector<std::chrono::high_resolution_clock::time_point> realtimeSampleTimestamps;
 
     int currentSemitone = 0;
@@ -123,6 +208,7 @@ private:
 
 protected:
     void parseConfig(const Config &config) override;
+    const char *configKey() const override { return "harmonizer"; }
 };
 
 #endif // HARMONIZER_H
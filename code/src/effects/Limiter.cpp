@@ -0,0 +1,169 @@
+#include "Limiter.h"
+#include "BlockOps.h"
+#include "EffectRegistration.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+    float decibelsToLevel(float db) { return std::pow(10.0f, db / 20.0f); }
+}
+
+Limiter::Limiter()
+{
+    IsActive = false;
+    Setting = ceilingDb;
+    prepare(DEFAULT_SAMPLE_RATE, MAX_BLOCK_SIZE, MAX_CHANNELS);
+}
+
+void Limiter::prepare(float sampleRate, size_t maxBlockSize, size_t channels)
+{
+    Effect::prepare(sampleRate, maxBlockSize, channels);
+    for (size_t c = 0; c < MAX_CHANNELS; ++c)
+    {
+        if (c < Channels)
+            lines[c].allocate(MAX_LOOKAHEAD + SUBBLOCK);
+        else
+            lines[c].release();
+    }
+    settingChanged();
+    reset();
+}
+
+void Limiter::release()
+{
+    for (auto &line : lines)
+        line.release();
+}
+
+float Limiter::process(float sample)
+{
+    processBlock(&sample, 1);
+    return sample;
+}
+
+void Limiter::pushPeak(float magnitude, uint32_t end)
+{
+    // Entries no larger than the new one can never be the maximum again
+    while (head != tail && peaks[(tail - 1) & MASK] <= magnitude)
+        --tail;
+    peaks[tail & MASK] = magnitude;
+    ends[tail & MASK] = end;
+    ++tail;
+
+    // Drop sub-blocks that lie wholly before the window; one straddling its start stays (conservative)
+    while (end - ends[head & MASK] >= window)
+        ++head;
+}
+
+float Limiter::targetGain(float peak) const
+{
+    const float limit = peak > ceiling ? ceiling / peak : 1.0f;
+    const float compress = slope < 0.0f && peak > threshold ? std::pow(peak / threshold, slope) : 1.0f;
+    return std::min(limit, compress);
+}
+
+void Limiter::processBlock(float *samples, size_t count)
+{
+    processChannels(&samples, 1, count);
+}
+
+void Limiter::processChannels(float *const *channels, size_t channelCount, size_t frames)
+{
+    if (!IsActive)
+        return;
+
+    // A new lookahead invalidates the delay lines and the window: start them afresh
+    if (requestedLookahead.load(std::memory_order_relaxed) != lookahead)
+        reset();
+
+    // A channel that has just appeared (e.g. a stereo effect switched on) starts from the first one's lookahead
+    for (size_t c = delayedChannels; c < channelCount; ++c)
+        lines[c] = lines[0];
+    delayedChannels = channelCount;
+
+    for (size_t done = 0; done < frames; done += SUBBLOCK)
+    {
+        const size_t n = std::min(SUBBLOCK, frames - done);
+
+        // Feed the running maximum of every channel, then delay the audio by the lookahead
+        float peak = 0.0f;
+        for (size_t c = 0; c < channelCount; ++c)
+            peak = std::max(peak, peakMagnitude(channels[c] + done, n));
+        pushPeak(peak, static_cast<uint32_t>(lines[0].written() + n));
+        for (size_t c = 0; c < channelCount; ++c)
+        {
+            lines[c].write(channels[c] + done, n);
+            lines[c].read(channels[c] + done, n, lookahead);
+        }
+
+        // Attack is immediate (the window already saw the peak); release is exponential
+        const float required = targetGain(peaks[head & MASK]);
+        const float release = n == SUBBLOCK ? releaseBlock : std::pow(releaseBlock, static_cast<float>(n) / SUBBLOCK);
+        const float target = std::min(required, required + (currentGain - required) * release);
+
+        const float start = currentGain;
+        currentGain = target;
+        if (start == 1.0f && target == 1.0f)
+            continue; // No reduction: the delay is all there is to do
+
+        const float step = (target - start) / n;
+        for (size_t c = 0; c < channelCount; ++c)
+        {
+            float *block = channels[c] + done;
+            for (size_t i = 0; i < n; ++i)
+                block[i] = std::min(std::max(block[i] * (start + step * (i + 1)), -ceiling), ceiling);
+        }
+    }
+}
+
+void Limiter::settingChanged()
+{
+    try
+    {
+        ceilingDb = std::any_cast<float>(Setting);
+    }
+    catch (...)
+    {
+        ceilingDb = -1.0f; // Fallback ceiling
+    }
+
+    ceiling = decibelsToLevel(std::min(ceilingDb, 0.0f));
+    threshold = decibelsToLevel(thresholdDb);
+    slope = 1.0f / std::max(1.0f, ratio) - 1.0f;
+    releaseBlock = std::exp(-static_cast<float>(SUBBLOCK) / (std::max(1.0f, releaseMs) * 0.001f * SampleRate));
+
+    const size_t requested = static_cast<size_t>(std::max(0.0f, lookaheadMs) * 0.001f * SampleRate);
+    requestedLookahead.store(std::min(std::max(requested, SUBBLOCK), MAX_LOOKAHEAD), std::memory_order_relaxed);
+}
+
+void Limiter::reset()
+{
+    lookahead = requestedLookahead.load(std::memory_order_relaxed);
+    window = static_cast<uint32_t>(lookahead + SUBBLOCK);
+    for (auto &line : lines)
+        line.clear();
+    delayedChannels = 1;
+    head = tail = 0;
+    currentGain = 1.0f;
+}
+
+Limiter::~Limiter()
+{
+    std::cout << "[Limiter] Limiter destroyed cleanly\n";
+}
+
+void Limiter::parseConfig(const Config &config)
+{
+    IsActive = config.contains("limiter");
+    Setting = config.getNumber("limiter", -1.0f);
+    lookaheadMs = config.getNumber("limiter_lookahead", 1.5f);
+    releaseMs = config.getNumber("limiter_release", 50.0f);
+    thresholdDb = config.getNumber("limiter_threshold", -12.0f);
+    ratio = config.getNumber("limiter_ratio", 1.0f);
+    // Derived parameters only; the audio thread owns the lines, the window and the gain
+    settingChanged();
+}
+
+REGISTER_EFFECT_AUTO(Limiter);
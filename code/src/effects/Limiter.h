@@ -0,0 +1,98 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include "DelayLine.h"
+#include "Effect.h"
+
+/**
+ * @class Limiter
+ * @brief Lookahead peak limiter with an optional compressor stage.
+ *
+ * The signal is delayed by the lookahead while a monotonic deque keeps the
+ * running maximum of |x| over a sliding window that spans both the samples
+ * about to be output and everything up to the newest input. The deque is fed
+ * one vectorised peak per SUBBLOCK rather than every sample, and gain is
+ * computed once per SUBBLOCK from its front and applied as a vectorised
+ * linear ramp.
+ * Every window covers the output samples of the sub-block it was computed for
+ * and of the next one, so both ends of each ramp are safe for every sample
+ * under it, and the peak meets the ceiling without overshoot. A final clamp to
+ * the ceiling guards against float rounding, so the output never exceeds it.
+ *
+ * Channels are linked: one window and one gain cover the loudest of them, so
+ * a stereo image does not shift as the limiter works.
+ *
+ * Above "limiter_threshold" the level is additionally compressed by
+ * "limiter_ratio" (1 = off). Gain recovers with the release time constant.
+ *
+ * Parameter edits keep the limiter's state. A new lookahead is taken by the
+ * audio thread at the start of its next block, which clears its own state then.
+ *
+ * Config: "limiter" (ceiling in dBFS), "limiter_lookahead" (ms),
+ * "limiter_release" (ms), "limiter_threshold" (dBFS) and "limiter_ratio".
+ */
+class Limiter : public Effect
+{
+public:
+    static constexpr const char *Name = "Limiter"; ///< Name in the effect registry
+    static constexpr size_t SUBBLOCK = 32;         ///< Samples per gain update; also the shortest lookahead
+    static constexpr size_t MAX_LOOKAHEAD = 2048;  ///< Longest lookahead in samples (~46 ms at 44.1 kHz)
+
+    Limiter();
+    float process(float sample) override;
+    void processBlock(float *samples, size_t count) override;
+    ChannelLayout channelLayout() const override { return ChannelLayout::Any; }
+    void processChannels(float *const *channels, size_t channelCount, size_t frames) override;
+    size_t latency() const override { return requestedLookahead.load(std::memory_order_relaxed); }
+    void prepare(float sampleRate, size_t maxBlockSize, size_t channels) override;
+    void reset() override;
+    void release() override;
+    ~Limiter();
+
+    /**
+     * @brief Gain applied at the end of the last sub-block (1 = no reduction).
+     */
+    float gain() const { return currentGain; }
+
+protected:
+    void parseConfig(const Config &config) override;
+    const char *configKey() const override { return "limiter"; }
+    void settingChanged() override;
+
+private:
+    static constexpr size_t DEQUE = 4096; ///< Power of two > window (entries are at least a sample apart)
+    static constexpr size_t MASK = DEQUE - 1;
+
+    /**
+     * @brief Adds the peak of the samples before `end` and drops entries that left the window.
+     */
+    void pushPeak(float magnitude, uint32_t end);
+
+    /**
+     * @brief Gain wanted for a window peak: ceiling, then compressor curve.
+     */
+    float targetGain(float peak) const;
+
+    float ceilingDb = -1.0f;       ///< Setting, in dBFS
+    float lookaheadMs = 1.5f;
+    float releaseMs = 50.0f;
+    float thresholdDb = -12.0f;
+    float ratio = 1.0f;
+
+    // Derived in settingChanged(), off the audio path
+    float ceiling = 1.0f;
+    float threshold = 1.0f;
+    float slope = 0.0f;            ///< Compressor exponent 1/ratio - 1
+    float releaseBlock = 0.0f;     ///< Release coefficient over a full sub-block
+    std::atomic<size_t> requestedLookahead{SUBBLOCK}; ///< Reported as latency; taken by the audio thread
+
+    // Audio thread state
+    size_t lookahead = SUBBLOCK;   ///< Lookahead in use
+    uint32_t window = 2 * SUBBLOCK; ///< lookahead + SUBBLOCK
+    DelayLine lines[MAX_CHANNELS]; ///< Lookahead delay per prepared channel
+    size_t delayedChannels = 1;    ///< Channels the lines were last fed
+    float peaks[DEQUE] = {};       ///< Deque of decreasing sub-block peaks...
+    uint32_t ends[DEQUE] = {};     ///< ...and the input position each sub-block ended at
+    uint32_t head = 0, tail = 0;   ///< Deque occupies [head, tail), indices & MASK
+    float currentGain = 1.0f;
+};
@@ -0,0 +1,470 @@
+#include "Looper.h"
+#include "EffectRegistration.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fcntl.h>
+#include <iostream>
+#include <mutex>
+#include <sndfile.h>
+#include <thread>
+#include <unistd.h>
+
+namespace
+{
+    constexpr size_t WRITE_CHUNK = size_t(1) << 20; ///< Bytes per write() when saving
+    constexpr size_t READ_FRAMES = 4096;            ///< Frames per sf_readf_float() when restoring
+    constexpr size_t WAV_HEADER = 44;
+
+    // The one thread that saves loops, shared by the Loopers of every chain
+    struct Writer
+    {
+        std::mutex lifecycle;  ///< Serialises starting and stopping the thread
+        std::mutex mutex;      ///< Held while saving, and while a Looper reallocates its loop
+        std::condition_variable wake;
+        std::vector<Looper *> loopers;
+        bool running = false;
+        std::thread thread;
+    };
+
+    Writer &writer()
+    {
+        static Writer instance;
+        return instance;
+    }
+
+    void put(uint8_t *at, uint32_t value, size_t bytes)
+    {
+        for (size_t i = 0; i < bytes; ++i)
+            at[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+
+    bool writeAll(int fd, const void *data, size_t bytes)
+    {
+        const char *cursor = static_cast<const char *>(data);
+        while (bytes > 0)
+        {
+            const ssize_t n = ::write(fd, cursor, bytes);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            cursor += n;
+            bytes -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    // Restrict-qualified so GCC vectorises without run-time alias checks
+    void play(float *__restrict samples, const float *__restrict loop, float level, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            samples[i] += level * loop[i];
+    }
+
+    void overdub(float *__restrict samples, float *__restrict loop, float level, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float input = samples[i];
+            samples[i] = input + level * loop[i];
+            loop[i] += input;
+        }
+    }
+}
+
+Looper::Looper()
+{
+    IsActive = false;
+    Setting = level;
+}
+
+float Looper::process(float sample)
+{
+    processBlock(&sample, 1);
+    return sample;
+}
+
+void Looper::processBlock(float *samples, size_t count)
+{
+    if (!IsActive || loop.empty())
+        return;
+    takeCommand();
+
+    // Each pass runs up to the next loop boundary, so boundaries fall on exact samples
+    while (count > 0)
+    {
+        const State now = current.load(std::memory_order_relaxed);
+        size_t n = count;
+        if (now == State::Recording)
+        {
+            n = std::min(count, loop.size() - position);
+            std::copy(samples, samples + n, loop.data() + position);
+            position += n;
+            if (position == loop.size())
+            {
+                // Out of room: close the loop here and play on
+                loopLength.store(position, std::memory_order_release);
+                position = 0;
+                current.store(State::Playing, std::memory_order_release);
+                revision.fetch_add(1, std::memory_order_release);
+            }
+        }
+        else if (now == State::Playing || now == State::Overdubbing)
+        {
+            n = std::min(count, loopLength.load(std::memory_order_relaxed) - position);
+            if (now == State::Playing)
+                play(samples, loop.data() + position, level, n);
+            else
+                overdub(samples, loop.data() + position, level, n);
+            position += n;
+            if (position == loopLength.load(std::memory_order_relaxed))
+                position = 0;
+        }
+        samples += n;
+        count -= n;
+    }
+}
+
+void Looper::takeCommand()
+{
+    if (command.load(std::memory_order_relaxed) == Command::None)
+        return;
+    const Command taken = command.exchange(Command::None, std::memory_order_acq_rel);
+    const State now = current.load(std::memory_order_relaxed);
+    State next = now;
+
+    switch (taken)
+    {
+    case Command::None:
+        return;
+    case Command::Press:
+        if (now == State::Empty)
+        {
+            next = State::Recording;
+            position = 0;
+        }
+        else if (now == State::Recording)
+        {
+            next = position > 0 ? State::Playing : State::Empty;
+        }
+        else if (now == State::Playing)
+        {
+            next = State::Overdubbing;
+        }
+        else if (now == State::Overdubbing)
+        {
+            next = State::Playing;
+        }
+        else
+        {
+            next = State::Playing;
+            position = 0;
+        }
+        break;
+    case Command::Stop:
+        if (now == State::Recording)
+            next = position > 0 ? State::Stopped : State::Empty;
+        else if (now != State::Empty)
+            next = State::Stopped;
+        break;
+    case Command::Clear:
+        next = State::Empty;
+        break;
+    }
+
+    if (now == State::Recording && next != State::Empty)
+    {
+        // The first recording ends on this sample, and the loop starts on it
+        loopLength.store(position, std::memory_order_release);
+        position = 0;
+    }
+    if (next == State::Empty)
+    {
+        loopLength.store(0, std::memory_order_release);
+        position = 0;
+    }
+    current.store(next, std::memory_order_release);
+
+    // A finished pass (or a cleared loop) is what the writer saves
+    if ((now == State::Recording || now == State::Overdubbing || taken == Command::Clear) && next != now)
+        revision.fetch_add(1, std::memory_order_release);
+}
+
+const char *Looper::stateName(State state)
+{
+    switch (state)
+    {
+    case State::Recording:
+        return "REC";
+    case State::Playing:
+        return "PLAY";
+    case State::Overdubbing:
+        return "DUB";
+    case State::Stopped:
+        return "STOP";
+    default:
+        return "EMPTY";
+    }
+}
+
+void Looper::prepare(float sampleRate, size_t maxBlockSize, size_t channels)
+{
+    const float previousRate = SampleRate;
+    Effect::prepare(sampleRate, maxBlockSize, channels);
+    fileRate.store(SampleRate);
+    position = 0;
+    if (!wanted)
+        return; // Never switched on: no buffer
+
+    const bool fresh = loop.empty();
+    const size_t capacity = static_cast<size_t>((fresh ? wantedMinutes : minutes) * 60.0f * SampleRate);
+    if (!fresh && capacity == loop.size())
+        return;
+    if (!fresh && length() > 0)
+        std::cerr << "[Looper] Loop recorded at " << previousRate << " Hz; playing it at " << SampleRate << " Hz\n";
+
+    {
+        // The writer may be saving from the old buffer
+        std::lock_guard<std::mutex> lock(writer().mutex);
+        if (fresh)
+        {
+            minutes = wantedMinutes;
+            path = wantedPath;
+        }
+        // Filling touches every page, so the audio thread never faults on the first pass
+        loop.resize(capacity, 0.0f);
+        if (length() > capacity)
+            loopLength.store(capacity);
+
+        const size_t restored = fresh ? loadLoop(path, loop.data(), loop.size(), SampleRate) : 0;
+        if (restored > 0)
+        {
+            loopLength.store(restored);
+            current.store(State::Stopped);
+            std::cout << "[Looper] Restored " << restored << " samples from " << path << "\n";
+        }
+        savedRevision.store(revision.load());
+    }
+    if (!enlisted.load())
+        enlist();
+}
+
+void Looper::release()
+{
+    // Finished passes are saved before the buffer goes; the next prepare() restores the loop from disk
+    if (enlisted.load())
+    {
+        flush();
+        dismiss();
+    }
+    std::vector<float>().swap(loop);
+    loopLength.store(0);
+    current.store(State::Empty);
+    position = 0;
+    savedRevision.store(revision.load());
+}
+
+void Looper::enlist()
+{
+    Writer &shared = writer();
+    std::lock_guard<std::mutex> life(shared.lifecycle);
+    {
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        shared.loopers.push_back(this);
+        enlisted.store(true, std::memory_order_release);
+        if (shared.running)
+            return;
+        shared.running = true;
+    }
+    shared.thread = std::thread(&Looper::persist);
+}
+
+void Looper::dismiss()
+{
+    Writer &shared = writer();
+    std::lock_guard<std::mutex> life(shared.lifecycle);
+    {
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        shared.loopers.erase(std::remove(shared.loopers.begin(), shared.loopers.end(), this), shared.loopers.end());
+        enlisted.store(false, std::memory_order_release);
+        if (!shared.loopers.empty())
+            return;
+        shared.running = false;
+    }
+    shared.wake.notify_all();
+    shared.thread.join();
+}
+
+void Looper::persist()
+{
+    Writer &shared = writer();
+    std::unique_lock<std::mutex> lock(shared.mutex);
+    while (shared.running)
+    {
+        // One Looper at a time, so Loopers sharing a file never write it (or its .tmp) at once
+        for (Looper *looper : shared.loopers)
+            looper->saveIfChanged();
+        shared.wake.wait_for(lock, std::chrono::milliseconds(SAVE_POLL_MS), [&shared] { return !shared.running; });
+    }
+}
+
+void Looper::saveIfChanged()
+{
+    const uint64_t target = revision.load(std::memory_order_acquire);
+    if (target == savedRevision.load(std::memory_order_relaxed))
+        return;
+    // Mid-pass the loop is still being written; it is saved when the pass ends
+    const State now = state();
+    if (now == State::Recording || now == State::Overdubbing)
+        return;
+
+    // An overdub started during the save races with it, but ends with another save
+    const size_t samples = length();
+    bool saved = true;
+    if (samples == 0)
+        saved = std::remove(path.c_str()) == 0 || errno == ENOENT;
+    else
+        saved = saveLoop(path, loop.data(), samples, fileRate.load());
+
+    if (!saved)
+        std::cerr << "[Looper] Failed to save the loop to " << path << "\n";
+    savedRevision.store(target, std::memory_order_release);
+}
+
+void Looper::flush()
+{
+    while (enlisted.load(std::memory_order_acquire))
+    {
+        const State now = state();
+        if (now == State::Recording || now == State::Overdubbing)
+            return; // Nothing finished to save yet
+        if (savedRevision.load(std::memory_order_acquire) == revision.load(std::memory_order_acquire))
+            return;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+bool Looper::saveLoop(const std::string &path, const float *samples, size_t count, float sampleRate)
+{
+    const uint32_t rate = static_cast<uint32_t>(sampleRate);
+    const uint32_t dataBytes = static_cast<uint32_t>(count * sizeof(float));
+
+    // RIFF/WAVE header of a mono IEEE float file
+    uint8_t header[WAV_HEADER] = {'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E', 'f', 'm', 't', ' '};
+    put(header + 4, 36 + dataBytes, 4);
+    put(header + 16, 16, 4);
+    put(header + 20, 3, 2); // WAVE_FORMAT_IEEE_FLOAT
+    put(header + 22, 1, 2);
+    put(header + 24, rate, 4);
+    put(header + 28, rate * sizeof(float), 4);
+    put(header + 32, sizeof(float), 2);
+    put(header + 34, 32, 2);
+    std::copy_n("data", 4, header + 36);
+    put(header + 40, dataBytes, 4);
+
+    const std::string temporary = path + ".tmp";
+    const int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return false;
+
+    // Samples straight from the loop buffer (little-endian hosts), in large writes
+    bool ok = writeAll(fd, header, sizeof(header));
+    const char *bytes = reinterpret_cast<const char *>(samples);
+    for (size_t done = 0; ok && done < dataBytes; done += WRITE_CHUNK)
+        ok = writeAll(fd, bytes + done, std::min<size_t>(WRITE_CHUNK, dataBytes - done));
+    ok = ok && ::fsync(fd) == 0;
+    ok = ::close(fd) == 0 && ok;
+
+    if (!ok || std::rename(temporary.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+size_t Looper::loadLoop(const std::string &path, float *samples, size_t capacity, float sampleRate)
+{
+    SF_INFO info = {};
+    SNDFILE *file = sf_open(path.c_str(), SFM_READ, &info);
+    if (!file)
+        return 0;
+
+    if (info.samplerate > 0 && static_cast<float>(info.samplerate) != sampleRate)
+        std::cerr << "[Looper] " << path << " was recorded at " << info.samplerate << " Hz; playing it at "
+                  << sampleRate << " Hz\n";
+
+    // Mix down to mono, a chunk at a time
+    const size_t channels = static_cast<size_t>(std::max(info.channels, 1));
+    std::vector<float> frames(READ_FRAMES * channels);
+    size_t loaded = 0;
+    while (loaded < capacity)
+    {
+        const sf_count_t wanted = static_cast<sf_count_t>(std::min(READ_FRAMES, capacity - loaded));
+        const sf_count_t read = sf_readf_float(file, frames.data(), wanted);
+        if (read <= 0)
+            break;
+        for (sf_count_t i = 0; i < read; ++i)
+        {
+            float sum = 0.0f;
+            for (size_t c = 0; c < channels; ++c)
+                sum += frames[static_cast<size_t>(i) * channels + c];
+            samples[loaded++] = sum / channels;
+        }
+    }
+    if (static_cast<size_t>(info.frames) > capacity)
+        std::cerr << "[Looper] " << path << " truncated to " << capacity << " samples\n";
+    sf_close(file);
+    return loaded;
+}
+
+void Looper::settingChanged()
+{
+    try
+    {
+        level = std::any_cast<float>(Setting);
+    }
+    catch (...)
+    {
+        level = 1.0f; // Fallback level
+    }
+    level = std::min(std::max(level, 0.0f), 1.0f);
+}
+
+Looper::~Looper()
+{
+    release();
+    std::cout << "[Looper] Looper destroyed cleanly\n";
+}
+
+void Looper::parseConfig(const Config &config)
+{
+    const bool active = config.contains("looper");
+    Setting = config.getNumber("looper", 1.0f);
+    settingChanged();
+
+    wantedPath = config.get<std::string>("looper_file", wantedPath);
+    wantedMinutes = std::min(std::max(config.getNumber("looper_minutes", 2.0f), 0.01f), MAX_MINUTES);
+
+    // The buffer must exist before the audio thread can record into it. The first
+    // switch-on prepares it here: the looper was off, so the audio thread is not in it
+    if (active && !wanted)
+    {
+        wanted = true;
+        prepare(SampleRate, MaxBlockSize, Channels);
+    }
+    else if (!loop.empty() && (wantedPath != path || wantedMinutes != minutes))
+    {
+        std::cerr << "[Looper] looper_file and looper_minutes take effect on restart\n";
+    }
+
+    // Switching the looper off stops the loop, which is kept for when it comes back on
+    if (!active && state() != State::Empty)
+        stop();
+    IsActive = active;
+}
+
+REGISTER_EFFECT_AUTO(Looper);
@@ -0,0 +1,164 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Effect.h"
+
+/**
+ * @class Looper
+ * @brief One-button looper: record a loop, then play it back and overdub onto it.
+ *
+ * The loop buffer (looper_minutes long) is allocated and touched by prepare()
+ * once the looper has been switched on, resized when the sample rate changes
+ * and freed by release(); recording, playing and overdubbing only move through
+ * it. Controls arrive as atomic commands from
+ * the UI and are taken at the start of the next block, and every boundary
+ * after that is exact to the sample: the first recording ends, and playback
+ * starts, on the sample the command is taken, and the loop wraps mid-block.
+ *
+ * One background thread, shared by every Looper (one per chain), writes the
+ * loop to looper_file as a 32-bit float WAV whenever a recording or overdub
+ * pass finishes (a temporary file in large writes, then a rename), so saves
+ * to the same file never overlap. The loop in that file is restored, stopped,
+ * when the buffer is next allocated.
+ *
+ * press() steps Empty -> Recording -> Playing <-> Overdubbing, and plays a
+ * Stopped loop from the start; stop() stops it; clear() discards it.
+ *
+ * Config: "looper" (loop playback level, 0..1), "looper_minutes" (longest
+ * loop) and "looper_file" (where the loop is kept).
+ */
+class Looper : public Effect
+{
+public:
+    static constexpr const char *Name = "Looper"; ///< Name in the effect registry
+    static constexpr float MAX_MINUTES = 10.0f;
+    static constexpr int SAVE_POLL_MS = 100;     ///< How often the writer checks for a finished pass
+
+    enum class State : uint8_t
+    {
+        Empty,
+        Recording,
+        Playing,
+        Overdubbing,
+        Stopped
+    };
+
+    Looper();
+    float process(float sample) override;
+    void processBlock(float *samples, size_t count) override;
+    void prepare(float sampleRate, size_t maxBlockSize, size_t channels) override;
+    void release() override;
+    ~Looper();
+
+    /**
+     * @brief Control thread: record/play/overdub, taken at the start of the next block.
+     */
+    void press() { command.store(Command::Press, std::memory_order_release); }
+
+    /**
+     * @brief Control thread: stops playback, keeping the loop.
+     */
+    void stop() { command.store(Command::Stop, std::memory_order_release); }
+
+    /**
+     * @brief Control thread: discards the loop (and its file).
+     */
+    void clear() { command.store(Command::Clear, std::memory_order_release); }
+
+    /**
+     * @brief Whether a command is still waiting for the audio thread.
+     */
+    bool commandPending() const { return command.load(std::memory_order_acquire) != Command::None; }
+
+    /**
+     * @brief Current state, as last set by the audio thread.
+     */
+    State state() const { return current.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Short name of a state for the display (e.g. "REC").
+     */
+    static const char *stateName(State state);
+
+    /**
+     * @brief Loop length in samples (0 until the first recording ends).
+     */
+    size_t length() const { return loopLength.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Blocks until the writer has saved every finished pass (for tests and shutdown).
+     */
+    void flush();
+
+    /**
+     * @brief Writes samples as a mono 32-bit float WAV, via a temporary file and a rename.
+     */
+    static bool saveLoop(const std::string &path, const float *samples, size_t count, float sampleRate);
+
+    /**
+     * @brief Reads up to `capacity` samples of a WAV (mixed down to mono) into `samples`.
+     * @return Samples read; 0 if the file cannot be read.
+     */
+    static size_t loadLoop(const std::string &path, float *samples, size_t capacity, float sampleRate);
+
+protected:
+    void parseConfig(const Config &config) override;
+    const char *configKey() const override { return "looper"; }
+    void settingChanged() override;
+
+private:
+    enum class Command : uint8_t
+    {
+        None,
+        Press,
+        Stop,
+        Clear
+    };
+
+    /**
+     * @brief Audio thread: applies a pending command.
+     */
+    void takeCommand();
+
+    /**
+     * @brief Hands the loop to the writer thread, starting it if this is the first Looper with a buffer.
+     */
+    void enlist();
+
+    /**
+     * @brief Takes the loop back from the writer thread, stopping it if no other Looper has a buffer.
+     */
+    void dismiss();
+
+    /**
+     * @brief Writer thread body: saves the finished passes of every enlisted Looper.
+     */
+    static void persist();
+
+    /**
+     * @brief Writer thread: saves (or removes) the loop file if a pass finished since the last save.
+     */
+    void saveIfChanged();
+
+    float level = 1.0f;            ///< Setting
+    bool wanted = false;           ///< The looper has been switched on, so prepare() allocates
+    float wantedMinutes = 2.0f;    ///< looper_minutes as configured
+    std::string wantedPath = "assets/loop.wav";
+    float minutes = 2.0f;          ///< looper_minutes when the buffer was allocated
+    std::string path = "assets/loop.wav";
+
+    // Shared with the writer and UI threads
+    std::vector<float> loop;       ///< Sized by prepare(), resized and freed with the writer locked out
+    std::atomic<Command> command{Command::None};
+    std::atomic<State> current{State::Empty};
+    std::atomic<size_t> loopLength{0};
+    std::atomic<uint64_t> revision{0};      ///< Bumped by the audio thread when a pass finishes or the loop is cleared
+    std::atomic<uint64_t> savedRevision{0}; ///< Revision last saved by the writer
+    std::atomic<bool> enlisted{false};      ///< Known to the writer thread
+    std::atomic<float> fileRate{DEFAULT_SAMPLE_RATE}; ///< SampleRate, for the writer
+
+    // Audio thread state
+    size_t position = 0;           ///< Next sample of the loop to play (or record)
+};
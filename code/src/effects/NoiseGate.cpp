@@ -0,0 +1,176 @@
+#include "NoiseGate.h"
+#include "BlockOps.h"
+#include "EffectRegistration.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+    float decibelsToLevel(float db) { return std::pow(10.0f, db / 20.0f); }
+
+    // Per-sample step of a linear ramp across 0..1 lasting `ms`
+    float rampStep(float ms, float sampleRate) { return 1.0f / std::max(1.0f, ms * 0.001f * sampleRate); }
+}
+
+NoiseGate::NoiseGate()
+{
+    IsActive = false;
+    Setting = thresholdDb;
+    settingChanged();
+}
+
+void NoiseGate::prepare(float sampleRate, size_t maxBlockSize, size_t channels)
+{
+    Effect::prepare(sampleRate, maxBlockSize, channels);
+    settingChanged();
+    reset();
+}
+
+void NoiseGate::reset()
+{
+    envelope = 0.0f;
+    holdLeft = 0;
+    open = false;
+    currentGain = 0.0f;
+}
+
+float NoiseGate::process(float sample)
+{
+    processBlock(&sample, 1);
+    return sample;
+}
+
+float NoiseGate::track(const float *key, size_t n)
+{
+    // A detector switch carries the envelope over: RMS mode keeps a mean square
+    if (rms != envelopeIsMeanSquare)
+    {
+        envelope = rms ? envelope * envelope : std::sqrt(envelope);
+        envelopeIsMeanSquare = rms;
+    }
+
+    // Reduce the sub-block to one level
+    float level;
+    if (rms)
+    {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i)
+            sum += key[i] * key[i];
+        const float smoothing = n == SUBBLOCK ? rmsSmoothingBlock : std::pow(rmsSmoothing, static_cast<float>(n));
+        envelope = smoothing * envelope + (1.0f - smoothing) * (sum / n);
+        level = std::sqrt(envelope);
+    }
+    else
+    {
+        const float peak = peakMagnitude(key, n);
+        envelope = std::max(peak, envelope * (n == SUBBLOCK ? envelopeDecayBlock : std::pow(envelopeDecay, static_cast<float>(n))));
+        level = envelope;
+    }
+
+    // Hysteresis: open above openLevel, close only after holding below closeLevel
+    if (level >= openLevel)
+        open = true;
+    if (level >= closeLevel)
+    {
+        holdLeft = holdSamples;
+    }
+    else
+    {
+        // The hold only runs out below the band, so a zero hold still opens
+        holdLeft -= std::min<uint32_t>(holdLeft, static_cast<uint32_t>(n));
+        if (holdLeft == 0)
+            open = false;
+    }
+
+    return open ? std::min(1.0f, currentGain + attackStep * n) : std::max(0.0f, currentGain - releaseStep * n);
+}
+
+void NoiseGate::processBlock(float *samples, size_t count)
+{
+    processChannels(&samples, 1, count);
+}
+
+void NoiseGate::processChannels(float *const *channels, size_t channelCount, size_t frames)
+{
+    if (!IsActive)
+        return;
+
+    const bool sidechain = keyed && Sidechain;
+    for (size_t done = 0; done < frames; done += SUBBLOCK)
+    {
+        const size_t n = std::min(SUBBLOCK, frames - done);
+
+        const float *key = sidechain ? Sidechain + done : channels[0] + done;
+        if (!sidechain && channelCount > 1)
+        {
+            // Linked: the louder channel keys the gate
+            for (size_t i = 0; i < n; ++i)
+                linked[i] = std::fabs(key[i]);
+            for (size_t c = 1; c < channelCount; ++c)
+            {
+                const float *plane = channels[c] + done;
+                for (size_t i = 0; i < n; ++i)
+                    linked[i] = std::max(linked[i], std::fabs(plane[i]));
+            }
+            key = linked;
+        }
+
+        const float target = track(key, n);
+        const float start = currentGain;
+        currentGain = target;
+        if (start == 1.0f && target == 1.0f)
+            continue; // Fully open: pass through
+
+        const float slope = (target - start) / n;
+        for (size_t c = 0; c < channelCount; ++c)
+        {
+            float *block = channels[c] + done;
+            for (size_t i = 0; i < n; ++i)
+                block[i] *= start + slope * (i + 1);
+        }
+    }
+}
+
+void NoiseGate::settingChanged()
+{
+    try
+    {
+        thresholdDb = std::any_cast<float>(Setting);
+    }
+    catch (...)
+    {
+        thresholdDb = -50.0f; // Fallback threshold
+    }
+
+    openLevel = decibelsToLevel(thresholdDb);
+    closeLevel = decibelsToLevel(thresholdDb - std::max(0.0f, hysteresisDb));
+    attackStep = rampStep(attackMs, SampleRate);
+    releaseStep = rampStep(releaseMs, SampleRate);
+    holdSamples = static_cast<uint32_t>(std::max(0.0f, holdMs) * 0.001f * SampleRate);
+    envelopeDecay = std::exp(-1.0f / (0.010f * SampleRate)); // 10 ms peak decay
+    rmsSmoothing = std::exp(-1.0f / (0.005f * SampleRate));  // 5 ms RMS window
+    envelopeDecayBlock = std::pow(envelopeDecay, static_cast<float>(SUBBLOCK));
+    rmsSmoothingBlock = std::pow(rmsSmoothing, static_cast<float>(SUBBLOCK));
+}
+
+NoiseGate::~NoiseGate()
+{
+    std::cout << "[NoiseGate] NoiseGate destroyed cleanly\n";
+}
+
+void NoiseGate::parseConfig(const Config &config)
+{
+    IsActive = config.contains("noisegate");
+    Setting = config.getNumber("noisegate", -50.0f);
+    hysteresisDb = config.getNumber("noisegate_hysteresis", 6.0f);
+    attackMs = config.getNumber("noisegate_attack", 1.0f);
+    holdMs = config.getNumber("noisegate_hold", 50.0f);
+    releaseMs = config.getNumber("noisegate_release", 100.0f);
+    rms = config.get<std::string>("noisegate_detector", "peak") == "rms";
+    keyed = config.get<bool>("noisegate_sidechain", false);
+    // Coefficients only: the detector keeps its state, so an edit mid-note leaves the gate as it is
+    settingChanged();
+}
+
+REGISTER_EFFECT_AUTO(NoiseGate);
@@ -0,0 +1,91 @@
+#pragma once
+#include <cstdint>
+#include "Effect.h"
+
+/**
+ * @class NoiseGate
+ * @brief Mutes the signal between phrases, with hysteresis and attack/hold/release.
+ *
+ * The detector runs at control rate: each SUBBLOCK of the key signal is reduced
+ * to its peak or mean square in one vectorised pass, then smoothed into an
+ * envelope. The gate opens when the envelope rises above the threshold and
+ * closes once it has stayed below threshold - hysteresis for the hold time.
+ * The gain ramps linearly to 1 over the attack time and to 0 over the release
+ * time; within a sub-block it is a linear ramp applied in one vectorised pass,
+ * so a steadily open or closed gate is a plain multiply with no per-sample
+ * branches.
+ *
+ * With "noisegate_sidechain" the key is the chain's unprocessed input, i.e.
+ * the guitar before Fuzz and Gain, so the gate tracks playing dynamics rather
+ * than the compressed, noisy output of the distortion. Otherwise the key of a
+ * multichannel signal is the louder channel at each sample, and every channel
+ * gets the same gain.
+ *
+ * Config: "noisegate" (threshold in dBFS), "noisegate_hysteresis" (dB),
+ * "noisegate_attack", "noisegate_hold", "noisegate_release" (ms),
+ * "noisegate_detector" (peak/rms) and "noisegate_sidechain" (true/false).
+ */
+class NoiseGate : public Effect
+{
+public:
+    static constexpr const char *Name = "NoiseGate"; ///< Name in the effect registry
+    static constexpr size_t SUBBLOCK = 32;           ///< Samples per detector/gain update
+
+    NoiseGate();
+    float process(float sample) override;
+    void processBlock(float *samples, size_t count) override;
+    ChannelLayout channelLayout() const override { return ChannelLayout::Any; }
+    void processChannels(float *const *channels, size_t channelCount, size_t frames) override;
+    void prepare(float sampleRate, size_t maxBlockSize, size_t channels) override;
+    void reset() override;
+    ~NoiseGate();
+
+    /**
+     * @brief Whether the gate is currently open.
+     */
+    bool isOpen() const { return open; }
+
+    /**
+     * @brief Current gain (0 closed, 1 open).
+     */
+    float gain() const { return currentGain; }
+
+protected:
+    void parseConfig(const Config &config) override;
+    const char *configKey() const override { return "noisegate"; }
+    void settingChanged() override;
+
+private:
+    /**
+     * @brief Advances the detector and gate state over one sub-block of the key.
+     * @return Gain to reach by the end of the sub-block.
+     */
+    float track(const float *key, size_t n);
+
+    float thresholdDb = -50.0f;     ///< Setting, in dBFS
+    float hysteresisDb = 6.0f;
+    float attackMs = 1.0f;
+    float holdMs = 50.0f;
+    float releaseMs = 100.0f;
+    bool rms = false;               ///< RMS rather than peak detection
+    bool keyed = false;             ///< Detect on the chain input rather than our own input
+
+    // Derived in settingChanged(), off the audio path
+    float openLevel = 0.0f;         ///< Envelope level that opens the gate
+    float closeLevel = 0.0f;        ///< Envelope level below which the hold time runs
+    float attackStep = 1.0f;        ///< Gain rise per sample
+    float releaseStep = 1.0f;       ///< Gain fall per sample
+    float envelopeDecay = 0.0f;     ///< Peak envelope decay per sample
+    float rmsSmoothing = 0.0f;      ///< Mean-square one-pole coefficient per sample
+    float envelopeDecayBlock = 0.0f; ///< envelopeDecay over a full sub-block
+    float rmsSmoothingBlock = 0.0f;  ///< rmsSmoothing over a full sub-block
+    uint32_t holdSamples = 0;
+
+    // Detector and gate state (audio thread only)
+    float envelope = 0.0f;          ///< Peak level, or mean square in RMS mode
+    bool envelopeIsMeanSquare = false; ///< Detector mode `envelope` was last tracked in
+    uint32_t holdLeft = 0;
+    bool open = false;
+    float currentGain = 0.0f;
+    float linked[SUBBLOCK] = {};    ///< Key of a multichannel sub-block
+};
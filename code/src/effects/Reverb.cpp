@@ -0,0 +1,231 @@
+#include "Reverb.h"
+#include "EffectRegistration.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+    // Mutually prime line lengths at 44.1 kHz (25..79 ms), scaled by "reverb_size"
+    constexpr float BASE_LENGTHS[Reverb::MAX_LINES] = {1117, 1277, 1429, 1601, 1759, 1907, 2063, 2221,
+                                                       2371, 2531, 2687, 2843, 3001, 3167, 3319, 3469};
+    constexpr float MAX_SIZE = 2.0f;
+    constexpr float MAX_MODULATION_MS = 2.0f;
+    constexpr float MODULATION_HZ = 0.5f;
+}
+
+Reverb::Reverb()
+{
+    IsActive = false;
+    Setting = decaySeconds;
+    prepare(DEFAULT_SAMPLE_RATE, MAX_BLOCK_SIZE, MAX_CHANNELS);
+}
+
+void Reverb::prepare(float sampleRate, size_t maxBlockSize, size_t channels)
+{
+    Effect::prepare(sampleRate, maxBlockSize, channels);
+    const float longest = BASE_LENGTHS[MAX_LINES - 1] * MAX_SIZE * SampleRate / 44100.0f;
+    const float modulation = MAX_MODULATION_MS * 0.001f * SampleRate;
+    for (DelayLine &line : delays)
+        line.allocate(static_cast<size_t>(longest + modulation) + CHUNK + 4);
+    settingChanged();
+    reset();
+}
+
+void Reverb::release()
+{
+    for (DelayLine &line : delays)
+        line.release();
+}
+
+ReverbMatrix Reverb::parseMatrix(const std::string &name)
+{
+    return name == "householder" ? ReverbMatrix::Householder : ReverbMatrix::Hadamard;
+}
+
+float Reverb::process(float sample)
+{
+    processBlock(&sample, 1);
+    return sample;
+}
+
+void Reverb::processBlock(float *samples, size_t count)
+{
+    processChannels(&samples, 1, count);
+}
+
+void Reverb::processChannels(float *const *channels, size_t channelCount, size_t frames)
+{
+    if (!IsActive)
+        return;
+
+    const bool stereo = channelCount > 1;
+    for (size_t done = 0; done < frames; done += CHUNK)
+    {
+        const size_t n = std::min(CHUNK, frames - done);
+        float *right = stereo ? channels[1] + done : nullptr;
+        if (lines == MAX_LINES)
+            processChunk<MAX_LINES>(channels[0] + done, right, n);
+        else
+            processChunk<MAX_LINES / 2>(channels[0] + done, right, n);
+    }
+}
+
+template <size_t N>
+void Reverb::processChunk(float *left, float *right, size_t n)
+{
+    const float *input = left;
+    if (right)
+    {
+        for (size_t i = 0; i < n; ++i)
+            folded[i] = 0.5f * (left[i] + right[i]);
+        input = folded;
+        std::fill(wetOdd, wetOdd + n, 0.0f);
+    }
+
+    // The LFO moves a read position by a small fraction of a sample per chunk, so each
+    // line is read at one fractional delay, taken at the middle of the chunk
+    const float middle = phase + 0.5f * phaseStep * n / CHUNK;
+    std::fill(wet, wet + n, 0.0f);
+    for (size_t l = 0; l < N; ++l)
+    {
+        float *x = lanes[l];
+        delays[l].readFractional(x, n, lengths[l] + depth * WavetableLFO::sine(middle + static_cast<float>(l) / N));
+
+        // The output taps the lines at alternating polarity; in stereo the odd lines go right
+        const float sign = signs[l];
+        float *tap = right && (l & 1) ? wetOdd : wet;
+        for (size_t i = 0; i < n; ++i)
+            tap[i] += sign * x[i];
+
+        // Damping: one-pole low-pass with the line's decay gain folded in
+        const float pole = poles[l], gain = feedforward[l];
+        float y = state[l];
+        for (size_t i = 0; i < n; ++i)
+            x[i] = y = pole * y + gain * x[i];
+        state[l] = y;
+    }
+    phase += phaseStep * n / CHUNK;
+    phase -= std::floor(phase);
+
+    // Mix and inject the input. Nothing mixed in this chunk is read back within it, so
+    // the matrix is N * N multiply-adds across the chunk rather than a product per sample
+    for (size_t l = 0; l < N; ++l)
+    {
+        float *y = mixed[l];
+        const float sign = signs[l];
+        for (size_t i = 0; i < n; ++i)
+            y[i] = sign * input[i];
+        for (size_t k = 0; k < N; ++k)
+        {
+            const float gain = matrix[k][l];
+            const float *x = lanes[k];
+            for (size_t i = 0; i < n; ++i)
+                y[i] += gain * x[i];
+        }
+        delays[l].write(y, n);
+    }
+
+    if (!right)
+    {
+        for (size_t i = 0; i < n; ++i)
+            left[i] += mix * wet[i];
+        return;
+    }
+    const float level = 2.0f * mix;
+    for (size_t i = 0; i < n; ++i)
+    {
+        left[i] += level * wet[i];
+        right[i] += level * wetOdd[i];
+    }
+}
+
+void Reverb::buildMatrix()
+{
+    const size_t N = lines;
+    const float scale = 1.0f / std::sqrt(static_cast<float>(N));
+    for (size_t k = 0; k < N; ++k)
+    {
+        for (size_t l = 0; l < N; ++l)
+        {
+            if (matrixType == ReverbMatrix::Householder)
+            {
+                matrix[k][l] = (k == l ? 1.0f : 0.0f) - 2.0f / N;
+            }
+            else
+            {
+                // Sylvester construction: the sign is the parity of the bits k and l share
+                const bool negative = __builtin_popcount(static_cast<unsigned>(k & l)) & 1;
+                matrix[k][l] = negative ? -scale : scale;
+            }
+        }
+    }
+}
+
+void Reverb::settingChanged()
+{
+    try
+    {
+        decaySeconds = std::any_cast<float>(Setting);
+    }
+    catch (...)
+    {
+        decaySeconds = 2.0f; // Fallback decay
+    }
+
+    const size_t N = lines;
+    const float scale = 1.0f / std::sqrt(static_cast<float>(N));
+    const float rate = SampleRate / 44100.0f;
+    const float pole = std::min(std::max(damping, 0.0f), 1.0f) * 0.85f;
+    depth = std::min(std::max(modulationMs, 0.0f), MAX_MODULATION_MS) * 0.001f * SampleRate;
+    phaseStep = MODULATION_HZ * CHUNK / SampleRate;
+
+    for (size_t l = 0; l < N; ++l)
+    {
+        // Spread the 16 base lengths over the lines in use, so 8 lines still span the range
+        lengths[l] = std::max(BASE_LENGTHS[l * MAX_LINES / N] * std::min(std::max(size, 0.5f), MAX_SIZE) * rate,
+                              static_cast<float>(CHUNK + 1) + depth);
+        // -60 dB after decaySeconds: g^(seconds * rate / length) = 10^-3
+        const float gain = std::pow(10.0f, -3.0f * lengths[l] / (std::max(decaySeconds, 0.1f) * SampleRate));
+        poles[l] = pole;
+        feedforward[l] = gain * (1.0f - pole);
+        signs[l] = (l & 1 ? -scale : scale);
+    }
+    buildMatrix();
+}
+
+void Reverb::reset()
+{
+    for (DelayLine &line : delays)
+        line.clear();
+    std::fill(std::begin(state), std::end(state), 0.0f);
+    phase = 0.0f;
+}
+
+Reverb::~Reverb()
+{
+    std::cout << "[Reverb] Reverb destroyed cleanly\n";
+}
+
+void Reverb::parseConfig(const Config &config)
+{
+    IsActive = config.contains("reverb");
+    Setting = config.getNumber("reverb", 2.0f);
+    mix = std::max(config.getNumber("reverb_mix", 0.25f), 0.0f);
+    size = config.getNumber("reverb_size", 1.0f);
+    damping = config.getNumber("reverb_damping", 0.4f);
+    modulationMs = config.getNumber("reverb_modulation", 0.3f);
+    matrixType = parseMatrix(config.get<std::string>("reverb_matrix", "hadamard"));
+
+    const int requested = config.contains("reverb_lines") ? config.get<int>("reverb_lines", 8) : 8;
+    const size_t count = requested == 16 ? 16 : 8;
+    if (requested != 8 && requested != 16)
+        std::cerr << "[Reverb] Unsupported line count " << requested << ", using 8\n";
+    const bool rebuilt = count != lines;
+    lines = count;
+    settingChanged();
+    if (rebuilt)
+        reset(); // A different network: old tails would come out of the wrong lines
+}
+
+REGISTER_EFFECT_AUTO(Reverb);
@@ -0,0 +1,109 @@
+#pragma once
+#include <cstdint>
+#include "DelayLine.h"
+#include "Effect.h"
+#include "WavetableLFO.h"
+
+/**
+ * @brief Feedback matrix of a Reverb.
+ */
+enum class ReverbMatrix : uint8_t
+{
+    Hadamard,    ///< Dense +-1/sqrt(N): every line feeds every other equally
+    Householder, ///< I - 2/N: cheaper mixing, slower echo density build-up
+};
+
+/**
+ * @class Reverb
+ * @brief Feedback delay network (FDN) reverb with 8 or 16 lines.
+ *
+ * Each line is a DelayLine whose read delay is slowly modulated, followed
+ * by a per-line damping filter (a one-pole low-pass scaled so that every line
+ * decays by 60 dB in the configured time), then an orthogonal mixing matrix
+ * feeds every line back into all of them. The output taps the lines at
+ * alternating polarity.
+ *
+ * Work is done a CHUNK at a time, which is shorter than the shortest line, so
+ * every line's output for the chunk is already in its history and nothing
+ * fed back during the chunk is read within it. Each line is read with one
+ * span copy and a cubic at a fixed fractional delay (the LFO is sampled once
+ * per chunk), and the matrix becomes N * N multiply-adds along the chunk: every
+ * inner loop is contiguous and vectorises. All memory is allocated by
+ * prepare(), for the largest room at the stream's rate.
+ *
+ * In stereo the network is fed the mono fold of the input, and the left and
+ * right outputs tap the even and odd lines (at twice the gain, so that their
+ * mono fold is the mono output). One pass of the network serves both sides.
+ *
+ * Config: "reverb" (decay time in s), "reverb_mix" (wet level),
+ * "reverb_size" (0.5..2, scales the line lengths), "reverb_damping" (0..1),
+ * "reverb_lines" (8/16), "reverb_matrix" (hadamard/householder) and
+ * "reverb_modulation" (depth in ms).
+ */
+class Reverb : public Effect
+{
+public:
+    static constexpr const char *Name = "Reverb"; ///< Name in the effect registry
+    static constexpr size_t MAX_LINES = 16;
+    static constexpr size_t CHUNK = 32;           ///< Samples per pass; well below the shortest line
+
+    Reverb();
+    float process(float sample) override;
+    void processBlock(float *samples, size_t count) override;
+    ChannelLayout channelLayout() const override { return ChannelLayout::Stereo; }
+    void processChannels(float *const *channels, size_t channelCount, size_t frames) override;
+    void prepare(float sampleRate, size_t maxBlockSize, size_t channels) override;
+    void reset() override;
+    void release() override;
+    ~Reverb();
+
+    /**
+     * @brief Number of delay lines in use (8 or 16).
+     */
+    size_t lineCount() const { return lines; }
+
+    /**
+     * @brief Parses "hadamard" or "householder" (anything else is Hadamard).
+     */
+    static ReverbMatrix parseMatrix(const std::string &name);
+
+protected:
+    void parseConfig(const Config &config) override;
+    const char *configKey() const override { return "reverb"; }
+    void settingChanged() override;
+
+private:
+    /**
+     * @brief Runs the network over one chunk; `right` is nullptr for mono.
+     */
+    template <size_t N>
+    void processChunk(float *left, float *right, size_t n);
+    void buildMatrix();
+
+    float decaySeconds = 2.0f;   ///< Setting: RT60
+    float mix = 0.25f;
+    float size = 1.0f;
+    float damping = 0.4f;
+    float modulationMs = 0.3f;
+    ReverbMatrix matrixType = ReverbMatrix::Hadamard;
+    size_t lines = 8;
+
+    // Derived in settingChanged(), off the audio path
+    alignas(64) float matrix[MAX_LINES][MAX_LINES] = {}; ///< matrix[k] is column k
+    alignas(64) float lengths[MAX_LINES] = {};     ///< Line lengths in samples
+    alignas(64) float feedforward[MAX_LINES] = {}; ///< Damping input gain (decay gain times 1 - pole)
+    alignas(64) float poles[MAX_LINES] = {};       ///< Damping low-pass poles
+    alignas(64) float signs[MAX_LINES] = {};       ///< Input/output polarity per line, scaled by 1/sqrt(N)
+    float depth = 0.0f;                            ///< Modulation depth in samples
+    float phaseStep = 0.0f;                        ///< Modulation phase advance per chunk (cycles)
+
+    // Audio thread state
+    DelayLine delays[MAX_LINES];
+    alignas(64) float state[MAX_LINES] = {};       ///< Damping filter state
+    alignas(64) float lanes[MAX_LINES][CHUNK] = {}; ///< Each line's damped output for the chunk
+    alignas(64) float mixed[MAX_LINES][CHUNK] = {}; ///< Each line's input for the chunk
+    alignas(64) float wet[CHUNK] = {};              ///< Reverb output for the chunk (even lines in stereo)
+    alignas(64) float wetOdd[CHUNK] = {};           ///< Odd lines' output in stereo
+    alignas(64) float folded[CHUNK] = {};           ///< Mono fold of a stereo chunk
+    float phase = 0.0f;
+};
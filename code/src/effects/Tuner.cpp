@@ -0,0 +1,199 @@
+#include "Tuner.h"
+#include "EffectRegistration.h"
+#include "PitchDetector.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <pthread.h>
+#include <sched.h>
+
+namespace
+{
+    constexpr size_t READ_CHUNK = 512;  ///< Samples drained from the ring per detector push
+    constexpr int IDLE_WAIT_MS = 5;     ///< Sleep when the ring is empty (the audio thread never signals)
+    constexpr float MIN_HZ = 30.0f;     ///< Low B on a five-string bass
+    constexpr float MAX_HZ = 1000.0f;
+}
+
+Tuner::Tuner()
+{
+    IsActive = false;
+    Setting = 440.0f;
+}
+
+float Tuner::process(float sample)
+{
+    processBlock(&sample, 1);
+    return sample;
+}
+
+void Tuner::processBlock(float *samples, size_t count)
+{
+    processChannels(&samples, 1, count);
+}
+
+void Tuner::processChannels(float *const *channels, size_t channelCount, size_t frames)
+{
+    if (!IsActive)
+        return;
+
+    ring.write(Sidechain ? Sidechain : channels[0], frames);
+    for (size_t c = 0; mute && c < channelCount; ++c)
+        std::fill(channels[c], channels[c] + frames, 0.0f);
+}
+
+void Tuner::setListener(std::function<void(const TunerReading &)> newListener)
+{
+    std::lock_guard<std::mutex> lock(listenerMutex);
+    listener = std::move(newListener);
+}
+
+TunerReading Tuner::classify(float hz, float reference)
+{
+    TunerReading reading;
+    reading.reference = reference;
+    if (!(hz > 0.0f) || !(reference > 0.0f))
+        return reading;
+
+    const float semitones = 12.0f * std::log2(hz / reference);
+    const int offset = static_cast<int>(std::lround(semitones));
+    reading.hz = hz;
+    reading.note = 69 + offset;
+    reading.cents = 100.0f * (semitones - static_cast<float>(offset));
+    return reading;
+}
+
+void Tuner::start()
+{
+    if (running.load())
+        return;
+    if (ring.capacity() == 0)
+        ring.allocate(RING_SAMPLES);
+    running.store(true);
+    worker = std::thread(&Tuner::analyse, this);
+}
+
+void Tuner::prepare(float sampleRate, size_t maxBlockSize, size_t channels)
+{
+    const bool restart = sampleRate != SampleRate && running.load();
+    // The analysis thread reads the rate when it starts
+    if (restart)
+        stop();
+    Effect::prepare(sampleRate, maxBlockSize, channels);
+    if (restart)
+        start();
+}
+
+void Tuner::stop()
+{
+    if (!running.exchange(false))
+        return;
+    worker.join();
+}
+
+void Tuner::analyse()
+{
+    // Runs only when the cores are otherwise idle; failure (e.g. no SCHED_IDLE) just leaves it at normal priority
+    sched_param param{};
+    if (pthread_setschedparam(pthread_self(), SCHED_IDLE, &param) != 0)
+        std::cerr << "[Tuner] Could not lower the analysis thread's priority\n";
+
+    PitchDetector detector(SampleRate, DECIMATION, MIN_HZ, MAX_HZ);
+    float block[READ_CHUNK];
+
+    // Input left over from the last time the tuner was on
+    for (size_t stale = ring.size(); stale > 0;)
+        stale -= ring.read(block, std::min(stale, READ_CHUNK));
+
+    // Estimates of the same note between two displays are averaged to steady the needle
+    size_t lastEstimate = 0;
+    TunerReading shown;
+    float centsSum = 0.0f;
+    size_t averaged = 0;
+    bool fresh = false;
+    auto nextDisplay = std::chrono::steady_clock::now();
+
+    while (running.load(std::memory_order_acquire))
+    {
+        const size_t n = ring.read(block, READ_CHUNK);
+        if (n == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(IDLE_WAIT_MS));
+            continue;
+        }
+
+        detector.push(block, n);
+        if (detector.estimates() != lastEstimate)
+        {
+            lastEstimate = detector.estimates();
+            const TunerReading reading = classify(detector.frequency(), reference.load(std::memory_order_relaxed));
+            if (averaged == 0 || reading.note != shown.note)
+            {
+                shown = reading;
+                centsSum = 0.0f;
+                averaged = 0;
+            }
+            shown.hz = reading.hz;
+            shown.reference = reading.reference;
+            shown.clarity = detector.periodicity();
+            centsSum += reading.cents;
+            shown.cents = centsSum / static_cast<float>(++averaged);
+            fresh = true;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (fresh && now >= nextDisplay)
+        {
+            {
+                std::lock_guard<std::mutex> lock(listenerMutex);
+                if (listener)
+                    listener(shown);
+            }
+            averaged = 0;
+            fresh = false;
+            nextDisplay = now + std::chrono::milliseconds(DISPLAY_INTERVAL_MS);
+        }
+    }
+}
+
+void Tuner::settingChanged()
+{
+    float hz = 440.0f; // Fallback reference
+    try
+    {
+        hz = std::any_cast<float>(Setting);
+    }
+    catch (...)
+    {
+    }
+    reference.store(std::min(std::max(hz, 400.0f), 480.0f));
+}
+
+Tuner::~Tuner()
+{
+    stop();
+    std::cout << "[Tuner] Tuner destroyed cleanly\n";
+}
+
+void Tuner::parseConfig(const Config &config)
+{
+    const bool active = config.contains("tuner");
+    Setting = config.getNumber("tuner", 440.0f);
+    mute = config.get<bool>("tuner_mute", false);
+    settingChanged();
+
+    // The ring must exist before the audio thread can write to it
+    if (active)
+    {
+        start();
+        IsActive = true;
+    }
+    else
+    {
+        IsActive = false;
+        stop();
+    }
+}
+
+REGISTER_EFFECT_AUTO(Tuner);
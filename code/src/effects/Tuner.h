@@ -0,0 +1,98 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "Effect.h"
+#include "SpscRing.h"
+
+/**
+ * @struct TunerReading
+ * @brief Nearest equal-tempered note to a detected pitch and how far off it is.
+ */
+struct TunerReading
+{
+    float hz = 0.0f;          ///< Detected pitch, 0 when nothing is pitched
+    int note = -1;            ///< MIDI note number (69 = A4), -1 when nothing is pitched
+    float cents = 0.0f;       ///< Deviation from the note, -50..50
+    float clarity = 0.0f;     ///< PitchDetector periodicity, 0..1
+    float reference = 440.0f; ///< Pitch of A4 the note was measured against
+};
+
+/**
+ * @class Tuner
+ * @brief Chromatic tuner: taps the dry input for a low-priority analysis thread.
+ *
+ * The audio thread only copies each block into an SpscRing (and silences the
+ * output if muting). While the tuner is on, an analysis thread at the lowest
+ * scheduling priority drains the ring into a PitchDetector at a quarter of
+ * the sample rate and hands readings to a listener (the display), at most
+ * every DISPLAY_INTERVAL_MS. Nothing the thread does can hold up the audio
+ * thread; if it falls behind, the ring drops input instead.
+ *
+ * The tap is the chain's dry input (the sidechain), so the tuner hears the
+ * guitar wherever a route puts it (mono, folded if the input is stereo). It
+ * leaves the channels of the signal it is in as they are. The ring and thread
+ * exist only once the tuner has been switched on.
+ *
+ * Config: "tuner" (reference pitch of A4 in Hz) and "tuner_mute" (silence the
+ * output while tuning).
+ */
+class Tuner : public Effect
+{
+public:
+    static constexpr const char *Name = "Tuner"; ///< Name in the effect registry
+    static constexpr size_t DECIMATION = 4;       ///< Input samples per analysed sample
+    static constexpr size_t RING_SAMPLES = 16384; ///< About 0.37 s at 44.1 kHz
+    static constexpr int DISPLAY_INTERVAL_MS = 50;
+
+    Tuner();
+    float process(float sample) override;
+    void processBlock(float *samples, size_t count) override;
+    ChannelLayout channelLayout() const override { return ChannelLayout::Any; }
+    void processChannels(float *const *channels, size_t channelCount, size_t frames) override;
+    void prepare(float sampleRate, size_t maxBlockSize, size_t channels) override;
+    ~Tuner();
+
+    /**
+     * @brief Sets the function the analysis thread passes readings to (nullptr for none).
+     */
+    void setListener(std::function<void(const TunerReading &)> listener);
+
+    /**
+     * @brief Nearest note to a pitch and its deviation in cents.
+     * @param hz Pitch in Hz; 0 or less gives an unpitched reading.
+     * @param reference Pitch of A4.
+     */
+    static TunerReading classify(float hz, float reference);
+
+protected:
+    void parseConfig(const Config &config) override;
+    const char *configKey() const override { return "tuner"; }
+    void settingChanged() override;
+
+private:
+    /**
+     * @brief Starts the analysis thread (allocating the ring on first use) if it is not running.
+     */
+    void start();
+
+    /**
+     * @brief Stops and joins the analysis thread.
+     */
+    void stop();
+
+    /**
+     * @brief Analysis thread body.
+     */
+    void analyse();
+
+    std::atomic<float> reference{440.0f}; ///< Setting
+    bool mute = false;
+
+    SpscRing<float> ring;
+    std::thread worker;
+    std::atomic<bool> running{false};
+    std::mutex listenerMutex;
+    std::function<void(const TunerReading &)> listener;
+};
@@ -0,0 +1,224 @@
+#include "Waveshaper.h"
+#include "EffectRegistration.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+    // Below this spacing a divided difference loses too many digits; use its limit instead
+    constexpr double EPSILON = 1e-5;
+    constexpr float DC_POLE = 0.999f; // DC blocker corner, ~7 Hz at 44.1/48 kHz
+
+    double hardClip(double x) { return std::min(std::max(x, -1.0), 1.0); }
+    double diode(double x) { return x >= 0.0 ? 1.0 - std::exp(-x) : -0.5 * (1.0 - std::exp(2.0 * x)); }
+}
+
+Waveshaper::Waveshaper()
+{
+    IsActive = false;
+    Setting = 400.0f;
+    shape = &table(curve);
+}
+
+const ShaperTable &Waveshaper::table(ShaperCurve curve)
+{
+    static const ShaperTable hard(hardClip);
+    static const ShaperTable soft([](double x) { return std::tanh(x); });
+    static const ShaperTable asymmetric(diode);
+    switch (curve)
+    {
+    case ShaperCurve::HardClip:
+        return hard;
+    case ShaperCurve::Diode:
+        return asymmetric;
+    default:
+        return soft;
+    }
+}
+
+ShaperCurve Waveshaper::parseCurve(const std::string &name)
+{
+    if (name == "hardclip")
+        return ShaperCurve::HardClip;
+    if (name == "diode")
+        return ShaperCurve::Diode;
+    return ShaperCurve::Tanh;
+}
+
+float Waveshaper::process(float sample)
+{
+    processBlock(&sample, 1);
+    return sample;
+}
+
+void Waveshaper::processBlock(float *samples, size_t count)
+{
+    if (!IsActive)
+        return;
+
+    adoptShaping();
+    const ShaperTable &table = *shape;
+    for (size_t done = 0; done < count; done += CHUNK)
+    {
+        const size_t n = std::min(CHUNK, count - done);
+        float *block = samples + done;
+
+        for (size_t i = 0; i < n; ++i)
+            x[HISTORY + i] = static_cast<double>(drive * block[i]);
+
+        if (order == 1)
+            shapeFirstOrder(n);
+        else if (order == 2)
+            shapeSecondOrder(n);
+        else
+            for (size_t i = 0; i < n; ++i)
+                y[i] = table.f(x[HISTORY + i]);
+
+        if (curve == ShaperCurve::Diode)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                const float in = static_cast<float>(y[i]);
+                dcOut = in - dcIn + DC_POLE * dcOut;
+                dcIn = in;
+                block[i] = dcOut;
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < n; ++i)
+                block[i] = static_cast<float>(y[i]);
+        }
+
+        std::copy(x + n, x + n + HISTORY, x);
+        std::copy(F + n, F + n + HISTORY, F);
+        std::copy(D + n, D + n + HISTORY, D);
+    }
+}
+
+void Waveshaper::adoptShaping()
+{
+    if (!shapings.update())
+        return;
+    const Shaping &next = shapings.read();
+    if (next.curve == curve && next.order == order)
+        return; // A drive edit: the history still belongs to this curve
+
+    curve = next.curve;
+    order = next.order;
+    shape = next.shape;
+    // x and F were made for the old curve and order; a difference across them would spike
+    reset();
+}
+
+void Waveshaper::shapeFirstOrder(size_t n)
+{
+    const ShaperTable &table = *shape;
+    const double *xs = x + HISTORY;
+    double *Fs = F + HISTORY;
+
+    for (size_t i = 0; i < n; ++i)
+        Fs[i] = table.F1(xs[i]);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const double dx = xs[i] - xs[i - 1];
+        y[i] = (Fs[i] - Fs[i - 1]) / (std::abs(dx) < EPSILON ? 1.0 : dx);
+    }
+
+    // Limit as x[n-1] -> x[n]: f at the midpoint
+    for (size_t i = 0; i < n; ++i)
+        if (std::abs(xs[i] - xs[i - 1]) < EPSILON)
+            y[i] = table.f(0.5 * (xs[i] + xs[i - 1]));
+}
+
+void Waveshaper::shapeSecondOrder(size_t n)
+{
+    const ShaperTable &table = *shape;
+    const double *xs = x + HISTORY;
+    double *Fs = F + HISTORY;
+    double *Ds = D + HISTORY;
+
+    for (size_t i = 0; i < n; ++i)
+        Fs[i] = table.F2(xs[i]);
+
+    // D[n] = (F2(x[n]) - F2(x[n-1])) / (x[n] - x[n-1]), the first-order ADAA of F1
+    for (size_t i = 0; i < n; ++i)
+    {
+        const double dx = xs[i] - xs[i - 1];
+        Ds[i] = (Fs[i] - Fs[i - 1]) / (std::abs(dx) < EPSILON ? 1.0 : dx);
+    }
+    for (size_t i = 0; i < n; ++i)
+        if (std::abs(xs[i] - xs[i - 1]) < EPSILON)
+            Ds[i] = table.F1(0.5 * (xs[i] + xs[i - 1]));
+
+    // y[n] = 2 (D[n] - D[n-1]) / (x[n] - x[n-2])
+    for (size_t i = 0; i < n; ++i)
+    {
+        const double span = xs[i] - xs[i - 2];
+        y[i] = 2.0 * (Ds[i] - Ds[i - 1]) / (std::abs(span) < EPSILON ? 1.0 : span);
+    }
+
+    // Limit as x[n-2] -> x[n], expanded around their mean
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (std::abs(xs[i] - xs[i - 2]) >= EPSILON)
+            continue;
+        const double mean = 0.5 * (xs[i] + xs[i - 2]);
+        const double delta = xs[i - 1] - mean;
+        y[i] = std::abs(delta) < EPSILON
+                   ? table.f(0.5 * (mean + xs[i - 1]))
+                   : 2.0 / delta * ((table.F2(xs[i - 1]) - table.F2(mean)) / delta - table.F1(mean));
+    }
+}
+
+void Waveshaper::reset()
+{
+    std::fill(std::begin(x), std::end(x), 0.0);
+    std::fill(std::begin(F), std::end(F), 0.0);
+    std::fill(std::begin(D), std::end(D), 0.0);
+    dcIn = dcOut = 0.0f;
+}
+
+void Waveshaper::settingChanged()
+{
+    try
+    {
+        drive = 0.01f * std::any_cast<float>(Setting);
+    }
+    catch (...)
+    {
+        drive = 1.0f; // Fallback drive
+    }
+}
+
+Waveshaper::~Waveshaper()
+{
+    std::cout << "[Waveshaper] Waveshaper destroyed cleanly\n";
+}
+
+void Waveshaper::parseConfig(const Config &config)
+{
+    IsActive = config.contains("waveshaper");
+    Setting = config.get<float>("waveshaper", 400.0f);
+    settingChanged();
+
+    Shaping &next = shapings.writeBuffer();
+    next.curve = parseCurve(config.get<std::string>("waveshaper_curve", "tanh"));
+    next.shape = &table(next.curve);
+
+    const int requested = config.contains("waveshaper_adaa") ? config.get<int>("waveshaper_adaa", 1) : 1;
+    if (requested < 0 || requested > 2)
+    {
+        std::cerr << "[Waveshaper] Unsupported ADAA order " << requested << ", using 1\n";
+        next.order = 1;
+    }
+    else
+    {
+        next.order = requested;
+    }
+    shapings.publish();
+}
+
+REGISTER_EFFECT_AUTO(Waveshaper);
@@ -0,0 +1,100 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "Effect.h"
+#include "ShaperTable.h"
+#include "TripleBuffer.h"
+
+/**
+ * @brief Transfer curves offered by Waveshaper.
+ */
+enum class ShaperCurve : uint8_t
+{
+    HardClip, ///< clamp(x, -1, 1)
+    Tanh,     ///< Soft clip
+    Diode,    ///< Asymmetric: saturates at +1 and, harder, at -0.5
+};
+
+/**
+ * @class Waveshaper
+ * @brief Static distortion with antiderivative anti-aliasing (ADAA).
+ *
+ * Instead of evaluating the curve f at each sample, ADAA evaluates the average
+ * of f over the straight line between consecutive samples, which removes most
+ * of the aliasing without oversampling:
+ * - order 1: y[n] = (F1(x[n]) - F1(x[n-1])) / (x[n] - x[n-1]), half a sample of delay
+ * - order 2: the same idea applied twice with F2, one sample of delay
+ * - order 0: plain f(x), for comparison
+ * F1 and F2 come from a ShaperTable per curve. When consecutive inputs are too
+ * close for the division to be accurate the limit value is used instead; those
+ * samples are rare and are patched in a second pass, so the main loops stay
+ * branch-free.
+ *
+ * A new curve or ADAA order is published to the audio thread, which clears
+ * the history when it takes it, so no difference spans two curves.
+ *
+ * Config: "waveshaper" (drive in percent), "waveshaper_curve"
+ * (hardclip/tanh/diode) and "waveshaper_adaa" (0/1/2).
+ */
+class Waveshaper : public Effect
+{
+public:
+    static constexpr const char *Name = "Waveshaper"; ///< Name in the effect registry
+    static constexpr size_t CHUNK = 64;               ///< Samples shaped per pass
+
+    Waveshaper();
+    float process(float sample) override;
+    void processBlock(float *samples, size_t count) override;
+    void reset() override;
+    ~Waveshaper();
+
+    /**
+     * @brief Parses "hardclip", "tanh" or "diode" (anything else is Tanh).
+     */
+    static ShaperCurve parseCurve(const std::string &name);
+
+    /**
+     * @brief The shared table for a curve (built on first use).
+     */
+    static const ShaperTable &table(ShaperCurve curve);
+
+protected:
+    void parseConfig(const Config &config) override;
+    const char *configKey() const override { return "waveshaper"; }
+    void settingChanged() override;
+
+private:
+    /**
+     * @brief Curve and ADAA order, handed to the audio thread together
+     */
+    struct Shaping
+    {
+        ShaperCurve curve = ShaperCurve::Tanh;
+        int order = 1;                        ///< ADAA order (0, 1 or 2)
+        const ShaperTable *shape = nullptr;   ///< table(curve), looked up off the audio thread
+    };
+
+    /**
+     * @brief Audio thread: takes a published Shaping, clearing the history if the curve or order changed
+     */
+    void adoptShaping();
+
+    void shapeFirstOrder(size_t n);
+    void shapeSecondOrder(size_t n);
+
+    static constexpr size_t HISTORY = 2; ///< x[n-2] and x[n-1] are kept in front of each chunk
+
+    float drive = 4.0f;                   ///< Setting / 100, cached off the audio path
+    TripleBuffer<Shaping> shapings;       ///< Published by parseConfig()
+
+    // Audio thread state
+    ShaperCurve curve = ShaperCurve::Tanh;
+    int order = 1;
+    const ShaperTable *shape = nullptr;
+
+    double x[HISTORY + CHUNK] = {};       ///< Driven input, after the history
+    double F[HISTORY + CHUNK] = {};       ///< F1 (order 1) or F2 (order 2) of x
+    double D[HISTORY + CHUNK] = {};       ///< Order 2: divided differences of F2
+    double y[CHUNK] = {};                 ///< Shaped output
+    float dcIn = 0.0f, dcOut = 0.0f;      ///< DC blocker state (Diode only)
+};
@@ -40,19 +40,16 @@ void EncoderHandler::processEvent() {
         switch (int_flag_b) {
             case MCP23017Driver::ENC_PUSH[0]:
                 if (gpb_read & MCP23017Driver::ENC_PUSH[0]) {
-                    std::cout << "[EncHandler.cpp] button 1 pressed\n";
                     UIHandler::getInstance().handleEncoder(EncoderHandler::ENC_1, EncoderHandler::ENC_PUSH);
                 }
                 break;
             case MCP23017Driver::ENC_PUSH[1]:
                 if (gpb_read & MCP23017Driver::ENC_PUSH[1]) {
-                    std::cout << "[EncHandler.cpp] button 2 pressed\n";
                     UIHandler::getInstance().handleEncoder(EncoderHandler::ENC_2, EncoderHandler::ENC_PUSH);
                 }
                 break;
             case MCP23017Driver::ENC_PUSH[2]:
                 if (gpb_read & MCP23017Driver::ENC_PUSH[2]) {
-                    std::cout << "[EncHandler.cpp] button 3 pressed\n";
                     UIHandler::getInstance().handleEncoder(EncoderHandler::ENC_3, EncoderHandler::ENC_PUSH);
                 }
                 break;
@@ -64,30 +61,24 @@ void EncoderHandler::processEvent() {
             case MCP23017Driver::ENC_A[0]:
                 result = EncoderHandler::encoderRight(MCP23017Driver::ENC_NUM[0], gpa_read & MCP23017Driver::ENC_A[0], gpa_read & MCP23017Driver::ENC_B[0]);
                 if (result == EncoderHandler::ENC_LEFT) {
-                    std::cout << "[EncHandler.cpp] encoder 1 turned left\n";
                     UIHandler::getInstance().handleEncoder(EncoderHandler::ENC_1, EncoderHandler::ENC_LEFT);
                 } else if (result == EncoderHandler::ENC_RIGHT) {
-                    std::cout << "[EncHandler.cpp] encoder 1 turned right\n";
                     UIHandler::getInstance().handleEncoder(EncoderHandler::ENC_1, EncoderHandler::ENC_RIGHT);
                 }
                 break;
             case MCP23017Driver::ENC_A[1]:
                 result = EncoderHandler::encoderRight(MCP23017Driver::ENC_NUM[1], gpa_read & MCP23017Driver::ENC_A[1], gpa_read & MCP23017Driver::ENC_B[1]);
                 if (result == EncoderHandler::ENC_LEFT) {
-                    std::cout << "[EncHandler.cpp] encoder 2 turned left\n";
                     UIHandler::getInstance().handleEncoder(EncoderHandler::ENC_2, EncoderHandler::ENC_LEFT);
                 } else if (result == EncoderHandler::ENC_RIGHT) {
-                    std::cout << "[EncHandler.cpp] encoder 2 turned right\n";
                     UIHandler::getInstance().handleEncoder(EncoderHandler::ENC_2, EncoderHandler::ENC_RIGHT);
                 }
                 break;
             case MCP23017Driver::ENC_A[2]:
                 result = EncoderHandler::encoderRight(MCP23017Driver::ENC_NUM[2], gpa_read & MCP23017Driver::ENC_A[2], gpa_read & MCP23017Driver::ENC_B[2]);
                 if (result == EncoderHandler::ENC_LEFT) {
-                    std::cout << "[EncHandler.cpp] encoder 3 turned left\n";
                     UIHandler::getInstance().handleEncoder(EncoderHandler::ENC_3, EncoderHandler::ENC_LEFT);
                 } else if (result == EncoderHandler::ENC_RIGHT) {
-                    std::cout << "[EncHandler.cpp] encoder 3 turned right\n";
                     UIHandler::getInstance().handleEncoder(EncoderHandler::ENC_3, EncoderHandler::ENC_RIGHT);
                 }
                 break;
@@ -1,12 +1,20 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <iomanip>
 #include <thread>
 #include <csignal>
+#include <cstdlib>
+#include <sys/eventfd.h>
 #include <sys/signalfd.h>
+#include <poll.h>
+#include <cerrno>
 #include "DigitalSignalChain.h"
-#include "Sample.h"
-#include "EffectFactory.h"
+#include "EffectRegistry.h"
 #include "Config.h"
+#include "ConfigWatcher.h"
+#include "PresetBank.h"
 #include <gpiod.h>
 #include <stdio.h>
 #include <unistd.h>
@@ -14,32 +22,37 @@
 #include "ui/UIHandler.h" // Include UIHandler header
 #include "encoder_input/EncoderHandler.h"
 
-extern void ForceAllEffects();
 
-constexpr unsigned int SAMPLE_RATE = 44100;
-constexpr unsigned int FRAMES = 11;
-constexpr int BUFFER_SIZE = FRAMES; // Mono (1 channel), already interleaved
+constexpr size_t FRAMES = AudioIO::FRAMES;
+const std::string CONFIG_PATH = "./assets/config.cfg";
+const std::string PRESET_PATH = "./assets/presets.bin";
 MCP23017Driver MCP;
+std::atomic<unsigned int> deviceRate{0}; ///< Rate the audio device runs at, set by the audio loop
+std::atomic<bool> running{true};         ///< Cleared by SIGINT/SIGTERM to end the audio loop
 
-/**
- * @brief Processes a single audio sample through the DSP chain.
- *
- * @param sample The audio sample object.
- * @param dspChain The configured DSP chain.
- * @return The processed sample.
- */
-Sample processSample(Sample &sample, DigitalSignalChain &dspChain)
+void stopHandler(int)
 {
-    dspChain.applyEffects(sample);
-    return sample;
+    running.store(false);
 }
 
 /**
- * @brief Thread that blocks on SIGUSR1 using signalfd and triggers configuration reload.
+ * @brief Thread that waits for SIGUSR1 (via signalfd) or an edit of the config file
+ *        (via inotify) and applies the resulting configuration changes.
+ *
+ * File edits are re-parsed and diffed against the current state, so only effects
+ * whose keys changed are reconfigured. When the audio loop reports a new device
+ * rate (via an eventfd), the chain is prepared for it here, off the audio thread.
+ * Encoder edits are applied here too, so the input thread never waits on a
+ * reconfigure. A last eventfd ends the thread at shutdown.
  *
  * @param dspChain The digital signal chain to reconfigure.
+ * @param configPath The configuration file to watch.
+ * @param rateFd eventfd signalled by the audio loop when the device rate changes.
+ * @param editFd eventfd signalled by the UI after an encoder edit.
+ * @param stopFd eventfd signalled by stopConfigThread().
  */
-void configUpdateThread(DigitalSignalChain &dspChain)
+void configUpdateThread(DigitalSignalChain &dspChain, const std::string configPath, int rateFd, int editFd,
+                        int stopFd)
 {
     sigset_t mask;
     sigemptyset(&mask);
@@ -54,23 +67,145 @@ void configUpdateThread(DigitalSignalChain &dspChain)
 
     Config &config = Config::getInstance();
 
+    ConfigWatcher watcher(configPath);
+    if (!watcher.start())
+    {
+        std::cerr << "[ConfigThread] File watch unavailable, reload with SIGUSR1 only\n";
+    }
+
+    // poll() ignores negative descriptors, so a failed watcher simply never fires
+    struct pollfd fds[5] = {{sfd, POLLIN, 0},
+                            {watcher.fd(), POLLIN, 0},
+                            {rateFd, POLLIN, 0},
+                            {editFd, POLLIN, 0},
+                            {stopFd, POLLIN, 0}};
+
     while (true)
     {
-        struct signalfd_siginfo fdsi;
-        ssize_t s = read(sfd, &fdsi, sizeof(fdsi));
-        if (s != sizeof(fdsi))
-            continue;
+        if (poll(fds, 5, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("poll");
+            break;
+        }
 
-        std::cerr << "[ConfigThread] SIGUSR1 received. Reconfiguring effects...\n";
-        dspChain.configureEffects(config);
+        if (fds[4].revents & POLLIN)
+            break;
 
-        UIHandler::getInstance().update();
+        if (fds[0].revents & POLLIN)
+        {
+            struct signalfd_siginfo fdsi;
+            ssize_t s = read(sfd, &fdsi, sizeof(fdsi));
+            if (s == sizeof(fdsi))
+            {
+                std::cerr << "[ConfigThread] SIGUSR1 received. Reconfiguring effects...\n";
+                dspChain.configureEffects(config);
+
+                UIHandler::getInstance().update();
+            }
+        }
+
+        if ((fds[1].revents & POLLIN) && watcher.readEvents())
+        {
+            std::cerr << "[ConfigThread] " << configPath << " changed. Applying differences...\n";
+            if (config.loadFromFile(configPath))
+                dspChain.configureEffects(config);
+
+            UIHandler::getInstance().refreshFromConfig();
+        }
 
+        uint64_t changes = 0;
+        if ((fds[2].revents & POLLIN) && read(rateFd, &changes, sizeof(changes)) == sizeof(changes))
+        {
+            std::cerr << "[ConfigThread] Device rate changed. Preparing effects...\n";
+            dspChain.prepare(static_cast<float>(deviceRate.load()), FRAMES);
+        }
+
+        // Every edit since the last wake is already in the config: one pass applies them all
+        uint64_t edits = 0;
+        if ((fds[3].revents & POLLIN) && read(editFd, &edits, sizeof(edits)) == sizeof(edits))
+            dspChain.configureEffects(config);
     }
+
+    close(sfd);
 }
 
-int main()
+/**
+ * @brief Audio loop: brings the device back after a failed read or write. If it comes
+ *        back at another rate, the config thread is woken to prepare the chain for it;
+ *        the chain passes audio through unprocessed until it has.
+ *
+ * @param audio The audio device.
+ * @param rateFd eventfd the config thread waits on.
+ */
+void recoverAudio(AudioIO &audio, int rateFd)
 {
+    if (!audio.recover())
+    {
+        std::cerr << "[AudioIO] Audio device unavailable, retrying.\n";
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        return;
+    }
+
+    const unsigned int rate = audio.sampleRate();
+    if (deviceRate.exchange(rate) != rate)
+    {
+        const uint64_t change = 1;
+        if (write(rateFd, &change, sizeof(change)) != sizeof(change))
+            perror("eventfd");
+    }
+}
+
+/**
+ * @brief Wakes the config thread through its stop eventfd and waits for it to finish,
+ *        so nothing reconfigures the chain while it is being torn down.
+ *
+ * @param configThread The thread running configUpdateThread().
+ * @param stopFd eventfd the config thread waits on.
+ */
+void stopConfigThread(std::thread &configThread, int stopFd)
+{
+    const uint64_t stop = 1;
+    if (write(stopFd, &stop, sizeof(stop)) != sizeof(stop))
+        perror("eventfd");
+    configThread.join();
+}
+
+/**
+ * @brief Appends the settings in the config file to the preset bank as a new preset.
+ *
+ * @param name Name of the new preset.
+ * @return Process exit code.
+ */
+int savePreset(const std::string &name)
+{
+    Config &config = Config::getInstance();
+    if (!config.loadFromFile(CONFIG_PATH))
+        return 1;
+
+    PresetBank bank;
+    bank.load(PRESET_PATH); // A missing bank starts a new one
+    size_t index = bank.capture(name, config);
+    if (!bank.save(PRESET_PATH))
+        return 1;
+
+    std::cout << "[Presets] Saved \"" << name << "\" as preset " << index << " in " << PRESET_PATH << "\n";
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    // shred_pedal --save-preset <name>: snapshot config.cfg into the preset bank and exit
+    if (argc == 3 && std::string(argv[1]) == "--save-preset")
+        return savePreset(argv[2]);
+
+    // SHRED_DISPLAY=headless runs without the panel or the encoder interrupt, e.g. on a dev box;
+    // SHRED_DISPLAY_DUMP=<dir> then saves every frame shown there as a PBM
+    const char *displayMode = std::getenv("SHRED_DISPLAY");
+    const char *dumpDirectory = std::getenv("SHRED_DISPLAY_DUMP");
+    const bool headless = displayMode && std::string(displayMode) == "headless";
+
     // SET UP ENCODERS
     DigitalSignalChain dspChain;
     EncoderHandler encoder(&MCP);
@@ -78,9 +213,11 @@ int main()
 
     encoder.begin(800);
 
-    gpiopin.registerCallback(&encoder);
-    const int gpioPinNo = 27;
-	gpiopin.start(gpioPinNo);	
+    if (!headless) {
+        gpiopin.registerCallback(&encoder);
+        const int gpioPinNo = 27;
+        gpiopin.start(gpioPinNo);
+    }
 
     // Block SIGUSR1 in main and audio thread
     sigset_t mask;
@@ -88,8 +225,7 @@ int main()
     sigaddset(&mask, SIGUSR1);
     pthread_sigmask(SIG_BLOCK, &mask, nullptr);
 
-    std::cout << "[Init] Registering and loading effects...\n";
-    ForceAllEffects(); // Statically register all effects
+    std::cout << "[Init] " << EffectRegistry::count << " effect(s) registered\n";
 
     MCP23017Driver* mcpDriver = new MCP23017Driver();
     if (!mcpDriver->begin()) {
@@ -101,15 +237,32 @@ int main()
     std::cout << "[Init] Encoder handler initialized successfully.\n";
 
     // Launch configuration watcher thread
-    std::thread configThread(configUpdateThread, std::ref(dspChain));
+    const int rateFd = eventfd(0, EFD_NONBLOCK);
+    if (rateFd == -1)
+        perror("eventfd");
+    const int stopFd = eventfd(0, EFD_NONBLOCK);
+    if (stopFd == -1) {
+        perror("eventfd");
+        return 1;
+    }
+    std::thread configThread(configUpdateThread, std::ref(dspChain), CONFIG_PATH, rateFd,
+                             UIHandler::getInstance().configEditFd(), stopFd);
 
     // Load initial configuration file (optional)
     Config &config = Config::getInstance();
-    config.loadFromFile("./assets/config.cfg");
+    config.loadFromFile(CONFIG_PATH);
+
+    // Build every preset chain up front so switching never constructs effects
+    PresetBank presets;
+    if (presets.load(PRESET_PATH))
+        dspChain.loadPresets(presets);
+
     dspChain.configureEffects(config);
     UIHandler& uiHandler = UIHandler::getInstance();
-    if (!uiHandler.init(dspChain)) {
+    if (!uiHandler.init(dspChain, headless ? DisplayBackend::Headless : DisplayBackend::Panel,
+                        dumpDirectory ? dumpDirectory : "")) {
         std::cerr << "[Init] Failed to initialize UI handler.\n";
+        stopConfigThread(configThread, stopFd);
         return 1;
     }    
     // Audio I/O module
@@ -117,37 +270,77 @@ int main()
     if (!audio.init())
     {
         std::cerr << "[AudioIO] Failed to initialise audio device.\n";
+        stopConfigThread(configThread, stopFd);
+        uiHandler.stop();
         return 1;
     }
 
+    // Size every effect for the device before the first block
+    deviceRate.store(audio.sampleRate());
+    dspChain.prepare(static_cast<float>(audio.sampleRate()), FRAMES);
+
+    std::signal(SIGINT, stopHandler);
+    std::signal(SIGTERM, stopHandler);
     std::cout << "[Init] Starting real-time audio loop...\n";
 
-    int16_t buffer[BUFFER_SIZE];
+    // Interleaved on the device, planar through the chain
+    size_t inputChannels = std::min<size_t>(audio.captureChannels(), MAX_CHANNELS);
+    size_t outputChannels = std::min<size_t>(audio.playbackChannels(), MAX_CHANNELS);
+    int16_t buffer[FRAMES * MAX_CHANNELS];
+    float planes[MAX_CHANNELS][FRAMES];
+    float *channels[MAX_CHANNELS];
+    for (size_t c = 0; c < MAX_CHANNELS; ++c)
+    {
+        channels[c] = planes[c];
+    }
 
-    while (true)
+    while (running.load())
     {
         if (!audio.readBuffer(buffer))
         {
             std::cerr << "[AudioIO] Failed to read audio.\n";
+            recoverAudio(audio, rateFd);
+            inputChannels = std::min<size_t>(audio.captureChannels(), MAX_CHANNELS);
+            outputChannels = std::min<size_t>(audio.playbackChannels(), MAX_CHANNELS);
             continue;
         }
 
-        for (snd_pcm_uframes_t i = 0; i < BUFFER_SIZE; ++i)
+        // Whole period at once so parallel route branches can run on other cores.
+        // Effects work on [-1, 1] full scale; anything beyond it is clipped on the way out.
+        for (size_t c = 0; c < inputChannels; ++c)
+        {
+            for (size_t i = 0; i < FRAMES; ++i)
+                planes[c][i] = buffer[i * inputChannels + c] * (1.0f / 32768.0f);
+        }
+
+        dspChain.processBlock(channels, inputChannels, outputChannels, FRAMES);
+
+        for (size_t c = 0; c < outputChannels; ++c)
         {
-            Sample sample(buffer[i]);
-            buffer[i] = processSample(sample, dspChain).getPcmValue();
+            for (size_t i = 0; i < FRAMES; ++i)
+                buffer[i * outputChannels + c] = static_cast<int16_t>(std::clamp(planes[c][i], -1.0f, 1.0f) * 32767.0f);
         }
 
         if (!audio.writeBuffer(buffer))
         {
             std::cerr << "[AudioIO] Failed to write audio.\n";
+            recoverAudio(audio, rateFd);
+            inputChannels = std::min<size_t>(audio.captureChannels(), MAX_CHANNELS);
+            outputChannels = std::min<size_t>(audio.playbackChannels(), MAX_CHANNELS);
             continue;
         }
     }
 
+    // Nothing may touch the chain once it is released: the config thread and the UI stop first
+    std::cout << "[AudioIO] Audio loop stopped, shutting down.\n";
+    stopConfigThread(configThread, stopFd);
+    uiHandler.stop();
+    dspChain.release();
     audio.cleanup();
     delete mcpDriver;
-    configThread.join();
     gpiopin.stop();
+    close(stopFd);
+    if (rateFd != -1)
+        close(rateFd);
     return 0;
 }
\ No newline at end of file
@@ -5,9 +5,33 @@
 #include <typeindex>
 #include <any>
 #include <mutex>
+#include <tuple>
+#include <vector>
+#include <algorithm>
 
 std::atomic<Config *> Config::instance{nullptr};
 
+namespace
+{
+    // Compares two config values of the types produced by loadFromFile/UIHandler
+    bool sameValue(const std::any &a, const std::any &b)
+    {
+        if (a.type() != b.type())
+            return false;
+        if (!a.has_value())
+            return true;
+        if (a.type() == typeid(int))
+            return std::any_cast<int>(a) == std::any_cast<int>(b);
+        if (a.type() == typeid(float))
+            return std::any_cast<float>(a) == std::any_cast<float>(b);
+        if (a.type() == typeid(bool))
+            return std::any_cast<bool>(a) == std::any_cast<bool>(b);
+        if (a.type() == typeid(std::string))
+            return std::any_cast<const std::string &>(a) == std::any_cast<const std::string &>(b);
+        return false; // unknown type, treat as changed
+    }
+}
+
 Config::Config()
 {
     updated.store(false);
@@ -16,8 +40,8 @@ Config::Config()
 Config &Config::getInstance()
 {
     static Config singleton;
-    return singleton;
     instance.store(&singleton);
+    return singleton;
 }
 
 void Config::signalHandler(int sig)
@@ -39,17 +63,33 @@ void Config::registerSignalHandler()
 }
 
 void Config::set(const std::string &key, bool on, const std::any &value)
+{
+    apply(key, on, value);
+    updated.store(true);
+}
+
+bool Config::apply(const std::string &key, bool on, const std::any &value)
 {
     std::unique_lock lock(mutex);
-    if (on)
-    {
-        data[key] = Entry{true, value};
-    }
-    else
+    auto it = data.find(key);
+    if (it == data.end())
     {
-        data.erase(key);
+        if (!on)
+            return false; // disabling an unknown key changes nothing
+        data[key] = Entry{true, value, nextRevision++};
+        return true;
     }
-    updated.store(true);
+
+    // Disabled entries are kept (with their revision) so that effects can
+    // still detect the transition; get()/contains() ignore them.
+    Entry &entry = it->second;
+    if (entry.enabled == on && (!on || sameValue(entry.value, value)))
+        return false;
+
+    entry.enabled = on;
+    entry.value = value;
+    entry.revision = nextRevision++;
+    return true;
 }
 
 bool Config::contains(const std::string &key) const
@@ -59,6 +99,27 @@ bool Config::contains(const std::string &key) const
     return it != data.end() && it->second.enabled;
 }
 
+void Config::forEach(const std::function<void(const std::string &, bool, const std::any &)> &fn) const
+{
+    std::shared_lock lock(mutex);
+    for (const auto &[key, entry] : data)
+        fn(key, entry.enabled, entry.value);
+}
+
+uint64_t Config::revision(const std::string &key) const
+{
+    std::shared_lock lock(mutex);
+    uint64_t latest = 0;
+    for (const auto &[name, entry] : data)
+    {
+        if (name.compare(0, key.size(), key) != 0)
+            continue;
+        if (name.size() == key.size() || name[key.size()] == '_')
+            latest = std::max(latest, entry.revision);
+    }
+    return latest;
+}
+
 bool Config::hasUpdate() const
 {
     return updated.load();
@@ -86,6 +147,20 @@ T Config::get(const std::string &key, const T &defaultValue) const
     }
 }
 
+float Config::getNumber(const std::string &key, float defaultValue) const
+{
+    std::shared_lock lock(mutex);
+    auto it = data.find(key);
+    if (it == data.end() || !it->second.enabled)
+        return defaultValue;
+    const std::any &value = it->second.value;
+    if (value.type() == typeid(float))
+        return std::any_cast<float>(value);
+    if (value.type() == typeid(int))
+        return static_cast<float>(std::any_cast<int>(value));
+    return defaultValue;
+}
+
 bool Config::loadFromFile(const std::string &filename)
 {
     std::ifstream file(filename);
@@ -95,8 +170,9 @@ bool Config::loadFromFile(const std::string &filename)
         return false;
     }
 
-    std::cerr << "[Config] Loading initial config from: " << filename << "\n";
+    std::cerr << "[Config] Loading config from: " << filename << "\n";
 
+    std::vector<std::tuple<std::string, bool, std::any>> entries;
     std::string line;
     while (std::getline(file, line))
     {
@@ -157,10 +233,41 @@ bool Config::loadFromFile(const std::string &filename)
         {
             typedValue = value; // fallback to raw string
         }
-        std::cout << "[Config] Setting " << key << ": " << enabled << "\n";
-        set(key, enabled, typedValue);
+        entries.emplace_back(key, enabled, typedValue);
     }
 
+    // Diff against the current state so unchanged keys keep their revision
+    std::unordered_set<std::string> seen;
+    size_t changed = 0;
+    for (const auto &[key, enabled, value] : entries)
+    {
+        seen.insert(key);
+        if (apply(key, enabled, value))
+        {
+            std::cout << "[Config] Setting " << key << ": " << enabled << "\n";
+            ++changed;
+        }
+    }
+
+    std::unordered_set<std::string> previousKeys;
+    {
+        std::unique_lock lock(mutex);
+        previousKeys.swap(fileKeys);
+        fileKeys = seen;
+    }
+    for (const auto &key : previousKeys)
+    {
+        if (!seen.count(key) && apply(key, false, std::any{}))
+        {
+            std::cout << "[Config] Removed " << key << "\n";
+            ++changed;
+        }
+    }
+
+    std::cerr << "[Config] " << changed << " key(s) changed\n";
+    if (changed > 0)
+        updated.store(true);
+
     return true;
 }
 
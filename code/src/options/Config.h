@@ -8,23 +8,40 @@
 #include <atomic>
 #include <csignal>
 #include <any>
+#include <cstdint>
+#include <functional>
+#include <unordered_set>
 
 class Config
 {
 public:
+    // Standalone instance (e.g. a preset snapshot); the live config is getInstance()
+    Config();
+
     // Get singleton instance
     static Config &getInstance();
 
-    // Sets a configuration value (marks updated)
+    // Sets a configuration value (marks updated). The key's revision only
+    // advances when its enabled flag or value actually changes.
     void set(const std::string &key, bool on, const std::any &value);
 
     // Gets a configuration value with default fallback
     template <typename T>
     T get(const std::string &key, const T &defaultValue) const;
 
+    // Gets a number, which config.cfg may hold as an int or a float, with default fallback
+    float getNumber(const std::string &key, float defaultValue) const;
+
     // Returns true if key exists
     bool contains(const std::string &key) const;
 
+    // Calls fn(key, enabled, value) for every entry, including disabled ones
+    void forEach(const std::function<void(const std::string &, bool, const std::any &)> &fn) const;
+
+    // Latest revision of key and of any key namespaced under it ("key_*").
+    // Returns 0 if none of them has ever been set.
+    uint64_t revision(const std::string &key) const;
+
     // Whether configuration has been updated since last check
     bool hasUpdate() const;
 
@@ -34,11 +51,11 @@ public:
     // Register signal handler
     static void registerSignalHandler();
 
-    //Load values from .cfg file
+    // Load values from .cfg file. Only keys whose values differ from the current
+    // state are updated; keys dropped from the file since the last load are disabled.
     bool loadFromFile(const std::string &filename);
 
 private:
-    Config(); // Private constructor
     Config(const Config &) = delete;
     Config &operator=(const Config &) = delete;
 
@@ -46,14 +63,20 @@ private:
 
     static std::atomic<Config *> instance;
 
+    // Applies a value under the write lock, returns true if anything changed
+    bool apply(const std::string &key, bool on, const std::any &value);
+
     struct Entry
     {
         bool enabled = false;
         std::any value;
+        uint64_t revision = 0; ///< Bumped each time the entry changes
     };
 
     mutable std::shared_mutex mutex;
     std::unordered_map<std::string, Entry> data;
+    std::unordered_set<std::string> fileKeys; ///< Keys present in the last loaded file
+    uint64_t nextRevision = 1;
     std::atomic<bool> updated;
 };
 
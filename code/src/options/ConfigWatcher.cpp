@@ -0,0 +1,77 @@
+#include "ConfigWatcher.h"
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+ConfigWatcher::ConfigWatcher(const std::string &path)
+    : filePath(path)
+{
+    auto slash = path.find_last_of('/');
+    if (slash == std::string::npos)
+    {
+        directory = ".";
+        filename = path;
+    }
+    else
+    {
+        directory = slash == 0 ? "/" : path.substr(0, slash);
+        filename = path.substr(slash + 1);
+    }
+}
+
+ConfigWatcher::~ConfigWatcher()
+{
+    if (inotifyFd >= 0)
+        close(inotifyFd);
+}
+
+bool ConfigWatcher::start()
+{
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0)
+    {
+        std::cerr << "[ConfigWatcher] inotify_init1 failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    // IN_CLOSE_WRITE covers in-place saves, IN_MOVED_TO covers rename-over saves
+    watchDescriptor = inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (watchDescriptor < 0)
+    {
+        std::cerr << "[ConfigWatcher] Cannot watch " << directory << ": " << std::strerror(errno) << "\n";
+        close(inotifyFd);
+        inotifyFd = -1;
+        return false;
+    }
+
+    std::cout << "[ConfigWatcher] Watching " << filePath << "\n";
+    return true;
+}
+
+bool ConfigWatcher::readEvents()
+{
+    if (inotifyFd < 0)
+        return false;
+
+    bool changed = false;
+    alignas(inotify_event) char events[4096];
+
+    while (true)
+    {
+        ssize_t length = read(inotifyFd, events, sizeof(events));
+        if (length <= 0)
+            break; // EAGAIN: queue drained
+
+        for (char *ptr = events; ptr < events + length;)
+        {
+            const auto *event = reinterpret_cast<const inotify_event *>(ptr);
+            if (event->wd == watchDescriptor && event->len > 0 && filename == event->name)
+                changed = true;
+            ptr += sizeof(inotify_event) + event->len;
+        }
+    }
+
+    return changed;
+}
@@ -0,0 +1,58 @@
+#ifndef CONFIGWATCHER_H
+#define CONFIGWATCHER_H
+
+#include <string>
+
+/**
+ * @class ConfigWatcher
+ * @brief Watches a configuration file for modifications using inotify.
+ *
+ * The parent directory is watched rather than the file itself so that editors
+ * which save by writing a temporary file and renaming it over the original are
+ * still picked up. The descriptor is non-blocking and is meant to be polled
+ * alongside other descriptors (e.g. the SIGUSR1 signalfd) by the config thread.
+ */
+class ConfigWatcher
+{
+public:
+    /**
+     * @brief Constructs a watcher for the given file. Call start() to begin watching.
+     * @param path Path of the file to watch.
+     */
+    explicit ConfigWatcher(const std::string &path);
+    ~ConfigWatcher();
+
+    ConfigWatcher(const ConfigWatcher &) = delete;
+    ConfigWatcher &operator=(const ConfigWatcher &) = delete;
+
+    /**
+     * @brief Creates the inotify instance and adds the directory watch.
+     * @return true on success; false otherwise.
+     */
+    bool start();
+
+    /**
+     * @brief The inotify file descriptor, suitable for poll(), or -1 if not started.
+     */
+    int fd() const { return inotifyFd; }
+
+    /**
+     * @brief Drains all pending inotify events without blocking.
+     * @return true if any of them concerned the watched file.
+     */
+    bool readEvents();
+
+    /**
+     * @brief Path of the watched file.
+     */
+    const std::string &path() const { return filePath; }
+
+private:
+    std::string filePath;  ///< Full path as given
+    std::string directory; ///< Directory containing the file
+    std::string filename;  ///< File name within the directory
+    int inotifyFd = -1;
+    int watchDescriptor = -1;
+};
+
+#endif // CONFIGWATCHER_H
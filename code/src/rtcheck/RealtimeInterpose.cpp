@@ -0,0 +1,275 @@
+// RealtimeInterpose.cpp
+//
+// Linked into the checker build (cmake -DRT_SAFETY_CHECKS=ON) and the unit tests,
+// never into the pedal otherwise. Each function here takes the place of the C
+// library's, asks RealtimeCheck whether the calling thread is processing audio,
+// and then does the real work: the allocator through glibc's __libc_* entry
+// points, everything else through the next definition (dlsym(RTLD_NEXT)).
+#include <cerrno>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+#include <dlfcn.h>
+#include <new>
+#include <poll.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+#include <unistd.h>
+#include "RealtimeCheck.h"
+
+extern "C"
+{
+    void *__libc_malloc(size_t size);
+    void *__libc_calloc(size_t count, size_t size);
+    void *__libc_realloc(void *pointer, size_t size);
+    void *__libc_memalign(size_t alignment, size_t size);
+    void __libc_free(void *pointer);
+
+    void realtimeCheckInterposed() {}
+}
+
+namespace
+{
+    /**
+     * @brief The definition of `name` the interposed one hides, looked up once.
+     */
+    template <typename Function>
+    Function next(Function &cached, const char *name)
+    {
+        if (!cached)
+            cached = reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+        return cached;
+    }
+}
+
+#define REAL(function) next(real_##function, #function)
+#define DECLARE_REAL(function) decltype(&::function) real_##function = nullptr
+
+namespace
+{
+    DECLARE_REAL(pthread_mutex_lock);
+    DECLARE_REAL(pthread_cond_wait);
+    DECLARE_REAL(pthread_join);
+    DECLARE_REAL(sem_wait);
+    DECLARE_REAL(read);
+    DECLARE_REAL(write);
+    DECLARE_REAL(poll);
+    DECLARE_REAL(nanosleep);
+    DECLARE_REAL(usleep);
+    DECLARE_REAL(fwrite);
+    DECLARE_REAL(fputs);
+    DECLARE_REAL(fputc);
+    DECLARE_REAL(putc);
+    DECLARE_REAL(puts);
+    DECLARE_REAL(fflush);
+    DECLARE_REAL(vfprintf);
+
+    // Looked up before main, so the first call on the audio thread does not run the dynamic linker
+    __attribute__((constructor)) void resolveAll()
+    {
+        REAL(pthread_mutex_lock), REAL(pthread_cond_wait), REAL(pthread_join), REAL(sem_wait);
+        REAL(read), REAL(write), REAL(poll), REAL(nanosleep), REAL(usleep);
+        REAL(fwrite), REAL(fputs), REAL(fputc), REAL(putc), REAL(puts), REAL(fflush), REAL(vfprintf);
+    }
+}
+
+// === Allocation ===
+
+extern "C" void *malloc(size_t size) noexcept
+{
+    RealtimeCheck::check("malloc");
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size) noexcept
+{
+    RealtimeCheck::check("calloc");
+    return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *pointer, size_t size) noexcept
+{
+    RealtimeCheck::check("realloc");
+    return __libc_realloc(pointer, size);
+}
+
+extern "C" void *aligned_alloc(size_t alignment, size_t size) noexcept
+{
+    RealtimeCheck::check("aligned_alloc");
+    return __libc_memalign(alignment, size);
+}
+
+extern "C" int posix_memalign(void **pointer, size_t alignment, size_t size) noexcept
+{
+    RealtimeCheck::check("posix_memalign");
+    *pointer = __libc_memalign(alignment, size);
+    return *pointer ? 0 : ENOMEM;
+}
+
+extern "C" void free(void *pointer) noexcept
+{
+    if (pointer)
+        RealtimeCheck::check("free");
+    __libc_free(pointer);
+}
+
+void *operator new(size_t size)
+{
+    RealtimeCheck::check("operator new");
+    if (void *pointer = __libc_malloc(size ? size : 1))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    RealtimeCheck::check("operator new[]");
+    if (void *pointer = __libc_malloc(size ? size : 1))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept
+{
+    if (pointer)
+        RealtimeCheck::check("operator delete");
+    __libc_free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    if (pointer)
+        RealtimeCheck::check("operator delete[]");
+    __libc_free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+    operator delete(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept
+{
+    operator delete[](pointer);
+}
+
+// === Locks and waits ===
+
+extern "C" int pthread_mutex_lock(pthread_mutex_t *mutex) noexcept
+{
+    RealtimeCheck::check("pthread_mutex_lock");
+    return REAL(pthread_mutex_lock)(mutex);
+}
+
+extern "C" int pthread_cond_wait(pthread_cond_t *condition, pthread_mutex_t *mutex)
+{
+    RealtimeCheck::check("pthread_cond_wait");
+    return REAL(pthread_cond_wait)(condition, mutex);
+}
+
+extern "C" int pthread_join(pthread_t thread, void **result)
+{
+    RealtimeCheck::check("pthread_join");
+    return REAL(pthread_join)(thread, result);
+}
+
+extern "C" int sem_wait(sem_t *semaphore)
+{
+    RealtimeCheck::check("sem_wait");
+    return REAL(sem_wait)(semaphore);
+}
+
+// === Blocking system calls ===
+
+extern "C" ssize_t read(int fd, void *buffer, size_t size)
+{
+    RealtimeCheck::check("read");
+    return REAL(read)(fd, buffer, size);
+}
+
+extern "C" ssize_t write(int fd, const void *buffer, size_t size)
+{
+    RealtimeCheck::check("write");
+    return REAL(write)(fd, buffer, size);
+}
+
+extern "C" int poll(struct pollfd *fds, nfds_t count, int timeout)
+{
+    RealtimeCheck::check("poll");
+    return REAL(poll)(fds, count, timeout);
+}
+
+extern "C" int nanosleep(const struct timespec *duration, struct timespec *remaining)
+{
+    RealtimeCheck::check("nanosleep");
+    return REAL(nanosleep)(duration, remaining);
+}
+
+extern "C" int usleep(useconds_t microseconds)
+{
+    RealtimeCheck::check("usleep");
+    return REAL(usleep)(microseconds);
+}
+
+// === stdio (and iostream, which writes through it) ===
+
+extern "C" size_t fwrite(const void *data, size_t size, size_t count, FILE *stream)
+{
+    RealtimeCheck::check("fwrite");
+    return REAL(fwrite)(data, size, count, stream);
+}
+
+extern "C" int fputs(const char *text, FILE *stream)
+{
+    RealtimeCheck::check("fputs");
+    return REAL(fputs)(text, stream);
+}
+
+extern "C" int fputc(int c, FILE *stream)
+{
+    RealtimeCheck::check("fputc");
+    return REAL(fputc)(c, stream);
+}
+
+extern "C" int putc(int c, FILE *stream)
+{
+    RealtimeCheck::check("putc");
+    return REAL(putc)(c, stream);
+}
+
+extern "C" int puts(const char *text)
+{
+    RealtimeCheck::check("puts");
+    return REAL(puts)(text);
+}
+
+extern "C" int fflush(FILE *stream)
+{
+    RealtimeCheck::check("fflush");
+    return REAL(fflush)(stream);
+}
+
+extern "C" int vfprintf(FILE *stream, const char *format, va_list arguments)
+{
+    RealtimeCheck::check("vfprintf");
+    return REAL(vfprintf)(stream, format, arguments);
+}
+
+extern "C" int fprintf(FILE *stream, const char *format, ...)
+{
+    va_list arguments;
+    va_start(arguments, format);
+    const int written = vfprintf(stream, format, arguments);
+    va_end(arguments);
+    return written;
+}
+
+extern "C" int printf(const char *format, ...)
+{
+    va_list arguments;
+    va_start(arguments, format);
+    const int written = vfprintf(stdout, format, arguments);
+    va_end(arguments);
+    return written;
+}
@@ -2,13 +2,41 @@
 #include "AudioIO.h"
 #include <alsa/asoundlib.h>
 #include <iostream>
+#include <iterator>
 #include "Sample.h"
 
-constexpr unsigned int SAMPLE_RATE = 44100;
+constexpr unsigned int SAMPLE_RATES[] = {44100, 48000}; ///< Native rates tried in turn (the WM8960 is often clocked for 48 kHz)
 constexpr snd_pcm_format_t FORMAT = SND_PCM_FORMAT_S16_LE;
-constexpr unsigned int CHANNELS = 1;
-constexpr snd_pcm_uframes_t FRAMES = 11;
-constexpr int BUFFER_SIZE = FRAMES * CHANNELS;
+constexpr unsigned int CAPTURE_CHANNELS[] = {1, 2};  ///< A guitar is mono; some codecs only capture stereo
+constexpr unsigned int PLAYBACK_CHANNELS[] = {2, 1}; ///< Stereo effects want both sides
+
+bool AudioIO::configure(snd_pcm_t *handle, const unsigned int *preferred, size_t count, unsigned int rate,
+                        unsigned int &channels)
+{
+    // No soft resampling: the pedal runs at whatever rate the codec does
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (snd_pcm_set_params(handle, FORMAT, SND_PCM_ACCESS_RW_INTERLEAVED, preferred[i], rate, 0, 1000) >= 0)
+        {
+            channels = preferred[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+unsigned int AudioIO::currentRate(snd_pcm_t *handle)
+{
+    snd_pcm_hw_params_t *params = nullptr;
+    if (snd_pcm_hw_params_malloc(&params) < 0)
+        return 0;
+    unsigned int value = 0;
+    int direction = 0;
+    if (snd_pcm_hw_params_current(handle, params) < 0 || snd_pcm_hw_params_get_rate(params, &value, &direction) < 0)
+        value = 0;
+    snd_pcm_hw_params_free(params);
+    return value;
+}
 
 bool AudioIO::init()
 {
@@ -17,23 +45,64 @@ bool AudioIO::init()
     if (snd_pcm_open(&playbackHandle, "default", SND_PCM_STREAM_PLAYBACK, 0) < 0)
         return false;
 
-    if (snd_pcm_set_params(captureHandle, FORMAT, SND_PCM_ACCESS_RW_INTERLEAVED,
-                           CHANNELS, SAMPLE_RATE, 1, 1000) < 0)
-        return false;
-    if (snd_pcm_set_params(playbackHandle, FORMAT, SND_PCM_ACCESS_RW_INTERLEAVED,
-                           CHANNELS, SAMPLE_RATE, 1, 1000) < 0)
+    // Both directions at the same rate, the first one both accept
+    unsigned int requested = 0;
+    for (unsigned int candidate : SAMPLE_RATES)
+    {
+        if (configure(captureHandle, CAPTURE_CHANNELS, std::size(CAPTURE_CHANNELS), candidate, inputChannels) &&
+            configure(playbackHandle, PLAYBACK_CHANNELS, std::size(PLAYBACK_CHANNELS), candidate, outputChannels))
+        {
+            requested = candidate;
+            break;
+        }
+    }
+    if (requested == 0)
         return false;
+
+    rate = currentRate(captureHandle);
+    if (rate == 0)
+        rate = requested;
+    const unsigned int playbackRate = currentRate(playbackHandle);
+    if (playbackRate != 0 && playbackRate != rate)
+        std::cerr << "[AudioIO] Playback runs at " << playbackRate << " Hz, capture at " << rate << " Hz\n";
+
+    captureError = playbackError = 0;
+    std::cout << "[AudioIO] Capturing " << inputChannels << " channel(s), playing " << outputChannels << ", at "
+              << rate << " Hz\n";
     return true;
 }
 
 bool AudioIO::readBuffer(int16_t *buffer)
 {
-    return snd_pcm_readi(captureHandle, buffer, FRAMES) >= 0;
+    if (!captureHandle)
+        return false;
+    const snd_pcm_sframes_t read = snd_pcm_readi(captureHandle, buffer, FRAMES);
+    captureError = read < 0 ? static_cast<int>(read) : 0;
+    return read >= 0;
 }
 
 bool AudioIO::writeBuffer(int16_t *buffer)
 {
-    return snd_pcm_writei(playbackHandle, buffer, FRAMES) >= 0;
+    if (!playbackHandle)
+        return false;
+    const snd_pcm_sframes_t written = snd_pcm_writei(playbackHandle, buffer, FRAMES);
+    playbackError = written < 0 ? static_cast<int>(written) : 0;
+    return written >= 0;
+}
+
+bool AudioIO::recover()
+{
+    if (captureHandle && playbackHandle)
+    {
+        const bool captureBack = captureError == 0 || snd_pcm_recover(captureHandle, captureError, 1) >= 0;
+        const bool playbackBack = playbackError == 0 || snd_pcm_recover(playbackHandle, playbackError, 1) >= 0;
+        captureError = playbackError = 0;
+        if (captureBack && playbackBack)
+            return true;
+        std::cerr << "[AudioIO] Recovery failed, reopening the devices\n";
+    }
+    cleanup();
+    return init();
 }
 
 void AudioIO::cleanup()
@@ -42,4 +111,6 @@ void AudioIO::cleanup()
         snd_pcm_close(captureHandle);
     if (playbackHandle)
         snd_pcm_close(playbackHandle);
+    captureHandle = nullptr;
+    playbackHandle = nullptr;
 }
@@ -11,10 +11,19 @@
  *
  * This class abstracts the setup, capture, and playback of audio samples using
  * the ALSA API. It is designed for real-time applications with low latency requirements.
+ *
+ * Each device is opened with the first channel count it accepts: capture
+ * prefers mono (one guitar), playback prefers stereo. Buffers are interleaved.
+ *
+ * The devices run at a rate they support natively (44.1 kHz, else 48 kHz)
+ * rather than through ALSA's resampler; sampleRate() reports the rate they
+ * actually run at, which the effects must be prepared for.
  */
 class AudioIO
 {
 public:
+    static constexpr snd_pcm_uframes_t FRAMES = 11; ///< Frames per read/write
+
     /**
      * @brief Initializes the ALSA capture and playback devices with predefined parameters.
      * @return true if initialization succeeds; false otherwise.
@@ -23,26 +32,66 @@ public:
 
     /**
      * @brief Reads a block of audio samples from the ALSA capture device.
-     * @param buffer A pointer to an int16_t buffer to store the input samples.
+     * @param buffer A pointer to an int16_t buffer of FRAMES * captureChannels() interleaved samples.
      * @return true if samples were successfully read; false otherwise.
      */
     bool readBuffer(int16_t *buffer);
 
     /**
      * @brief Writes a block of audio samples to the ALSA playback device.
-     * @param buffer A pointer to an int16_t buffer containing the output samples.
+     * @param buffer A pointer to an int16_t buffer of FRAMES * playbackChannels() interleaved samples.
      * @return true if samples were successfully written; false otherwise.
      */
     bool writeBuffer(int16_t *buffer);
 
+    /**
+     * @brief Brings the devices back after a failed read or write (e.g. an overrun),
+     *        reopening them if recovery fails; the rate may differ afterwards.
+     * @return false if the devices could not be restored.
+     */
+    bool recover();
+
+    /**
+     * @brief Rate the capture device runs at, in Hz.
+     */
+    unsigned int sampleRate() const { return rate; }
+
+    /**
+     * @brief Channels the capture device was opened with.
+     */
+    unsigned int captureChannels() const { return inputChannels; }
+
+    /**
+     * @brief Channels the playback device was opened with.
+     */
+    unsigned int playbackChannels() const { return outputChannels; }
+
     /**
      * @brief Closes the ALSA capture and playback devices safely.
      */
     void cleanup();
 
 private:
+    /**
+     * @brief Sets the device up at `rate` with the first of `count` preferred channel counts it accepts.
+     * @param channels Receives the channel count used.
+     * @return false if it accepts none of them.
+     */
+    static bool configure(snd_pcm_t *handle, const unsigned int *preferred, size_t count, unsigned int rate,
+                          unsigned int &channels);
+
+    /**
+     * @brief Rate the device was actually set to (0 if it cannot be read back).
+     */
+    static unsigned int currentRate(snd_pcm_t *handle);
+
     snd_pcm_t *captureHandle = nullptr;  ///< ALSA handle for the capture device.
     snd_pcm_t *playbackHandle = nullptr; ///< ALSA handle for the playback device.
+    unsigned int inputChannels = 1;      ///< Channels of the capture device.
+    unsigned int outputChannels = 1;     ///< Channels of the playback device.
+    unsigned int rate = 0;               ///< Rate of the capture device.
+    int captureError = 0;                ///< Last failed read (negative errno), 0 if none.
+    int playbackError = 0;               ///< Last failed write (negative errno), 0 if none.
 };
 
 #endif // AUDIO_IO_H
@@ -5,6 +5,7 @@ Sample::Sample(float inValue)
 {
     //std::cout << "[Sample] Initilialising with value: " << inValue << "\n";
     this->pcmValue = inValue;
+    appliedEffects.reserve(MAX_TAGS);
 }
 
 float Sample::getPcmValue() const
@@ -7,10 +7,16 @@
 /**
  * @class Sample
  * @brief Represents a PCM sample, its timestamp, and a history of applied effects.
+ *
+ * The history is tagged on the audio thread, so room for MAX_TAGS names is
+ * reserved when the sample is made; effect names are short enough to be
+ * stored without allocating.
  */
 class Sample
 {
 public:
+    static constexpr size_t MAX_TAGS = 16; ///< Effects that can be tagged without allocating
+
     /**
      * @brief Constructor for Sample.
      * @param inValue The PCM value of the sample.
@@ -1,13 +1,22 @@
 #include "MockOutputModule.h"
 #include <iostream>
 
-MockOutputModule::MockOutputModule(const std::string& outputPath)
-    : outputPath(outputPath) {}
+MockOutputModule::MockOutputModule(const std::string& outputPath, int channels, int sampleRate)
+    : outputPath(outputPath), numChannels(channels), rate(sampleRate) {}
 
 void MockOutputModule::writeSample(const Sample& sample) {
     pcmSamples.push_back(sample.getPcmValue());
 }
 
+void MockOutputModule::writeFrames(const float* const* channels, std::size_t frames) {
+    // Interleave
+    for (std::size_t i = 0; i < frames; ++i) {
+        for (int ch = 0; ch < numChannels; ++ch) {
+            pcmSamples.push_back(channels[ch][i]);
+        }
+    }
+}
+
 void MockOutputModule::saveToFile() {
     if (pcmSamples.empty()) {
         std::cerr << "[MockOutputModule] No samples to write.\n";
@@ -15,8 +24,8 @@ void MockOutputModule::saveToFile() {
     }
 
     SF_INFO sfinfo = {};
-    sfinfo.samplerate = 44100; // Default rate
-    sfinfo.channels = 1;       // Mono output
+    sfinfo.samplerate = rate;
+    sfinfo.channels = numChannels;
     sfinfo.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
 
     SNDFILE* file = sf_open(outputPath.c_str(), SFM_WRITE, &sfinfo);
@@ -9,16 +9,19 @@
  * @class MockOutputModule
  * @brief A mock audio output module that collects processed samples and writes them to a WAV file.
  *
- * This class buffers samples written to it and writes them to disk as a single-channel 44.1 kHz
- * floating-point WAV file when `saveToFile()` is called. It is useful for offline testing of DSP chains.
+ * This class buffers samples written to it and writes them to disk as a floating-point
+ * WAV file (mono at 44.1 kHz unless told otherwise) when `saveToFile()` is called. It is useful for
+ * offline testing of DSP chains.
  */
 class MockOutputModule {
 public:
     /**
      * @brief Constructs the output module with the target file path.
      * @param outputPath Path to write the final WAV file to.
+     * @param channels Channels of the WAV file.
+     * @param sampleRate Rate of the WAV file in Hz.
      */
-    MockOutputModule(const std::string& outputPath);
+    MockOutputModule(const std::string& outputPath, int channels = 1, int sampleRate = 44100);
 
     /**
      * @brief Buffers a single audio sample.
@@ -26,14 +29,23 @@ public:
      */
     void writeSample(const Sample& sample);
 
+    /**
+     * @brief Buffers a block of frames given as one plane per channel.
+     * @param channels One plane of `frames` samples for each of the module's channels.
+     * @param frames Number of frames.
+     */
+    void writeFrames(const float* const* channels, std::size_t frames);
+
     /**
      * @brief Writes all buffered samples to a WAV file.
      *
-     * The output will be saved as a mono, 44.1 kHz, 32-bit float WAV file.
+     * The output will be saved as a 32-bit float WAV file at the module's rate.
      */
     void saveToFile();
 
 private:
-    std::vector<float> pcmSamples; ///< Buffer of raw PCM sample values
+    std::vector<float> pcmSamples; ///< Buffer of raw PCM sample values, interleaved
     std::string outputPath;        ///< Destination file path for output WAV
+    int numChannels;               ///< Channels per frame
+    int rate;                      ///< Sample rate of the WAV file in Hz
 };
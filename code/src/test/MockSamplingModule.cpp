@@ -1,4 +1,5 @@
 #include "MockSamplingModule.h"
+#include <algorithm>
 #include <iostream>
 
 MockSamplingModule::MockSamplingModule(const std::string& filePath) {
@@ -11,6 +12,7 @@ MockSamplingModule::MockSamplingModule(const std::string& filePath) {
     }
 
     numChannels = sfinfo.channels;
+    rate = sfinfo.samplerate;
     std::size_t totalSamples = sfinfo.frames * numChannels;
 
     samples.resize(totalSamples);
@@ -39,3 +41,16 @@ bool MockSamplingModule::getSample(float& outSample) {
 
     return true;
 }
+
+std::size_t MockSamplingModule::getFrames(float* const* channels, std::size_t frames) {
+    const std::size_t available = (samples.size() - sampleIndex) / numChannels;
+    const std::size_t count = std::min(frames, available);
+
+    // Deinterleave
+    for (std::size_t i = 0; i < count; ++i) {
+        for (int ch = 0; ch < numChannels; ++ch) {
+            channels[ch][i] = samples[sampleIndex++];
+        }
+    }
+    return count;
+}
@@ -6,10 +6,11 @@
 
 /**
  * @class MockSamplingModule
- * @brief A simple WAV file reader that provides sample-by-sample access to mono audio.
+ * @brief A simple WAV file reader that provides sample-by-sample or planar block access to audio.
  *
  * This class loads a WAV file into memory and exposes an interface for retrieving audio samples
- * one at a time (downmixed to mono if needed). It is primarily intended for offline or test scenarios.
+ * one at a time (downmixed to mono if needed) or blocks of frames with every channel kept.
+ * It is primarily intended for offline or test scenarios.
  */
 class MockSamplingModule {
 public:
@@ -26,6 +27,24 @@ public:
      */
     bool getSample(float& outSample);
 
+    /**
+     * @brief Retrieves the next frames, one plane per channel.
+     * @param channels channels() planes of at least `frames` samples.
+     * @param frames Most frames to read.
+     * @return Frames read; 0 at the end of the file.
+     */
+    std::size_t getFrames(float* const* channels, std::size_t frames);
+
+    /**
+     * @brief Number of channels in the WAV file.
+     */
+    int channels() const { return numChannels; }
+
+    /**
+     * @brief Sample rate of the WAV file in Hz.
+     */
+    int sampleRate() const { return rate; }
+
 private:
     /**
      * @brief Loads the WAV file into memory and stores samples internally.
@@ -35,4 +54,5 @@ private:
     std::vector<float> samples;   ///< Interleaved sample buffer
     std::size_t sampleIndex = 0; ///< Index of the next sample to output
     int numChannels = 0;         ///< Number of channels in the original WAV file
+    int rate = 44100;            ///< Sample rate of the original WAV file
 };
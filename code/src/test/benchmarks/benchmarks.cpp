@@ -0,0 +1,1064 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <sndfile.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Chorus.h"
+#include "Delay.h"
+#include "DigitalSignalChain.h"
+#include "EQ.h"
+#include "PresetBank.h"
+#include "Reverb.h"
+#include "Tuner.h"
+#include "Sample.h"
+#include "Config.h"
+#include "Convolver.h"
+#include "FusedChains.h"
+#include "PartitionedConvolution.h"
+#include "PitchDetector.h"
+#include "Limiter.h"
+#include "Looper.h"
+#include "NoiseGate.h"
+#include "Oversampler.h"
+#include "Waveshaper.h"
+#include "ui/DEV_Config.h"
+#include "ui/Display.h"
+#include "ui/SSD1305.h"
+
+// --- Heap accounting: counts bytes requested through operator new while enabled ---
+
+namespace
+{
+    std::atomic<size_t> allocatedBytes{0};
+    std::atomic<bool> trackAllocations{false};
+}
+
+void *operator new(std::size_t size)
+{
+    if (trackAllocations.load(std::memory_order_relaxed))
+        allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr float SAMPLE_RATE = 44100.0f;
+    volatile float sink = 0.0f; ///< Keeps results observable so loops are not optimised away
+
+    double elapsedNs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+
+    float testSignal(size_t i)
+    {
+        return 0.5f * std::sin(2.0f * static_cast<float>(M_PI) * 440.0f * i / SAMPLE_RATE);
+    }
+
+    // Average cost of one applyEffects() call over `count` samples
+    double nsPerSample(DigitalSignalChain &chain, size_t count, size_t offset = 0)
+    {
+        auto start = Clock::now();
+        for (size_t i = 0; i < count; ++i)
+        {
+            Sample sample(testSignal(offset + i));
+            chain.applyEffects(sample);
+            sink = sample.getPcmValue();
+        }
+        return elapsedNs(start) / count;
+    }
+
+    // Average per-sample cost of processBlock() over `blocks` blocks of `frames`
+    double nsPerBlockSample(DigitalSignalChain &chain, size_t blocks, size_t frames)
+    {
+        std::vector<float> block(frames);
+        double total = 0.0;
+        for (size_t b = 0; b < blocks; ++b)
+        {
+            for (size_t i = 0; i < frames; ++i)
+                block[i] = testSignal(b * frames + i);
+            auto start = Clock::now();
+            chain.processBlock(block.data(), frames);
+            total += elapsedNs(start);
+            sink = block[0];
+        }
+        return total / (blocks * frames);
+    }
+
+    // --- Routing: serial vs parallel branches, per-sample vs block processing ---
+
+    void benchRouting()
+    {
+        Config &config = Config::getInstance();
+        config.set("gain", true, 120.0f);
+        config.set("fuzz", true, 20.0f);
+        config.set("harmonizer", true, std::string("4 7"));
+
+        const char *routes[] = {"gain fuzz harmonizer", "gain [fuzz | harmonizer]"};
+
+        std::printf("Routing (period of 11 and 256 frames)\n");
+        for (const char *route : routes)
+        {
+            DigitalSignalChain chain;
+            config.set("route", true, std::string(route));
+            chain.configureEffects(config);
+            nsPerBlockSample(chain, 200, 256); // warm up
+
+            const double perSample = nsPerSample(chain, 44100);
+            const double period = nsPerBlockSample(chain, 4000, 11);
+            const double block = nsPerBlockSample(chain, 200, 256);
+            std::printf("  %-26s applyEffects %7.1f | block(11) %7.1f | block(256) %7.1f ns/sample, %zu helper thread(s)\n",
+                        route, perSample, period, block, chain.helperThreads());
+        }
+        config.set("route", false, std::string(""));
+    }
+
+    // --- Fused static chain vs the same effects run dynamically ---
+
+    void benchStaticChain()
+    {
+        Config config;
+        config.set("gain", true, 300.0f);
+        config.set("fuzz", true, 50.0f);
+
+        auto gain = std::make_shared<Gain>();
+        auto fuzz = std::make_shared<Fuzz>();
+        GainFuzz fused;
+        gain->configure(config);
+        fuzz->configure(config);
+        fused.configure(config);
+        Effect *effects[] = {gain.get(), fuzz.get()};
+
+        constexpr size_t frames = 256;
+        constexpr size_t blocks = 20000;
+        std::vector<float> input(frames), block(frames);
+        for (size_t i = 0; i < frames; ++i)
+            input[i] = testSignal(i);
+
+        auto timeBlocks = [&](const std::function<void(float *)> &process) {
+            double total = 0.0;
+            for (size_t b = 0; b < blocks; ++b)
+            {
+                std::copy(input.begin(), input.end(), block.begin());
+                auto start = Clock::now();
+                process(block.data());
+                total += elapsedNs(start);
+                sink = block[b % frames];
+            }
+            return total / (blocks * frames);
+        };
+
+        const double virtualPerSample = timeBlocks([&](float *data) {
+            for (size_t i = 0; i < frames; ++i)
+                for (Effect *effect : effects)
+                    data[i] = effect->process(data[i]);
+        });
+        const double perEffectBlocks = timeBlocks([&](float *data) {
+            for (Effect *effect : effects)
+                effect->processBlock(data, frames);
+        });
+        const double fusedBlock = timeBlocks([&](float *data) { fused.processBlock(data, frames); });
+
+        std::printf("StaticChain<Gain, Fuzz> (%zu-frame blocks)\n", frames);
+        std::printf("  virtual process() per sample: %6.2f ns/sample\n", virtualPerSample);
+        std::printf("  processBlock() per effect:    %6.2f ns/sample\n", perEffectBlocks);
+        std::printf("  fused StaticChain:            %6.2f ns/sample\n", fusedBlock);
+
+        // Same comparison through DigitalSignalChain: "gain fuzz" is fused, "fuzz gain" is not
+        Config &live = Config::getInstance();
+        live.set("gain", true, 300.0f);
+        live.set("fuzz", true, 50.0f);
+        live.set("harmonizer", false, std::string("0"));
+        for (const char *route : {"fuzz gain", "gain fuzz"})
+        {
+            DigitalSignalChain chain;
+            live.set("route", true, std::string(route));
+            chain.configureEffects(live);
+            std::printf("  chain route \"%s\":%*s%6.2f ns/sample\n", route, static_cast<int>(15 - std::strlen(route)), "",
+                        nsPerBlockSample(chain, blocks, frames));
+        }
+        live.set("route", false, std::string(""));
+    }
+
+    // --- Oversampled Fuzz: aliasing and CPU per factor ---
+
+    // Ratio of harmonic power to everything else (aliases) for a periodic signal whose
+    // fundamental sits exactly on DFT bin `fundamental`, in dB
+    double signalToAliasDb(const std::vector<float> &signal, size_t fundamental)
+    {
+        const size_t n = signal.size();
+        std::vector<double> cosTable(n), sinTable(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            cosTable[i] = std::cos(2.0 * M_PI * i / n);
+            sinTable[i] = std::sin(2.0 * M_PI * i / n);
+        }
+
+        double harmonics = 0.0, aliases = 0.0;
+        for (size_t k = 1; k < n / 2; ++k)
+        {
+            double re = 0.0, im = 0.0;
+            for (size_t i = 0, phase = 0; i < n; ++i, phase = (phase + k) % n)
+            {
+                re += signal[i] * cosTable[phase];
+                im -= signal[i] * sinTable[phase];
+            }
+            const double power = re * re + im * im;
+            (k % fundamental == 0 ? harmonics : aliases) += power;
+        }
+        return 10.0 * std::log10(harmonics / std::max(aliases, 1e-30));
+    }
+
+    constexpr size_t ALIAS_ANALYSIS = 4096;
+    constexpr size_t ALIAS_FUNDAMENTAL = 373; // ~4 kHz; prime, so aliases miss the harmonic bins
+
+    /**
+     * @brief Signal-to-alias ratio of a distortion on a 4 kHz sine at 0.5, and its cost in ns/sample.
+     */
+    void measureDistortion(Effect &effect, double &aliasDb, double &nsPerSample)
+    {
+        constexpr size_t frames = 256;
+
+        // The sine repeats every ALIAS_ANALYSIS samples, so after settling so does the output
+        std::vector<float> signal(3 * ALIAS_ANALYSIS);
+        for (size_t i = 0; i < signal.size(); ++i)
+            signal[i] = 0.5f * std::sin(2.0 * M_PI * ALIAS_FUNDAMENTAL * (i % ALIAS_ANALYSIS) / ALIAS_ANALYSIS);
+        for (size_t i = 0; i < signal.size(); i += frames)
+            effect.processBlock(signal.data() + i, frames);
+        aliasDb = signalToAliasDb(std::vector<float>(signal.end() - ALIAS_ANALYSIS, signal.end()), ALIAS_FUNDAMENTAL);
+
+        std::vector<float> block(frames);
+        constexpr size_t blocks = 2000;
+        double total = 0.0;
+        for (size_t b = 0; b < blocks; ++b)
+        {
+            for (size_t i = 0; i < frames; ++i)
+                block[i] = testSignal(b * frames + i);
+            auto start = Clock::now();
+            effect.processBlock(block.data(), frames);
+            total += elapsedNs(start);
+            sink = block[0];
+        }
+        nsPerSample = total / (blocks * frames);
+    }
+
+    void benchOversampledFuzz()
+    {
+        struct Setting
+        {
+            int factor;
+            const char *quality;
+        };
+        const Setting settings[] = {{1, "medium"}, {2, "low"}, {2, "medium"}, {2, "high"}, {4, "low"}, {4, "medium"},
+                                    {4, "high"}, {8, "low"}, {8, "medium"}, {8, "high"}};
+
+        std::printf("Oversampled Fuzz (4 kHz sine at 0.5 into a 0.05 clip)\n");
+        std::printf("  factor quality  latency  signal/alias   cost\n");
+        for (const auto &setting : settings)
+        {
+            Config config;
+            config.set("fuzz", true, 5.0f);
+            config.set("fuzz_oversample", true, setting.factor);
+            config.set("fuzz_quality", true, std::string(setting.quality));
+            Fuzz fuzz;
+            fuzz.configure(config);
+
+            double aliasDb = 0.0, ns = 0.0;
+            measureDistortion(fuzz, aliasDb, ns);
+
+            Oversampler probe;
+            probe.select(setting.factor, Oversampler::parseQuality(setting.quality));
+            std::printf("  %4dx   %-7s %5zu     %7.1f dB  %7.2f ns/sample\n", setting.factor, setting.quality,
+                        probe.latency(), aliasDb, ns);
+        }
+    }
+
+    // --- ADAA waveshaper: aliasing and cost per curve and order (compare with "oversample") ---
+
+    void benchWaveshaper()
+    {
+        std::printf("Waveshaper ADAA (4 kHz sine at 0.5, drive x20 as in the Fuzz bench)\n");
+        std::printf("  curve     order  signal/alias   cost\n");
+        for (const char *curve : {"hardclip", "tanh", "diode"})
+        {
+            for (int order = 0; order <= 2; ++order)
+            {
+                Config config;
+                config.set("waveshaper", true, 2000.0f);
+                config.set("waveshaper_curve", true, std::string(curve));
+                config.set("waveshaper_adaa", true, order);
+                Waveshaper shaper;
+                shaper.configure(config);
+
+                double aliasDb = 0.0, ns = 0.0;
+                measureDistortion(shaper, aliasDb, ns);
+                std::printf("  %-9s %3d    %7.1f dB  %7.2f ns/sample\n", curve, order, aliasDb, ns);
+            }
+        }
+    }
+
+    // --- Noise gate: cost in the steady open and closed states ---
+
+    void benchNoiseGate()
+    {
+        constexpr size_t frames = 256;
+        constexpr size_t blocks = 20000;
+
+        std::printf("NoiseGate (threshold -40 dBFS)\n");
+        for (const char *detector : {"peak", "rms"})
+        {
+            for (float amplitude : {0.5f, 0.001f})
+            {
+                Config config;
+                config.set("noisegate", true, -40.0f);
+                config.set("noisegate_detector", true, std::string(detector));
+                NoiseGate gate;
+                gate.configure(config);
+
+                std::vector<float> block(frames);
+                double total = 0.0;
+                for (size_t b = 0; b < blocks; ++b)
+                {
+                    for (size_t i = 0; i < frames; ++i)
+                        block[i] = amplitude * testSignal(b * frames + i);
+                    auto start = Clock::now();
+                    gate.processBlock(block.data(), frames);
+                    total += elapsedNs(start);
+                    sink = block[0];
+                }
+                std::printf("  %-4s %-6s %6.2f ns/sample\n", detector, gate.isOpen() ? "open" : "closed",
+                            total / (blocks * frames));
+            }
+        }
+    }
+
+    // --- Limiter: cost while idle (below the ceiling) and while limiting ---
+
+    void benchLimiter()
+    {
+        constexpr size_t frames = 256;
+        constexpr size_t blocks = 20000;
+
+        std::printf("Limiter (ceiling -1 dBFS, 1.5 ms lookahead)\n");
+        for (float drive : {1.0f, 8.0f})
+        {
+            Config config;
+            config.set("limiter", true, -1.0f);
+            Limiter limiter;
+            limiter.configure(config);
+
+            std::vector<float> block(frames);
+            double total = 0.0;
+            for (size_t b = 0; b < blocks; ++b)
+            {
+                for (size_t i = 0; i < frames; ++i)
+                    block[i] = drive * testSignal(b * frames + i);
+                auto start = Clock::now();
+                limiter.processBlock(block.data(), frames);
+                total += elapsedNs(start);
+                sink = block[0];
+            }
+            std::printf("  %-8s gain %.3f  %6.2f ns/sample\n", drive > 1.0f ? "limiting" : "idle", limiter.gain(),
+                        total / (blocks * frames));
+        }
+    }
+
+    // --- Delay: steady and modulated cost, and what a time change allocates ---
+
+    void benchDelay()
+    {
+        constexpr size_t frames = 256;
+        constexpr size_t blocks = 20000;
+
+        std::printf("Delay (feedback 0.5, 4 kHz tone)\n");
+        for (float depth : {0.0f, 2.0f})
+        {
+            Config config;
+            config.set("delay", true, 350.0f);
+            config.set("delay_feedback", true, 0.5f);
+            config.set("delay_rate", true, 0.8f);
+            config.set("delay_depth", true, depth);
+            Delay delay;
+            delay.configure(config);
+
+            std::vector<float> block(frames);
+            double total = 0.0;
+            for (size_t b = 0; b < blocks; ++b)
+            {
+                for (size_t i = 0; i < frames; ++i)
+                    block[i] = testSignal(b * frames + i);
+                auto start = Clock::now();
+                delay.processBlock(block.data(), frames);
+                total += elapsedNs(start);
+                sink = block[0];
+            }
+            std::printf("  %-10s %6.2f ns/sample  (%zu KiB of history)\n", depth > 0.0f ? "modulated" : "steady",
+                        total / (blocks * frames), delay.capacity() * sizeof(float) / 1024);
+
+            if (depth == 0.0f)
+            {
+                // Sweep the time like an encoder would, processing between steps
+                allocatedBytes = 0;
+                trackAllocations = true;
+                for (int step = 0; step < 100; ++step)
+                {
+                    config.set("delay", true, 350.0f + 10.0f * step);
+                    delay.configure(config);
+                    delay.processBlock(block.data(), frames);
+                }
+                trackAllocations = false;
+                std::printf("  100 time changes allocated %zu bytes\n", allocatedBytes.load());
+            }
+        }
+    }
+
+    // --- Reverb: cost per 256-frame period next to the Harmonizer's ---
+
+    double nsPerEffectSample(Effect &effect, size_t frames, size_t blocks)
+    {
+        std::vector<float> block(frames);
+        double total = 0.0;
+        for (size_t b = 0; b < blocks; ++b)
+        {
+            for (size_t i = 0; i < frames; ++i)
+                block[i] = testSignal(b * frames + i);
+            auto start = Clock::now();
+            effect.processBlock(block.data(), frames);
+            total += elapsedNs(start);
+            sink = block[0];
+        }
+        return total / (blocks * frames);
+    }
+
+    void benchReverb()
+    {
+        constexpr size_t frames = 256;
+        const double periodUs = frames / SAMPLE_RATE * 1e6;
+
+        std::printf("Reverb FDN (256-frame period = %.0f us)\n", periodUs);
+        for (int lines : {8, 16})
+        {
+            for (const char *matrix : {"householder", "hadamard"})
+            {
+                Config config;
+                config.set("reverb", true, 2.5f);
+                config.set("reverb_lines", true, lines);
+                config.set("reverb_matrix", true, std::string(matrix));
+                Reverb reverb;
+                reverb.configure(config);
+
+                const double ns = nsPerEffectSample(reverb, frames, 4000);
+                std::printf("  %2d lines %-11s %6.2f ns/sample  %6.1f us/period (%.1f%%)\n", lines, matrix, ns,
+                            ns * frames / 1000.0, 100.0 * ns * frames / 1000.0 / periodUs);
+            }
+        }
+
+        Config config;
+        config.set("harmonizer", true, std::string("4 7"));
+        Harmonizer harmonizer;
+        harmonizer.configure(config);
+        const double ns = nsPerEffectSample(harmonizer, frames, 400);
+        std::printf("  Harmonizer (2 voices) %6.2f ns/sample  %6.1f us/period (%.1f%%)\n", ns, ns * frames / 1000.0,
+                    100.0 * ns * frames / 1000.0 / periodUs);
+    }
+
+    // --- Convolver: cost per 256-frame period against IR length and partition size ---
+
+    void benchConvolver()
+    {
+        constexpr size_t frames = 256;
+        constexpr size_t periods = 2000;
+        const double periodUs = frames / SAMPLE_RATE * 1e6;
+
+        std::printf("Partitioned convolution (256-frame period = %.0f us)\n", periodUs);
+        std::printf("   taps  partition  ns/sample  mean us/period  p99 us/period  p99/mean\n");
+        for (size_t taps : {512, 1024, 2048, 4096, 8192, 16384})
+        {
+            std::vector<float> impulse(taps);
+            for (size_t i = 0; i < taps; ++i)
+                impulse[i] = testSignal(i * 7) * std::exp(-4.0f * i / taps);
+
+            for (size_t partition : {64, 128, 256})
+            {
+                PartitionedConvolution convolution(impulse, partition);
+                std::vector<float> block(frames);
+                std::vector<double> costs(periods);
+                for (size_t p = 0; p < periods; ++p)
+                {
+                    for (size_t i = 0; i < frames; ++i)
+                        block[i] = testSignal(p * frames + i);
+                    auto start = Clock::now();
+                    convolution.process(block.data(), frames);
+                    costs[p] = elapsedNs(start) / 1000.0;
+                    sink = block[0];
+                }
+
+                double mean = 0.0;
+                for (double c : costs)
+                    mean += c;
+                mean /= periods;
+                std::sort(costs.begin(), costs.end());
+                const double p99 = costs[periods * 99 / 100];
+                std::printf("  %5zu  %9zu  %9.2f  %14.1f  %13.1f  %8.2f\n", taps, partition, mean * 1000.0 / frames,
+                            mean, p99, p99 / mean);
+            }
+        }
+    }
+
+    // --- IR partition cache: loading a 16k-tap IR from the WAV against mapping its cache ---
+
+    void benchPartitionCache()
+    {
+        // A 48 kHz IR, so the uncached load also has to resample it
+        const std::string path = "/tmp/pedal_bench_ir.wav";
+        std::vector<float> ir(16384);
+        for (size_t i = 0; i < ir.size(); ++i)
+            ir[i] = testSignal(i * 7) * std::exp(-4.0f * i / ir.size());
+        SF_INFO info = {};
+        info.samplerate = 48000;
+        info.channels = 1;
+        info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+        SNDFILE *file = sf_open(path.c_str(), SFM_WRITE, &info);
+        if (!file)
+        {
+            std::printf("IR partition cache: cannot write %s\n", path.c_str());
+            return;
+        }
+        sf_write_float(file, ir.data(), ir.size());
+        sf_close(file);
+
+        auto loadMs = [&](bool cache) {
+            Config config;
+            config.set("convolver", true, path);
+            config.set("convolver_partition", true, 128);
+            config.set("convolver_cache", true, cache);
+            Convolver convolver;
+            auto start = Clock::now();
+            convolver.configure(config);
+            return elapsedNs(start) / 1e6;
+        };
+
+        std::printf("IR partition cache (16384 taps at 48 kHz, partition 128)\n");
+        std::printf("  from WAV, no cache     %8.2f ms\n", loadMs(false));
+        std::printf("  from WAV, writes cache %8.2f ms\n", loadMs(true));
+        double mapped = 0.0;
+        for (int i = 0; i < 10; ++i)
+            mapped += loadMs(true);
+        std::printf("  mapped from cache      %8.2f ms\n", mapped / 10);
+
+        std::remove(path.c_str());
+        std::remove((path + ".44100-128.irc").c_str());
+    }
+
+    // --- Preset bank: build cost, memory per preset and switch cost ---
+
+    void benchPresetSwitch()
+    {
+        struct Sound
+        {
+            const char *name;
+            float gain;
+            float fuzz;
+            const char *harmony;
+        };
+        const Sound sounds[] = {
+            {"clean", 100.0f, 0.0f, nullptr},
+            {"drive", 150.0f, 20.0f, nullptr},
+            {"fuzz", 200.0f, 5.0f, nullptr},
+            {"thirds", 100.0f, 0.0f, "4 7"},
+        };
+
+        PresetBank bank;
+        for (const auto &sound : sounds)
+        {
+            Config snapshot;
+            snapshot.set("gain", true, sound.gain);
+            snapshot.set("fuzz", sound.fuzz > 0.0f, sound.fuzz);
+            if (sound.harmony)
+                snapshot.set("harmonizer", true, std::string(sound.harmony));
+            bank.capture(sound.name, snapshot);
+        }
+
+        Config &config = Config::getInstance();
+        config.set("gain", true, 100.0f);
+        DigitalSignalChain chain;
+        chain.configureEffects(config);
+
+        allocatedBytes = 0;
+        trackAllocations = true;
+        auto start = Clock::now();
+        const size_t built = chain.loadPresets(bank);
+        const double buildNs = elapsedNs(start);
+        trackAllocations = false;
+
+        std::printf("Preset bank\n");
+        std::printf("  %zu presets built and warmed in %.2f ms (%.2f ms each)\n",
+                    built, buildNs / 1e6, buildNs / 1e6 / built);
+        std::printf("  heap per preset: %.1f KiB (+ %zu B of fixed chain state)\n",
+                    allocatedBytes.load() / 1024.0 / built, sizeof(DigitalSignalChain) / (MAX_PRESETS + 1));
+
+        const double steady = nsPerSample(chain, 44100);
+        std::printf("  steady state:             %8.1f ns/sample\n", steady);
+
+        double selectNs = 0.0, pickupNs = 0.0, fadeNs = 0.0;
+        for (size_t i = 0; i < built; ++i)
+        {
+            start = Clock::now();
+            chain.selectPreset(i, config);
+            selectNs += elapsedNs(start);
+
+            // First sample after the request: O(1) pickup plus the first crossfaded sample
+            start = Clock::now();
+            Sample sample(testSignal(0));
+            chain.applyEffects(sample);
+            pickupNs += elapsedNs(start);
+
+            fadeNs += nsPerSample(chain, CROSSFADE_SAMPLES - 1, 1);
+            nsPerSample(chain, 4096); // settle before the next switch
+        }
+        std::printf("  selectPreset (control):   %8.1f ns\n", selectNs / built);
+        std::printf("  switch pickup (audio):    %8.1f ns\n", pickupNs / built);
+        std::printf("  during %zu-sample fade:   %8.1f ns/sample\n", CROSSFADE_SAMPLES, fadeNs / built);
+    }
+
+    // --- EQ: cost per sample by band count, next to Gain and Fuzz ---
+
+    void benchEQ()
+    {
+        constexpr size_t frames = 256;
+        const char *specs[] = {"highpass 80",       "lowshelf 200 3.0", "peak 400 -2.0 1.5", "peak 800 -4.0 1.2",
+                               "peak 1600 3.0 0.9", "peak 3200 2.0",    "highshelf 6000 -3.0", "lowpass 9000"};
+
+        std::printf("EQ (%zu-frame blocks, sections pipelined across SIMD lanes)\n", frames);
+        for (size_t bands : {1, 2, 4, 8})
+        {
+            Config config;
+            config.set("eq", true, 0.0f);
+            for (size_t i = 0; i < bands; ++i)
+                config.set("eq_" + std::to_string(i + 1), true, std::string(specs[i]));
+            EQ eq;
+            eq.configure(config);
+            std::printf("  %zu band%s %6.2f ns/sample\n", bands, bands == 1 ? " " : "s",
+                        nsPerEffectSample(eq, frames, 20000));
+        }
+
+        Config config;
+        config.set("gain", true, 120.0f);
+        config.set("fuzz", true, 20.0f);
+        Gain gain;
+        gain.configure(config);
+        Fuzz fuzz;
+        fuzz.configure(config);
+        std::printf("  Gain    %6.2f ns/sample\n", nsPerEffectSample(gain, frames, 20000));
+        std::printf("  Fuzz    %6.2f ns/sample\n", nsPerEffectSample(fuzz, frames, 20000));
+    }
+
+    // --- Chorus: cost per sample by voice count and mode, next to Gain and Fuzz ---
+
+    void benchChorus()
+    {
+        constexpr size_t frames = 256;
+
+        std::printf("Chorus (%zu-frame blocks, wavetable LFO, swept cubic reads)\n", frames);
+        for (int voices : {1, 2, 4})
+        {
+            Config config;
+            config.set("chorus", true, 0.8f);
+            config.set("chorus_voices", true, voices);
+            Chorus chorus;
+            chorus.configure(config);
+            std::printf("  chorus  %d voice%s %6.2f ns/sample\n", voices, voices == 1 ? " " : "s",
+                        nsPerEffectSample(chorus, frames, 20000));
+        }
+
+        Config config;
+        config.set("chorus", true, 0.25f);
+        config.set("chorus_mode", true, std::string("flanger"));
+        Chorus flanger;
+        flanger.configure(config);
+        std::printf("  flanger 1 voice  %6.2f ns/sample\n", nsPerEffectSample(flanger, frames, 20000));
+
+        config.set("gain", true, 120.0f);
+        config.set("fuzz", true, 20.0f);
+        Gain gain;
+        gain.configure(config);
+        Fuzz fuzz;
+        fuzz.configure(config);
+        std::printf("  Gain            %6.2f ns/sample\n", nsPerEffectSample(gain, frames, 20000));
+        std::printf("  Fuzz            %6.2f ns/sample\n", nsPerEffectSample(fuzz, frames, 20000));
+    }
+
+    // --- Pitch detection: FFT YIN spread over the Harmonizer's blocks, against a direct YIN ---
+
+    void benchPitch()
+    {
+        constexpr size_t frames = 64; // The Harmonizer's block
+        constexpr size_t blocks = 20000;
+        const double blockUs = frames / SAMPLE_RATE * 1e6;
+
+        std::printf("PitchDetector (%zu-frame pushes = %.0f us)\n", frames, blockUs);
+        std::vector<float> block(frames);
+        for (size_t decimation : {1, 2, 4})
+        {
+            PitchDetector detector(static_cast<float>(SAMPLE_RATE), decimation);
+            double total = 0.0, worst = 0.0;
+            for (size_t b = 0; b < blocks; ++b)
+            {
+                for (size_t i = 0; i < frames; ++i)
+                    block[i] = testSignal(b * frames + i);
+                auto start = Clock::now();
+                detector.push(block.data(), frames);
+                const double ns = elapsedNs(start);
+                total += ns;
+                worst = std::max(worst, ns);
+            }
+            sink = detector.frequency();
+            std::printf("  FFT YIN 1/%zu rate (frame %4zu, hop %3zu) %6.2f ns/sample  worst push %6.1f us\n", decimation,
+                        detector.frameLength(), detector.hopLength(), total / (blocks * frames), worst / 1000.0);
+        }
+
+        // The full-rate difference function summed directly, once per hop
+        constexpr size_t window = 1024, hop = 256;
+        std::vector<float> frame(2 * window);
+        for (size_t i = 0; i < frame.size(); ++i)
+            frame[i] = testSignal(i);
+        std::vector<float> difference(window);
+        constexpr size_t hops = 200;
+        auto start = Clock::now();
+        for (size_t h = 0; h < hops; ++h)
+        {
+            for (size_t tau = 1; tau < window; ++tau)
+            {
+                float d = 0.0f;
+                for (size_t j = 0; j < window; ++j)
+                {
+                    const float delta = frame[j] - frame[j + tau];
+                    d += delta * delta;
+                }
+                difference[tau] = d;
+            }
+            sink = difference[h + 1];
+        }
+        const double directNs = elapsedNs(start) / hops;
+        std::printf("  direct YIN full rate (frame 2048, hop 256) %6.2f ns/sample  per hop %6.1f us\n", directNs / hop,
+                    directNs / 1000.0);
+
+        for (const char *key : {"", "A minor"})
+        {
+            Config config;
+            config.set("harmonizer", true, std::string("2 4"));
+            if (*key != '\0')
+                config.set("harmonizer_key", true, std::string(key));
+            Harmonizer harmonizer;
+            harmonizer.configure(config);
+            std::printf("  Harmonizer (2 voices%s%s) %6.2f ns/sample\n", *key ? ", key " : "", key,
+                        nsPerEffectSample(harmonizer, 256, 400));
+        }
+    }
+
+    void benchTuner()
+    {
+        constexpr size_t frames = 11; // The pedal's period
+        constexpr size_t periods = 4000;
+        const double periodUs = frames / SAMPLE_RATE * 1e6;
+        std::printf("Tuner (%zu-frame periods = %.0f us, fed in real time)\n", frames, periodUs);
+
+        Config config;
+        config.set("tuner", true, 440.0f);
+        Tuner tuner;
+        size_t readings = 0;
+        tuner.setListener([&](const TunerReading &) { ++readings; });
+        tuner.configure(config);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20)); // Analysis thread up
+
+        // The audio side only: a copy into the ring, with the analysis thread draining it
+        std::vector<float> block(frames);
+        double total = 0.0, worst = 0.0;
+        allocatedBytes = 0;
+        trackAllocations = true;
+        for (size_t p = 0; p < periods; ++p)
+        {
+            for (size_t i = 0; i < frames; ++i)
+                block[i] = testSignal(p * frames + i);
+            auto start = Clock::now();
+            tuner.processBlock(block.data(), frames);
+            const double ns = elapsedNs(start);
+            total += ns;
+            worst = std::max(worst, ns);
+            std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int>(periodUs)));
+        }
+        trackAllocations = false;
+        std::printf("  audio thread  %6.2f ns/sample  worst period %6.2f us  %zu bytes allocated  %zu readings\n",
+                    total / (periods * frames), worst / 1000.0, allocatedBytes.load(), readings);
+
+        // For comparison: the same detection run on the audio thread
+        PitchDetector detector(SAMPLE_RATE, Tuner::DECIMATION, 30.0f, 1000.0f);
+        total = worst = 0.0;
+        for (size_t p = 0; p < periods * 4; ++p)
+        {
+            for (size_t i = 0; i < frames; ++i)
+                block[i] = testSignal(p * frames + i);
+            auto start = Clock::now();
+            detector.push(block.data(), frames);
+            const double ns = elapsedNs(start);
+            total += ns;
+            worst = std::max(worst, ns);
+        }
+        sink = detector.frequency();
+        std::printf("  inline detect %6.2f ns/sample  worst period %6.2f us\n", total / (periods * 4 * frames),
+                    worst / 1000.0);
+    }
+
+    void benchLooper()
+    {
+        constexpr size_t frames = 64;
+        constexpr size_t blocks = 20000;
+        const std::string path = "/tmp/pedal_bench_loop.wav";
+        std::remove(path.c_str());
+        std::printf("Looper (%zu-frame blocks)\n", frames);
+
+        Config config;
+        config.set("looper", true, 1.0f);
+        config.set("looper_file", true, path);
+        config.set("looper_minutes", true, 2);
+        Looper looper;
+        looper.configure(config);
+
+        // Record a 10 s loop, then time each state in turn
+        std::vector<float> signal(frames * 64), block(frames);
+        for (size_t i = 0; i < signal.size(); ++i)
+            signal[i] = testSignal(i);
+        auto timeBlocks = [&](size_t count) {
+            auto start = Clock::now();
+            for (size_t b = 0; b < count; ++b)
+            {
+                std::copy_n(signal.begin() + (b % 64) * frames, frames, block.begin());
+                looper.processBlock(block.data(), frames);
+            }
+            sink = block[0];
+            return elapsedNs(start) / (count * frames);
+        };
+        looper.press();
+        const double recordNs = timeBlocks(static_cast<size_t>(10 * SAMPLE_RATE) / frames);
+        looper.press();
+        const double playNs = timeBlocks(blocks);
+        looper.press();
+        const double overdubNs = timeBlocks(blocks);
+        looper.press();
+        std::printf("  record %5.2f  play %5.2f  overdub %5.2f ns/sample\n", recordNs, playNs,
+                    overdubNs);
+
+        // Persistence of a full two-minute loop, off the audio thread
+        std::vector<float> loop(static_cast<size_t>(120 * SAMPLE_RATE));
+        for (size_t i = 0; i < loop.size(); ++i)
+            loop[i] = testSignal(i);
+        auto start = Clock::now();
+        Looper::saveLoop(path, loop.data(), loop.size(), SAMPLE_RATE);
+        const double saveMs = elapsedNs(start) / 1e6;
+        start = Clock::now();
+        const size_t loaded = Looper::loadLoop(path, loop.data(), loop.size(), SAMPLE_RATE);
+        const double loadMs = elapsedNs(start) / 1e6;
+        std::printf("  2 min loop (%zu samples): save %.1f ms, restore %.1f ms\n", loaded, saveMs, loadMs);
+        std::remove(path.c_str());
+    }
+
+    // --- Stereo: one pass over planar channels vs a mono chain per channel ---
+
+    void benchStereo()
+    {
+        constexpr size_t frames = 256;
+        constexpr size_t blocks = 400;
+        Config &config = Config::getInstance();
+        config.set("noisegate", true, -60.0f);
+        config.set("chorus", true, 0.8f);
+        config.set("reverb", true, 2.0f);
+        config.set("limiter", true, -1.0f);
+        config.set("route", true, std::string("noisegate chorus reverb limiter"));
+        std::printf("Stereo (noisegate chorus reverb limiter, %zu-frame blocks)\n", frames);
+
+        std::vector<float> left(frames), right(frames);
+        float *channels[2] = {left.data(), right.data()};
+        auto timeBlocks = [&](DigitalSignalChain &chain, size_t inputs, size_t outputs) {
+            double total = 0.0;
+            for (size_t b = 0; b < blocks; ++b)
+            {
+                for (size_t i = 0; i < frames; ++i)
+                    left[i] = right[i] = testSignal(b * frames + i);
+                auto start = Clock::now();
+                chain.processBlock(channels, inputs, outputs, frames);
+                total += elapsedNs(start);
+                sink = left[0] + right[0];
+            }
+            return total / (blocks * frames);
+        };
+
+        DigitalSignalChain chain;
+        chain.configureEffects(config);
+        timeBlocks(chain, 1, 2); // warm up
+        const double monoOut = timeBlocks(chain, 1, 1);
+        const double monoIn = timeBlocks(chain, 1, 2);
+        const double stereoIn = timeBlocks(chain, 2, 2);
+
+        // The alternative: a whole mono chain for each side
+        DigitalSignalChain second;
+        config.set("reverb_mix", true, 0.25f); // Flags an update so the second chain is configured
+        second.configureEffects(config);
+        double twice = 0.0;
+        for (size_t b = 0; b < blocks; ++b)
+        {
+            for (size_t i = 0; i < frames; ++i)
+                left[i] = right[i] = testSignal(b * frames + i);
+            auto start = Clock::now();
+            chain.processBlock(left.data(), frames);
+            second.processBlock(right.data(), frames);
+            twice += elapsedNs(start);
+            sink = left[0] + right[0];
+        }
+        std::printf("  mono in/out %6.1f | mono in, stereo out %6.1f | stereo in/out %6.1f | two mono chains %6.1f ns/frame\n",
+                    monoOut, monoIn, stereoIn, twice / (blocks * frames));
+
+        for (const char *key : {"noisegate", "chorus", "reverb", "limiter"})
+            config.set(key, false, 0.0f);
+        config.set("route", false, std::string(""));
+    }
+
+    // --- SSD1305 refresh: bus transfers (system calls) and time per refresh ---
+
+    void benchDisplayFlush()
+    {
+        std::printf("SSD1305 refresh (times are only meaningful with the panel attached)\n");
+        if (DEV_ModuleInit() != 0)
+        {
+            std::printf("  display not available, skipped\n");
+            return;
+        }
+        SSD1305_begin();
+        const int refreshes = 200;
+
+        auto report = [&](const char *label, const std::function<void(int)> &refresh) {
+            const UDOUBLE transfers = DEV_Bus_Transfers();
+            auto start = Clock::now();
+            for (int r = 0; r < refreshes; ++r)
+                refresh(r);
+            const double us = elapsedNs(start) / refreshes / 1000.0;
+            std::printf("  %-28s %7.1f transfers %9.1f us per refresh\n", label,
+                        static_cast<double>(DEV_Bus_Transfers() - transfers) / refreshes, us);
+        };
+
+        // Before: one DC write and one SPI write per command and per byte
+        SSD1305_clear();
+        SSD1305_bitmap(0, 0, piano_screen, 128, 32, 1);
+        report("byte at a time (before)", [](int) {
+            for (uint8_t page = 0; page < HEIGHT / 8; ++page)
+            {
+                for (uint8_t cmd : {static_cast<uint8_t>(0xB0 + page), uint8_t{0x04}, uint8_t{0x10}})
+                {
+                    OLED_DC_0;
+                    DEV_SPI_WriteByte(cmd);
+                }
+                for (int column = 0; column < WIDTH; ++column)
+                {
+                    OLED_DC_1;
+                    DEV_SPI_WriteByte(piano_screen[page * WIDTH + column]);
+                }
+            }
+        });
+
+        report("bulk, every page", [](int) {
+            SSD1305_invalidate();
+            SSD1305_display();
+        });
+
+        // A key lighting up changes a few columns of one page
+        report("bulk, one key changed", [](int r) {
+            for (int x = 40; x < 46; ++x)
+                SSD1305_pixel(x, 28, r & 1);
+            SSD1305_display();
+        });
+
+        report("bulk, unchanged", [](int) { SSD1305_display(); });
+    }
+
+    void benchDisplayRender()
+    {
+        std::printf("Display frame drawing into the framebuffer (headless, no panel needed)\n");
+        Display display;
+        display.init(DisplayBackend::Headless);
+        int notes[] = {-9, 0, 4, 7};
+        display.setSelectedNotes(notes, 4);
+        const int frames = 20000;
+
+        auto report = [&](const char *label, const std::function<void(int)> &draw) {
+            auto start = Clock::now();
+            for (int f = 0; f < frames; ++f)
+                draw(f);
+            std::printf("  %-28s %9.2f us per frame\n", label, elapsedNs(start) / frames / 1000.0);
+        };
+
+        // The cursor sweeps the keyboard, so white and black keys are both drawn
+        report("piano screen", [&](int f) {
+            display.setCursor(f % 35 - 17);
+            display.update("Fuzz", 0.42f, f & 1);
+        });
+        report("tuner screen", [&](int f) {
+            display.showTuner("E2", static_cast<float>(f % 97 - 48), true, 440.0f);
+        });
+    }
+
+    struct Benchmark
+    {
+        const char *name;
+        std::function<void()> run;
+    };
+}
+
+int main(int argc, char *argv[])
+{
+    const std::vector<Benchmark> benchmarks = {
+        {"preset", benchPresetSwitch},
+        {"routing", benchRouting},
+        {"stereo", benchStereo},
+        {"static", benchStaticChain},
+        {"oversample", benchOversampledFuzz},
+        {"adaa", benchWaveshaper},
+        {"gate", benchNoiseGate},
+        {"limiter", benchLimiter},
+        {"delay", benchDelay},
+        {"reverb", benchReverb},
+        {"eq", benchEQ},
+        {"chorus", benchChorus},
+        {"pitch", benchPitch},
+        {"tuner", benchTuner},
+        {"looper", benchLooper},
+        {"convolver", benchConvolver},
+        {"ircache", benchPartitionCache},
+        {"display", benchDisplayFlush},
+        {"render", benchDisplayRender},
+    };
+
+    // Optional argument: run only benchmarks whose name contains it
+    const char *filter = argc > 1 ? argv[1] : "";
+    for (const auto &benchmark : benchmarks)
+    {
+        if (std::strstr(benchmark.name, filter) == nullptr)
+            continue;
+        benchmark.run();
+        std::printf("\n");
+    }
+    return 0;
+}
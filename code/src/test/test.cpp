@@ -1,5 +1,8 @@
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
 #include <iomanip>
+#include <vector>
 #include <csignal>
 #include <gpiod.h>
 #include <stdio.h>
@@ -7,21 +10,21 @@
 #include "MockSamplingModule.h"
 #include "MockOutputModule.h"
 #include "DigitalSignalChain.h"
-#include "Sample.h"
-#include "EffectFactory.h"
+#include "EffectRegistry.h"
 #include "Config.h"
 #include "EncoderHandler.h"
 #include "gpioevent.h"
 
-// Optional linker anchor — ensures effects get registered
-extern void ForceAllEffects(); // defined in ForceEffects.cpp
+constexpr size_t BLOCK_FRAMES = MAX_BLOCK_SIZE; ///< Frames read, processed and written at a time
+
 /**
- * @brief Processes a single sample, applies DSP, and writes to output
+ * @brief Processes a planar block of frames, applies DSP, and writes to output
  */
-void processSample(Sample &sample, DigitalSignalChain &dspChain, MockOutputModule &output)
+void processFrames(float *const *channels, size_t inputChannels, size_t outputChannels, size_t frames,
+                   DigitalSignalChain &dspChain, MockOutputModule &output)
 {
-    dspChain.applyEffects(sample);
-    output.writeSample(sample);
+    dspChain.processBlock(channels, inputChannels, outputChannels, frames);
+    output.writeFrames(channels, frames);
 }
 
 /**
@@ -33,16 +36,16 @@ int main(int argc, char *argv[])
 
     if (argc < 3)
     {
-        std::cerr << "[Usage] " << argv[0] << " <input.wav> <output.wav>\n";
+        std::cerr << "[Usage] " << argv[0] << " <input.wav> <output.wav> [output channels]\n";
         return EXIT_FAILURE;
     }
 
     // === Parse args ===
     const std::string inputWavFilePath = argv[1];
     const std::string outputWavFilePath = argv[2];
+    const int requestedChannels = argc > 3 ? std::atoi(argv[3]) : static_cast<int>(MAX_CHANNELS); // Stereo, like the pedal
 
     // === Initialise system ===
-    ForceAllEffects();                      // Register all effects
     Config &config = Config::getInstance(); // Singleton config
     config.registerSignalHandler();         // Enable SIGUSR1 update
     DigitalSignalChain dspChain;            // Create chain (auto-registers all effects)
@@ -50,11 +53,23 @@ int main(int argc, char *argv[])
     dspChain.configureEffects(config);      // Apply initial configuration
 
     MockSamplingModule input(inputWavFilePath);
-    MockOutputModule output(outputWavFilePath);
 
-    float pcm;
+    // Channels beyond what the chain carries are dropped on the way in
+    const size_t inputChannels = std::min(static_cast<size_t>(std::max(input.channels(), 1)), MAX_CHANNELS);
+    const size_t outputChannels = std::min(static_cast<size_t>(std::max(requestedChannels, 1)), MAX_CHANNELS);
+    MockOutputModule output(outputWavFilePath, static_cast<int>(outputChannels), input.sampleRate());
+    std::cout << "[test.cpp] " << input.channels() << " channel(s) in, " << outputChannels << " out, at "
+              << input.sampleRate() << " Hz\n";
+
+    // Effects run at the file's rate, as they would at the device's
+    dspChain.prepare(static_cast<float>(input.sampleRate()), BLOCK_FRAMES);
+
+    std::vector<float> planes(std::max<size_t>(input.channels(), MAX_CHANNELS) * BLOCK_FRAMES);
+    std::vector<float *> channels;
+    for (size_t c = 0; c * BLOCK_FRAMES < planes.size(); ++c)
+        channels.push_back(planes.data() + c * BLOCK_FRAMES);
 
-    while (input.getSample(pcm))
+    while (const size_t frames = input.getFrames(channels.data(), BLOCK_FRAMES))
     {
         if (config.hasUpdate())
         {
@@ -62,8 +77,7 @@ int main(int argc, char *argv[])
             dspChain.configureEffects(config);
         }
 
-        Sample sample(pcm);
-        processSample(sample, dspChain, output);
+        processFrames(channels.data(), inputChannels, outputChannels, frames, dspChain, output);
     }
 
     std::cout << "\n[test.cpp] All samples processed. Writing output file...\n";
@@ -3,10 +3,41 @@
 #include "MockOutputModule.h"
 #include "DigitalSignalChain.h"
 #include "Sample.h"
-#include "EffectFactory.h"
+#include "EffectRegistry.h"
 #include "Config.h"
+#include "ConfigWatcher.h"
+#include "PresetBank.h"
+#include "RealtimeCheck.h"
+#include "RoutingGraph.h"
+#include "BranchWorkers.h"
+#include "FusedChains.h"
+#include "Oversampler.h"
+#include "Chorus.h"
+#include "Convolver.h"
+#include "PartitionCache.h"
+#include "PitchDetector.h"
+#include "Delay.h"
+#include "EQ.h"
+#include "Limiter.h"
+#include "Looper.h"
+#include "NoiseGate.h"
+#include "Reverb.h"
+#include "ShaperTable.h"
+#include "SpscRing.h"
+#include "Tuner.h"
+#include "Waveshaper.h"
+#include "Gain.h"
+#include "ui/Display.h"
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <cstdio>
+#include <poll.h>
+#include <random>
+#include <sndfile.h>
+#include <unistd.h>
 
-extern void ForceAllEffects();
 const std::string ASSET_PATH = "../../../../assets";
 
 class DSPTest : public ::testing::Test
@@ -17,14 +48,13 @@ protected:
 
     void SetUp() override
     {
-        ForceAllEffects();
-
         chain = std::make_unique<DigitalSignalChain>();
 
         config = &Config::getInstance();
         config->set("gain", true, 50.0f);      // enable Gain
         config->set("fuzz", false, 5.0f);       // disable Fuzz
         config->set("harmonizer", false, 0.0f); // disable Harmonizer for now
+        config->set("route", false, std::string("")); // default serial order
 
         chain->configureEffects(*config);
     }
@@ -161,6 +191,1471 @@ TEST_F(DSPTest, Gain200PercentDoublesSample)
     EXPECT_NEAR(s.getPcmValue(), 1.0f, 0.01f);
 }
 
+// --- Config diffing and file watching ---
+
+TEST(ConfigUnitTest, RevisionOnlyAdvancesOnChange)
+{
+    Config &config = Config::getInstance();
+    config.set("revision_test", true, 1.0f);
+    const uint64_t first = config.revision("revision_test");
+
+    config.set("revision_test", true, 1.0f);
+    EXPECT_EQ(config.revision("revision_test"), first);
+
+    config.set("revision_test", true, 2.0f);
+    EXPECT_GT(config.revision("revision_test"), first);
+}
+
+TEST(ConfigUnitTest, SubKeysShareParentRevision)
+{
+    Config &config = Config::getInstance();
+    config.set("subkey", true, 1);
+    config.set("subkey_mode", true, 3);
+    EXPECT_EQ(config.revision("subkey"), config.revision("subkey_mode"));
+
+    config.set("subkeyother", true, 5);
+    EXPECT_LT(config.revision("subkey"), config.revision("subkeyother"));
+}
+
+TEST(ConfigUnitTest, NumbersReadAsIntOrFloat)
+{
+    Config config;
+    config.set("whole", true, 3);
+    config.set("fraction", true, 0.5f);
+    config.set("word", true, std::string("loud"));
+    config.set("off", false, 7);
+    EXPECT_FLOAT_EQ(config.getNumber("whole", 1.0f), 3.0f);
+    EXPECT_FLOAT_EQ(config.getNumber("fraction", 1.0f), 0.5f);
+    EXPECT_FLOAT_EQ(config.getNumber("word", 1.5f), 1.5f);
+    EXPECT_FLOAT_EQ(config.getNumber("off", 1.5f), 1.5f);
+    EXPECT_FLOAT_EQ(config.getNumber("missing", 1.5f), 1.5f);
+}
+
+TEST_F(DSPTest, UnchangedEffectIsNotReconfigured)
+{
+    Gain gain;
+    EXPECT_TRUE(gain.configure(*config));
+    EXPECT_FALSE(gain.configure(*config));
+
+    config->set("fuzz", true, 2.0f); // unrelated key
+    EXPECT_FALSE(gain.configure(*config));
+
+    config->set("gain", true, 75.0f);
+    EXPECT_TRUE(gain.configure(*config));
+}
+
+TEST(ConfigUnitTest, WatcherReportsFileChanges)
+{
+    char dir[] = "/tmp/pedal_cfgXXXXXX";
+    ASSERT_NE(mkdtemp(dir), nullptr);
+    const std::string path = std::string(dir) + "/config.cfg";
+    std::ofstream(path) << "watchtest, true, 1\n";
+
+    ConfigWatcher watcher(path);
+    ASSERT_TRUE(watcher.start());
+
+    std::ofstream(path) << "watchtest, true, 2\n";
+
+    struct pollfd pfd = {watcher.fd(), POLLIN, 0};
+    ASSERT_EQ(poll(&pfd, 1, 1000), 1);
+    EXPECT_TRUE(watcher.readEvents());
+
+    Config &config = Config::getInstance();
+    ASSERT_TRUE(config.loadFromFile(path));
+    EXPECT_EQ(config.get<int>("watchtest", 0), 2);
+
+    std::remove(path.c_str());
+    rmdir(dir);
+}
+
+// --- Preset bank ---
+
+TEST(PresetBankUnitTest, SaveLoadRoundTrip)
+{
+    Config snapshot;
+    snapshot.set("gain", true, 150.0f);
+    snapshot.set("fuzz", true, 3);
+    snapshot.set("harmonizer", true, std::string("4 7"));
+
+    PresetBank bank;
+    bank.capture("lead", snapshot);
+
+    const std::string path = "/tmp/pedal_presets_test.bin";
+    ASSERT_TRUE(bank.save(path));
+
+    PresetBank loaded;
+    ASSERT_TRUE(loaded.load(path));
+    ASSERT_EQ(loaded.size(), 1u);
+    EXPECT_EQ(loaded[0].name, "lead");
+
+    Config restored;
+    loaded[0].applyTo(restored);
+    EXPECT_FLOAT_EQ(restored.get<float>("gain", 0.0f), 150.0f);
+    EXPECT_EQ(restored.get<int>("fuzz", 0), 3);
+    EXPECT_EQ(restored.get<std::string>("harmonizer", ""), "4 7");
+
+    std::remove(path.c_str());
+}
+
+TEST(PresetBankUnitTest, RejectsForeignFiles)
+{
+    const std::string path = "/tmp/pedal_presets_bad.bin";
+    std::ofstream(path, std::ios::binary) << "not a preset bank";
+
+    PresetBank bank;
+    EXPECT_FALSE(bank.load(path));
+    EXPECT_EQ(bank.size(), 0u);
+
+    std::remove(path.c_str());
+}
+
+TEST_F(DSPTest, PresetSwitchCrossfadesToNewChain)
+{
+    config->set("gain", true, 100.0f);
+    chain->configureEffects(*config);
+
+    Config loud;
+    loud.set("gain", true, 200.0f);
+    PresetBank bank;
+    bank.capture("loud", loud);
+
+    // Per-instance setup (e.g. the display's tuner listener) reaches preset chains built later
+    size_t setups = 0;
+    chain->forEachInstance(EffectRegistry::idOf<Gain>(), [&](Effect &) { ++setups; });
+    EXPECT_EQ(setups, 1u);
+    ASSERT_EQ(chain->loadPresets(bank), 1u);
+    EXPECT_EQ(setups, 2u);
+    ASSERT_TRUE(chain->selectPreset(0, *config));
+
+    // The fade starts fully on the old chain...
+    Sample first(0.25f);
+    chain->applyEffects(first);
+    EXPECT_NEAR(first.getPcmValue(), 0.25f, 1e-4f);
+
+    for (size_t i = 1; i < CROSSFADE_SAMPLES; ++i)
+    {
+        Sample s(0.25f);
+        chain->applyEffects(s);
+    }
+
+    // ...and ends fully on the preset, whose values are now the live config
+    Sample after(0.25f);
+    chain->applyEffects(after);
+    EXPECT_NEAR(after.getPcmValue(), 0.5f, 1e-4f);
+    EXPECT_FLOAT_EQ(config->get<float>("gain", 0.0f), 200.0f);
+
+    // Controls (e.g. the looper button) reach the preset chain's instances
+    const EffectId gainId = EffectRegistry::idOf<Gain>();
+    EXPECT_NE(chain->getPlayingEffect(gainId).get(), chain->getEffect(gainId));
+
+    // A negative "preset" goes back to the live chain, brought up to date with the config
+    config->set("gain", true, 150.0f);
+    config->set("preset", true, -1);
+    chain->configureEffects(*config);
+    for (size_t i = 0; i < CROSSFADE_SAMPLES / 2; ++i)
+    {
+        Sample s(0.25f);
+        chain->applyEffects(s);
+    }
+
+    // The preset chain is still fading out, so it cannot be rebuilt (or dropped) yet
+    PresetBank empty;
+    EXPECT_EQ(chain->loadPresets(empty), 1u);
+    for (size_t i = CROSSFADE_SAMPLES / 2; i < CROSSFADE_SAMPLES; ++i)
+    {
+        Sample s(0.25f);
+        chain->applyEffects(s);
+    }
+    Sample live(0.25f);
+    chain->applyEffects(live);
+    EXPECT_NEAR(live.getPcmValue(), 0.375f, 1e-4f);
+    EXPECT_EQ(chain->getPlayingEffect(gainId).get(), chain->getEffect(gainId));
+    EXPECT_EQ(chain->loadPresets(empty), 0u);
+}
+
+// --- Effect registry ---
+
+TEST(EffectRegistryUnitTest, TableIsBuiltFromTypeList)
+{
+    static_assert(EffectRegistry::idOf<Gain>() == EffectRegistry::find("Gain"), "IDs must match names");
+    static_assert(EffectRegistry::find("NoSuchEffect") == INVALID_EFFECT_ID, "Unknown names must not resolve");
+
+    ASSERT_EQ(EffectRegistry::count, RegisteredEffects::size);
+    for (size_t i = 0; i < EffectRegistry::count; ++i)
+    {
+        const EffectInfo &info = EffectRegistry::table[i];
+        EXPECT_EQ(info.id, i);
+        EXPECT_EQ(EffectRegistry::find(info.name), info.id);
+        EXPECT_GE(info.size, sizeof(Effect));
+
+        auto effect = EffectRegistry::create(info.id);
+        ASSERT_NE(effect, nullptr) << info.name;
+    }
+
+    EXPECT_EQ(EffectRegistry::table[EffectRegistry::idOf<Gain>()].size, sizeof(Gain));
+    EXPECT_EQ(EffectRegistry::create(INVALID_EFFECT_ID), nullptr);
+}
+
+TEST_F(DSPTest, ChainLooksUpEffectsById)
+{
+    Effect *gain = chain->getEffect(EffectRegistry::idOf<Gain>());
+    ASSERT_NE(gain, nullptr);
+    EXPECT_NE(dynamic_cast<Gain *>(gain), nullptr);
+    EXPECT_TRUE(gain->isActive());
+    EXPECT_EQ(chain->getEffect(INVALID_EFFECT_ID), nullptr);
+}
+
+// --- Routing graph ---
+
+TEST(RoutingGraphUnitTest, CompilesSerialAndParallelRoutes)
+{
+    RouteSchedule schedule;
+    std::string error;
+
+    ASSERT_TRUE(RoutingGraph::compile("fuzz gain", schedule, error)) << error;
+    ASSERT_EQ(schedule.mainSteps, 2);
+    EXPECT_EQ(schedule.steps[0].effect, EffectRegistry::find("Fuzz"));
+    EXPECT_EQ(schedule.steps[1].effect, EffectRegistry::idOf<Gain>());
+    EXPECT_EQ(schedule.forks, 0);
+
+    // Harmonizer forked, Fuzz on the caller's thread, mixed back at half gain
+    ASSERT_TRUE(RoutingGraph::compile("Gain [fuzz | harmonizer]", schedule, error)) << error;
+    EXPECT_EQ(schedule.forks, 1);
+    EXPECT_EQ(schedule.buffers, 2);
+    EXPECT_EQ(schedule.totalSteps, schedule.mainSteps + 1);
+    EXPECT_EQ(schedule.steps[schedule.mainSteps].effect, EffectRegistry::find("Harmonizer"));
+}
+
+TEST(RoutingGraphUnitTest, RejectsBadRoutes)
+{
+    RouteSchedule schedule;
+    std::string error;
+
+    EXPECT_FALSE(RoutingGraph::compile("gain wah", schedule, error));
+    EXPECT_NE(error.find("wah"), std::string::npos);
+    EXPECT_FALSE(RoutingGraph::compile("gain [fuzz | gain]", schedule, error));
+    EXPECT_FALSE(RoutingGraph::compile("[gain | fuzz", schedule, error));
+    EXPECT_FALSE(RoutingGraph::compile("gain ] fuzz", schedule, error));
+}
+
+TEST(BranchWorkersUnitTest, RunsDispatchedJobs)
+{
+    BranchWorkers workers;
+    workers.start(2);
+    ASSERT_EQ(workers.size(), 2u);
+
+    static std::atomic<int> total{0};
+    auto job = [](void *, uint16_t begin, uint16_t end) { total += end - begin; };
+    workers.dispatch(0, job, nullptr, 0, 3);
+    workers.dispatch(1, job, nullptr, 10, 15);
+    workers.wait(0);
+    workers.wait(1);
+    EXPECT_EQ(total.load(), 8);
+
+    workers.stop();
+    EXPECT_EQ(workers.size(), 0u);
+}
+
+TEST_F(DSPTest, ParallelBranchesAreMixedAtEqualGain)
+{
+    // Gain (50%) in parallel with a dry path: (0.5 x + x) / 2
+    config->set("route", true, std::string("[gain | ]"));
+    chain->configureEffects(*config);
+
+    float block[64];
+    std::fill(block, block + 64, 0.4f);
+    chain->processBlock(block, 64);
+    for (float value : block)
+        EXPECT_FLOAT_EQ(value, 0.3f);
+
+    // Per-sample processing runs the same schedule
+    Sample s(0.4f);
+    chain->applyEffects(s);
+    EXPECT_FLOAT_EQ(s.getPcmValue(), 0.3f);
+
+    // An invalid route keeps the previous one
+    config->set("route", true, std::string("[gain | nothing]"));
+    chain->configureEffects(*config);
+    Sample t(0.4f);
+    chain->applyEffects(t);
+    EXPECT_FLOAT_EQ(t.getPcmValue(), 0.3f);
+
+    // Dropping the route restores the default serial order
+    config->set("route", false, std::string(""));
+    chain->configureEffects(*config);
+    Sample u(0.4f);
+    chain->applyEffects(u);
+    EXPECT_FLOAT_EQ(u.getPcmValue(), 0.2f);
+}
+
+TEST_F(DSPTest, NestedSplitsKeepTheirBranchesApart)
+{
+    // Each buffer in use at once is distinct: the nested gain branch must not share the delay's
+    RouteSchedule schedule;
+    std::string error;
+    ASSERT_TRUE(RoutingGraph::compile("[[fuzz | gain] | delay]", schedule, error)) << error;
+    EXPECT_EQ(schedule.buffers, 3);
+    std::vector<uint8_t> copies;
+    for (uint16_t i = 0; i < schedule.totalSteps; ++i)
+    {
+        if (schedule.steps[i].op == RouteOp::Copy)
+            copies.push_back(schedule.steps[i].dst);
+    }
+    ASSERT_EQ(copies.size(), 2u);
+    EXPECT_NE(copies[0], copies[1]);
+
+    // The chain matches the effects run separately and mixed by hand
+    config->set("fuzz", true, 10.0f);
+    config->set("delay", true, 1.0f);
+    config->set("route", true, std::string("[[fuzz | gain] | delay]"));
+    chain->configureEffects(*config);
+    Fuzz fuzz;
+    Gain gain;
+    Delay delay;
+    fuzz.configure(*config);
+    gain.configure(*config);
+    delay.configure(*config);
+
+    std::vector<float> input(1024);
+    for (size_t i = 0; i < input.size(); ++i)
+        input[i] = 0.5f * std::sin(0.05f * static_cast<float>(i));
+    std::vector<float> a(input), b(input), c(input), out(input);
+    fuzz.processBlock(a.data(), a.size());
+    gain.processBlock(b.data(), b.size());
+    delay.processBlock(c.data(), c.size());
+    chain->processBlock(out.data(), out.size());
+    for (size_t i = 0; i < input.size(); ++i)
+        ASSERT_NEAR(out[i], 0.5f * (0.5f * (a[i] + b[i]) + c[i]), 1e-6f) << "sample " << i;
+
+    config->set("fuzz", false, 10.0f);
+    config->set("delay", false, 1.0f);
+    config->set("route", false, std::string(""));
+    chain->configureEffects(*config);
+}
+
+TEST_F(DSPTest, StereoSignalsWidenFoldAndLink)
+{
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+    std::vector<float> input(2048);
+    for (float &x : input)
+        x = noise(rng);
+
+    // A stereo effect widens a mono input: the chorus voices are panned apart
+    config->set("chorus", true, 1.5f);
+    config->set("chorus_voices", true, 2.0f);
+    config->set("chorus_spread", true, 1.0f);
+    config->set("route", true, std::string("chorus"));
+    chain->configureEffects(*config);
+
+    std::vector<float> left(input), right(input.size());
+    float *stereo[2] = {left.data(), right.data()};
+    chain->processBlock(stereo, 1, 2, input.size());
+    float widest = 0.0f;
+    for (size_t i = 0; i < input.size(); ++i)
+        widest = std::max(widest, std::fabs(left[i] - right[i]));
+    EXPECT_GT(widest, 0.05f);
+
+    // Panning keeps the mono fold equal to the mono chorus
+    Chorus mono, wide;
+    ASSERT_TRUE(mono.configure(*config));
+    ASSERT_TRUE(wide.configure(*config));
+    std::vector<float> folded(input), l(input), r(input);
+    float *planes[2] = {l.data(), r.data()};
+    mono.processBlock(folded.data(), folded.size());
+    wide.processChannels(planes, 2, input.size());
+    for (size_t i = 0; i < input.size(); ++i)
+        ASSERT_NEAR(0.5f * (l[i] + r[i]), folded[i], 1e-5f) << "sample " << i;
+
+    // A mono effect after it folds the signal, so both outputs carry the same thing
+    config->set("fuzz", true, 5.0f);
+    config->set("route", true, std::string("chorus fuzz"));
+    chain->configureEffects(*config);
+    std::copy(input.begin(), input.end(), left.begin());
+    chain->processBlock(stereo, 1, 2, input.size());
+    for (size_t i = 0; i < input.size(); ++i)
+        ASSERT_EQ(left[i], right[i]) << "sample " << i;
+
+    // The limiter links its channels: one gain for both, so their ratio survives
+    config->set("limiter", true, -6.0f);
+    config->set("route", true, std::string("limiter"));
+    chain->configureEffects(*config);
+    for (size_t i = 0; i < input.size(); ++i)
+    {
+        left[i] = 2.0f * input[i];
+        right[i] = input[i];
+    }
+    chain->processBlock(stereo, 2, 2, input.size());
+    const float ceiling = std::pow(10.0f, -6.0f / 20.0f);
+    for (size_t i = 0; i < input.size(); ++i)
+    {
+        ASSERT_LE(std::fabs(left[i]), ceiling + 1e-6f);
+        ASSERT_NEAR(left[i], 2.0f * right[i], 1e-5f) << "sample " << i;
+    }
+
+    config->set("chorus", false, 1.5f);
+    config->set("fuzz", false, 5.0f);
+    config->set("limiter", false, -6.0f);
+    config->set("route", false, std::string(""));
+    chain->configureEffects(*config);
+}
+
+// --- Fused static chains ---
+
+TEST(StaticChainUnitTest, MatchesTheEffectsRunSeparately)
+{
+    Config config;
+    config.set("gain", true, 250.0f);
+    config.set("fuzz", true, 40.0f);
+
+    Gain gain;
+    Fuzz fuzz;
+    GainFuzz fused;
+    gain.configure(config);
+    fuzz.configure(config);
+    EXPECT_TRUE(fused.configure(config));
+    EXPECT_FALSE(fused.configure(config)); // Unchanged keys
+
+    float block[32];
+    for (size_t i = 0; i < 32; ++i)
+        block[i] = -0.5f + i / 31.0f;
+    float expected[32];
+    for (size_t i = 0; i < 32; ++i)
+        expected[i] = fuzz.process(gain.process(block[i]));
+
+    fused.processBlock(block, 32);
+    for (size_t i = 0; i < 32; ++i)
+        EXPECT_FLOAT_EQ(block[i], expected[i]);
+
+    // A disabled stage becomes the identity
+    config.set("fuzz", false, 40.0f);
+    fused.configure(config);
+    EXPECT_TRUE(fused.isActive());
+    EXPECT_FLOAT_EQ(fused.process(0.1f), 0.25f);
+}
+
+TEST_F(DSPTest, RouteUsesFusedChainForMatchingRun)
+{
+    RouteSchedule schedule;
+    std::string error;
+    ASSERT_TRUE(RoutingGraph::compile("gain fuzz harmonizer", schedule, error)) << error;
+    ASSERT_EQ(schedule.mainSteps, 2);
+    EXPECT_EQ(schedule.steps[0].effect, EffectRegistry::fused[0].id);
+    EXPECT_STREQ(EffectRegistry::info(schedule.steps[0].effect).name, GainFuzz::Name);
+
+    config->set("fuzz", true, 10.0f);
+    config->set("route", true, std::string("gain fuzz"));
+    chain->configureEffects(*config);
+
+    Sample s(0.4f);
+    chain->applyEffects(s);
+    EXPECT_FLOAT_EQ(s.getPcmValue(), 0.1f); // 0.4 * 50% clipped at 0.1
+    ASSERT_EQ(s.getAppliedEffects().size(), 1u);
+    EXPECT_EQ(s.getAppliedEffects()[0], GainFuzz::Name);
+}
+
+// --- Oversampling ---
+
+TEST(OversamplerUnitTest, PassesInBandSignalWithReportedLatency)
+{
+    const size_t factors[] = {2, 4, 8};
+    for (size_t factor : factors)
+    {
+        Oversampler oversampler;
+        oversampler.select(factor, OversampleQuality::High);
+        ASSERT_EQ(oversampler.factor(), factor);
+
+        // 1 kHz at 44.1 kHz through an identity kernel comes out unchanged, only delayed
+        std::vector<float> signal(2048);
+        for (size_t i = 0; i < signal.size(); ++i)
+            signal[i] = std::sin(2.0f * static_cast<float>(M_PI) * 1000.0f * i / 44100.0f);
+        std::vector<float> output = signal;
+        oversampler.process(output.data(), output.size(), [](float x) { return x; });
+
+        const size_t delay = oversampler.latency();
+        for (size_t i = 1024; i < signal.size(); ++i)
+        {
+            EXPECT_NEAR(output[i], signal[i - delay], 2e-3f) << "factor " << factor << " at " << i;
+        }
+    }
+}
+
+TEST(OversamplerUnitTest, FuzzSelectsFactorFromConfig)
+{
+    Config config;
+    config.set("fuzz", true, 10.0f);
+    config.set("fuzz_oversample", true, 4);
+    config.set("fuzz_quality", true, std::string("low"));
+
+    Fuzz fuzz;
+    fuzz.configure(config);
+    EXPECT_EQ(fuzz.oversampleFactor(), 4u);
+    EXPECT_EQ(fuzz.oversampleQuality(), OversampleQuality::Low);
+
+    // Unsupported factors fall back to the base rate
+    config.set("fuzz_oversample", true, 3);
+    fuzz.configure(config);
+    EXPECT_EQ(fuzz.oversampleFactor(), 1u);
+    EXPECT_FLOAT_EQ(fuzz.process(0.5f), 0.1f);
+}
+
+TEST(ShaperTableUnitTest, MatchesClosedFormAntiderivatives)
+{
+    const ShaperTable &tanh = Waveshaper::table(ShaperCurve::Tanh);
+    const ShaperTable &hard = Waveshaper::table(ShaperCurve::HardClip);
+    const double points[] = {-40.0, -3.3, -1.0, -0.4, 0.0, 0.01, 0.77, 1.0, 2.5, 15.9, 40.0};
+    for (double x : points)
+    {
+        EXPECT_NEAR(tanh.f(x), std::tanh(x), 1e-4) << x;
+        EXPECT_NEAR(tanh.F1(x), std::log(std::cosh(x)), 1e-9) << x;
+
+        // Hard clip: F1 = x^2/2 inside, |x| - 1/2 outside; F2 is odd
+        const double a = std::abs(x);
+        const double F1 = a <= 1.0 ? 0.5 * x * x : a - 0.5;
+        const double F2 = (a <= 1.0 ? a * a * a / 6.0 : 0.5 * a * a - 0.5 * a + 1.0 / 6.0) * (x < 0.0 ? -1.0 : 1.0);
+        EXPECT_NEAR(hard.F1(x), F1, 1e-9) << x;
+        EXPECT_NEAR(hard.F2(x), F2, 1e-9) << x;
+    }
+}
+
+TEST(WaveshaperUnitTest, AdaaFollowsTheCurveAtLowFrequency)
+{
+    const char *curves[] = {"hardclip", "tanh"};
+    for (const char *name : curves)
+    {
+        for (int order = 0; order <= 2; ++order)
+        {
+            Config config;
+            config.set("waveshaper", true, 400.0f);
+            config.set("waveshaper_curve", true, std::string(name));
+            config.set("waveshaper_adaa", true, order);
+            Waveshaper shaper;
+            ASSERT_TRUE(shaper.configure(config));
+
+            // 100 Hz: ADAA is f(x) delayed by order/2 samples, up to a small smoothing error
+            std::vector<float> signal(1000);
+            for (size_t i = 0; i < signal.size(); ++i)
+                signal[i] = 0.5f * std::sin(2.0f * static_cast<float>(M_PI) * 100.0f * i / 44100.0f);
+            std::vector<float> output = signal;
+            shaper.processBlock(output.data(), output.size());
+
+            const ShaperTable &table = Waveshaper::table(Waveshaper::parseCurve(name));
+            for (size_t i = 2; i < signal.size(); ++i)
+            {
+                const double delayed = order == 1 ? 0.5 * (signal[i] + signal[i - 1]) : signal[i - order / 2];
+                EXPECT_NEAR(output[i], table.f(4.0 * delayed), 1e-2) << name << " order " << order << " at " << i;
+            }
+        }
+    }
+}
+
+TEST(WaveshaperUnitTest, EditsKeepTheHistoryUnlessTheShapeChanges)
+{
+    Config config;
+    config.set("waveshaper", true, 400.0f);
+    config.set("waveshaper_adaa", true, 2);
+    Waveshaper whole, split;
+    ASSERT_TRUE(whole.configure(config));
+    ASSERT_TRUE(split.configure(config));
+
+    std::vector<float> signal(512);
+    for (size_t i = 0; i < signal.size(); ++i)
+        signal[i] = 0.5f * std::sin(0.07f * static_cast<float>(i));
+    std::vector<float> expected = signal, output = signal;
+    whole.processBlock(expected.data(), expected.size());
+
+    // Naming the curve it already uses changes nothing, so the second half carries on seamlessly
+    split.processBlock(output.data(), 256);
+    config.set("waveshaper_curve", true, std::string("tanh"));
+    ASSERT_TRUE(split.configure(config));
+    split.processBlock(output.data() + 256, 256);
+    for (size_t i = 0; i < output.size(); ++i)
+        ASSERT_EQ(output[i], expected[i]) << "sample " << i;
+
+    // A new curve starts from a clear history and stays within its range
+    config.set("waveshaper_curve", true, std::string("hardclip"));
+    ASSERT_TRUE(split.configure(config));
+    output = signal;
+    split.processBlock(output.data(), output.size());
+    for (float v : output)
+        ASSERT_LE(std::fabs(v), 1.0f + 1e-4f);
+}
+
+TEST(NoiseGateUnitTest, OpensAndClosesWithHysteresis)
+{
+    Config config;
+    config.set("noisegate", true, -40.0f);            // Opens at 0.01
+    config.set("noisegate_hysteresis", true, 12.0f);  // Holds open down to ~0.0025
+    config.set("noisegate_attack", true, 1.0f);
+    config.set("noisegate_hold", true, 10.0f);
+    config.set("noisegate_release", true, 10.0f);
+    NoiseGate gate;
+    ASSERT_TRUE(gate.configure(config));
+
+    auto run = [&](float amplitude, size_t frames) {
+        std::vector<float> block(frames);
+        for (size_t i = 0; i < frames; ++i)
+            block[i] = amplitude * std::sin(2.0f * static_cast<float>(M_PI) * 440.0f * i / 44100.0f);
+        for (size_t done = 0; done < frames; done += 256)
+            gate.processBlock(block.data() + done, std::min<size_t>(256, frames - done));
+        return block;
+    };
+
+    // Noise below the threshold stays muted
+    std::vector<float> out = run(0.005f, 4410);
+    EXPECT_FALSE(gate.isOpen());
+    EXPECT_EQ(*std::max_element(out.begin(), out.end()), 0.0f);
+
+    // Playing opens it within the attack time, then passes the signal untouched
+    out = run(0.5f, 4410);
+    EXPECT_TRUE(gate.isOpen());
+    EXPECT_FLOAT_EQ(gate.gain(), 1.0f);
+    EXPECT_NEAR(*std::max_element(out.begin() + 441, out.end()), 0.5f, 1e-3f);
+
+    // Editing a parameter mid-note leaves it open
+    config.set("noisegate_release", true, 20.0f);
+    ASSERT_TRUE(gate.configure(config));
+    EXPECT_TRUE(gate.isOpen());
+    EXPECT_FLOAT_EQ(gate.gain(), 1.0f);
+
+    // Decaying into the hysteresis band keeps it open
+    run(0.005f, 4410);
+    EXPECT_TRUE(gate.isOpen());
+
+    // Below the band it closes after hold + release
+    run(0.001f, 4410);
+    EXPECT_FALSE(gate.isOpen());
+    EXPECT_EQ(gate.gain(), 0.0f);
+
+    // Without a hold it still opens, and closes as soon as the level leaves the band
+    config.set("noisegate_hold", true, 0.0f);
+    ASSERT_TRUE(gate.configure(config));
+    out = run(0.5f, 4410);
+    EXPECT_TRUE(gate.isOpen());
+    EXPECT_NEAR(*std::max_element(out.begin() + 441, out.end()), 0.5f, 1e-3f);
+    run(0.001f, 4410);
+    EXPECT_FALSE(gate.isOpen());
+
+    // Keyed from a silent sidechain, a loud input stays muted
+    config.set("noisegate_sidechain", true, true);
+    ASSERT_TRUE(gate.configure(config));
+    const std::vector<float> silence(256, 0.0f);
+    std::vector<float> loud(256, 0.5f);
+    gate.setSidechain(silence.data());
+    gate.processBlock(loud.data(), loud.size());
+    EXPECT_FALSE(gate.isOpen());
+    EXPECT_EQ(loud[255], 0.0f);
+}
+
+TEST(LimiterUnitTest, NeverExceedsCeilingAndReportsLatency)
+{
+    Config config;
+    config.set("limiter", true, -1.0f);
+    config.set("limiter_lookahead", true, 2.0f);
+    Limiter limiter;
+    ASSERT_TRUE(limiter.configure(config));
+    EXPECT_EQ(limiter.latency(), 88u); // 2 ms at 44.1 kHz
+
+    // Quiet material only comes out delayed by the reported latency
+    std::vector<float> quiet(1024);
+    for (size_t i = 0; i < quiet.size(); ++i)
+        quiet[i] = 0.3f * std::sin(0.05f * i);
+    std::vector<float> out = quiet;
+    limiter.processBlock(out.data(), out.size());
+    for (size_t i = limiter.latency(); i < out.size(); ++i)
+    {
+        ASSERT_FLOAT_EQ(out[i], quiet[i - limiter.latency()]);
+    }
+
+    // Stacked voices with bursts up to +12 dB, in awkward block sizes
+    const float ceiling = std::pow(10.0f, -1.0f / 20.0f);
+    const size_t blocks[] = {1, 37, 256, 5, 100, 64};
+    size_t t = 0;
+    for (int round = 0; round < 200; ++round)
+    {
+        std::vector<float> block(blocks[round % 6]);
+        for (float &v : block)
+        {
+            const float burst = (t / 700) % 3 == 0 ? 4.0f : 0.5f;
+            v = burst * std::sin(0.031f * t) * std::sin(0.0071f * t + 1.0f);
+            ++t;
+        }
+        limiter.processBlock(block.data(), block.size());
+        for (float v : block)
+        {
+            ASSERT_LE(std::abs(v), ceiling);
+        }
+    }
+    EXPECT_LT(limiter.gain(), 1.0f);
+
+    // Compressor: a steady 0.5 sine, 4:1 above -12 dBFS, settles at (0.5 / 0.251)^-0.75
+    config.set("limiter_threshold", true, -12.0f);
+    config.set("limiter_ratio", true, 4.0f);
+    ASSERT_TRUE(limiter.configure(config));
+    std::vector<float> steady(44100);
+    for (size_t i = 0; i < steady.size(); ++i)
+        steady[i] = 0.5f * std::sin(2.0f * static_cast<float>(M_PI) * 440.0f * i / 44100.0f);
+    limiter.processBlock(steady.data(), steady.size());
+    EXPECT_NEAR(limiter.gain(), std::pow(0.5f / std::pow(10.0f, -12.0f / 20.0f), -0.75f), 0.02f);
+
+    // A release edit keeps the gain reduction; a lookahead edit is reported at once
+    // and taken by the next block, which starts from a clear state
+    const float reduced = limiter.gain();
+    config.set("limiter_release", true, 80.0f);
+    config.set("limiter_lookahead", true, 1.0f);
+    ASSERT_TRUE(limiter.configure(config));
+    EXPECT_EQ(limiter.gain(), reduced);
+    EXPECT_EQ(limiter.latency(), 44u);
+    std::vector<float> silence(64, 0.0f);
+    limiter.processBlock(silence.data(), silence.size());
+    EXPECT_EQ(limiter.gain(), 1.0f);
+}
+
+TEST(DelayUnitTest, EchoesAtFractionalTimeWithFeedback)
+{
+    Config config;
+    config.set("delay", true, 10.01f); // 441.441 samples
+    config.set("delay_feedback", true, 0.5f);
+    config.set("delay_mix", true, 1.0f);
+    Delay delay;
+    ASSERT_TRUE(delay.configure(config));
+    const size_t capacity = delay.capacity();
+    EXPECT_GE(capacity, static_cast<size_t>(2 * 48000));
+    EXPECT_EQ(capacity & (capacity - 1), 0u);
+
+    std::vector<float> out(2048, 0.0f);
+    out[0] = 1.0f;
+    for (size_t done = 0; done < out.size(); done += 100)
+        delay.processBlock(out.data() + done, std::min<size_t>(100, out.size() - done));
+
+    // The dry impulse, then echoes spread over neighbouring samples by the cubic, each halved
+    auto energy = [&](size_t from, size_t to) {
+        float sum = 0.0f;
+        for (size_t i = from; i < to; ++i)
+            sum += out[i];
+        return sum;
+    };
+    EXPECT_FLOAT_EQ(out[0], 1.0f);
+    EXPECT_NEAR(energy(1, 438), 0.0f, 1e-6f);
+    EXPECT_NEAR(energy(438, 446), 1.0f, 1e-3f);
+    EXPECT_NEAR(energy(446, 870), 0.0f, 1e-3f);
+    EXPECT_NEAR(energy(870, 1000), 0.5f, 1e-2f);
+
+    // A new time glides without reallocating, and the line keeps ringing
+    config.set("delay", true, 25.0f);
+    ASSERT_TRUE(delay.configure(config));
+    EXPECT_EQ(delay.capacity(), capacity);
+    std::vector<float> tail(4096, 0.0f);
+    delay.processBlock(tail.data(), tail.size());
+    EXPECT_GT(*std::max_element(tail.begin(), tail.end()), 1e-3f);
+}
+
+TEST_F(DSPTest, PrepareFollowsTheStreamRate)
+{
+    // Times are kept in milliseconds, so a new rate moves the echo in samples
+    Config delayConfig;
+    delayConfig.set("delay", true, 10.0f);
+    delayConfig.set("delay_feedback", true, 0.0f);
+    delayConfig.set("delay_mix", true, 1.0f);
+    Delay delay;
+    ASSERT_TRUE(delay.configure(delayConfig));
+    const size_t capacity = delay.capacity();
+    delay.prepare(96000.0f, MAX_BLOCK_SIZE, 1);
+    EXPECT_FLOAT_EQ(delay.sampleRate(), 96000.0f);
+    EXPECT_GE(delay.capacity(), static_cast<size_t>(2 * 96000));
+    EXPECT_GT(delay.capacity(), capacity);
+
+    std::vector<float> echo(2048, 0.0f);
+    echo[0] = 1.0f;
+    delay.processBlock(echo.data(), echo.size());
+    const auto peak = std::max_element(echo.begin() + 1, echo.end()) - echo.begin();
+    EXPECT_NEAR(static_cast<float>(peak), 960.0f, 1.0f);
+
+    // The chain only re-prepares for a new format
+    EXPECT_FALSE(chain->prepare(DEFAULT_SAMPLE_RATE, MAX_BLOCK_SIZE));
+    EXPECT_TRUE(chain->prepare(48000.0f, 64));
+    EXPECT_FALSE(chain->prepare(48000.0f, 64));
+    EXPECT_FLOAT_EQ(chain->sampleRate(), 48000.0f);
+
+    // Released, it passes audio through untouched until prepared again
+    std::vector<float> input(64, 0.1f), block(input);
+    float *mono[1] = {block.data()};
+    chain->release();
+    chain->processBlock(mono, 1, 1, block.size());
+    EXPECT_EQ(block, input);
+
+    EXPECT_TRUE(chain->prepare(48000.0f, 64));
+    chain->processBlock(mono, 1, 1, block.size());
+    EXPECT_NE(block, input);
+}
+
+TEST(ReverbUnitTest, DecaysAtConfiguredRate)
+{
+    for (int lines : {8, 16})
+    {
+        for (const char *matrix : {"hadamard", "householder"})
+        {
+            Config config;
+            config.set("reverb", true, 1.0f);
+            config.set("reverb_mix", true, 1.0f);
+            config.set("reverb_damping", true, 0.0f);
+            config.set("reverb_modulation", true, 0.0f);
+            config.set("reverb_lines", true, lines);
+            config.set("reverb_matrix", true, std::string(matrix));
+            Reverb reverb;
+            ASSERT_TRUE(reverb.configure(config));
+            ASSERT_EQ(reverb.lineCount(), static_cast<size_t>(lines));
+
+            std::vector<float> out(44100, 0.0f);
+            out[0] = 1.0f;
+            for (size_t done = 0; done < out.size(); done += 256)
+                reverb.processBlock(out.data() + done, std::min<size_t>(256, out.size() - done));
+
+            auto energyDb = [&](size_t from, size_t to) {
+                double sum = 0.0;
+                for (size_t i = from; i < to; ++i)
+                    sum += static_cast<double>(out[i]) * out[i];
+                return 10.0 * std::log10(sum);
+            };
+            // RT60 of 1 s: 30 dB down half a second later
+            const double drop = energyDb(8820, 13230) - energyDb(30870, 35280);
+            EXPECT_NEAR(drop, 30.0, 3.0) << lines << " lines, " << matrix;
+        }
+    }
+}
+
+TEST(ConvolverUnitTest, MatchesDirectConvolutionAtAnyBlockSize)
+{
+    // A decaying noise IR written as a float WAV
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    std::vector<float> ir(1000);
+    for (size_t i = 0; i < ir.size(); ++i)
+        ir[i] = noise(rng) * std::exp(-static_cast<float>(i) / 200.0f);
+
+    const std::string path = "/tmp/pedal_ir_test.wav";
+    SF_INFO info = {};
+    info.samplerate = 44100;
+    info.channels = 1;
+    info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+    SNDFILE *file = sf_open(path.c_str(), SFM_WRITE, &info);
+    ASSERT_NE(file, nullptr);
+    sf_write_float(file, ir.data(), ir.size());
+    sf_close(file);
+
+    Config config;
+    config.set("convolver", true, path);
+    config.set("convolver_partition", true, 64);
+    Convolver convolver;
+    ASSERT_TRUE(convolver.configure(config));
+    ASSERT_NE(convolver.built(), nullptr);
+    EXPECT_EQ(convolver.built()->tailPartitions(), 15u); // 999 taps after the head
+    EXPECT_EQ(convolver.latency(), 0u);
+
+    std::vector<float> in(5000);
+    for (float &x : in)
+        x = noise(rng);
+    std::vector<float> out = in;
+    const size_t blocks[] = {1, 37, 256, 64, 3, 129};
+    for (size_t done = 0, b = 0; done < out.size(); ++b)
+    {
+        const size_t n = std::min(blocks[b % 6], out.size() - done);
+        convolver.processBlock(out.data() + done, n);
+        done += n;
+    }
+
+    for (size_t i = 0; i < in.size(); ++i)
+    {
+        double expected = 0.0;
+        for (size_t k = 0; k < ir.size() && k <= i; ++k)
+            expected += static_cast<double>(ir[k]) * in[i - k];
+        ASSERT_NEAR(out[i], expected, 1e-4) << "sample " << i;
+    }
+
+    // A missing IR keeps the previous one
+    const PartitionedConvolution *previous = convolver.built();
+    config.set("convolver", true, std::string("/tmp/pedal_no_such_ir.wav"));
+    convolver.configure(config);
+    EXPECT_EQ(convolver.built(), previous);
+    std::remove(path.c_str());
+    std::remove((path + ".44100-64.irc").c_str());
+}
+
+TEST(PartitionCacheUnitTest, MapsWhatWasWrittenAndRejectsStaleFiles)
+{
+    std::vector<float> ir(3000);
+    for (size_t i = 0; i < ir.size(); ++i)
+        ir[i] = std::sin(0.05f * i) * std::exp(-static_cast<float>(i) / 500.0f);
+    const PartitionedConvolution built(ir, 128);
+
+    const PartitionCacheKey key{0x1234, 44100, 128};
+    const std::string path = PartitionCache::pathFor("/tmp/pedal_cab.wav", key);
+    EXPECT_EQ(path, "/tmp/pedal_cab.wav.44100-128.irc");
+    ASSERT_TRUE(PartitionCache::write(path, key, built.spectra()));
+
+    std::shared_ptr<const PartitionCache> cache = PartitionCache::map(path, key);
+    ASSERT_NE(cache, nullptr);
+    const PartitionSpectra &mapped = cache->spectra();
+    ASSERT_EQ(mapped.taps, ir.size());
+    ASSERT_EQ(mapped.partitions, built.tailPartitions());
+    const size_t bins = mapped.partitions * 129;
+    EXPECT_TRUE(std::equal(mapped.head, mapped.head + 128, built.spectra().head));
+    EXPECT_TRUE(std::equal(mapped.re, mapped.re + bins, built.spectra().re));
+    EXPECT_TRUE(std::equal(mapped.im, mapped.im + bins, built.spectra().im));
+
+    // An engine on the mapping sounds exactly like the one it was saved from
+    PartitionedConvolution fromCache(mapped, cache);
+    PartitionedConvolution original(ir, 128);
+    std::vector<float> a(2000), b(2000);
+    for (size_t i = 0; i < a.size(); ++i)
+        a[i] = b[i] = std::sin(0.01f * i * i);
+    original.process(a.data(), a.size());
+    fromCache.process(b.data(), b.size());
+    EXPECT_EQ(a, b);
+
+    // Another IR, rate or partition size, or a truncated file, is not used
+    EXPECT_EQ(PartitionCache::map(path, {0x1235, 44100, 128}), nullptr);
+    EXPECT_EQ(PartitionCache::map(path, {0x1234, 48000, 128}), nullptr);
+    EXPECT_EQ(PartitionCache::map(path, {0x1234, 44100, 64}), nullptr);
+    truncate(path.c_str(), PartitionCache::HEADER_SIZE + 100);
+    EXPECT_EQ(PartitionCache::map(path, key), nullptr);
+    std::remove(path.c_str());
+}
+
+TEST(EQUnitTest, PipelinedSectionsMatchSerialCascade)
+{
+    const char *specs[] = {"highpass 80", "lowshelf 200 3.0", "peak 1000 6.0 1.0", "highshelf 5000 -4.0",
+                           "lowpass 9000"};
+    Config config;
+    config.set("eq", true, -2.0f);
+    for (size_t i = 0; i < 5; ++i)
+        config.set("eq_" + std::to_string(i + 1), true, std::string(specs[i]));
+    config.set("eq_6", true, std::string("bogus 100")); // Skipped
+    EQ eq;
+    ASSERT_TRUE(eq.configure(config));
+    ASSERT_EQ(eq.sectionCount(), 5u);
+
+    // Reference: the same bands one after another, in double
+    EQ::Coefficients c;
+    const EQBand types[] = {EQBand::HighPass, EQBand::LowShelf, EQBand::Peak, EQBand::HighShelf, EQBand::LowPass};
+    const float hz[] = {80, 200, 1000, 5000, 9000}, db[] = {0, 3, 6, -4, 0}, q[] = {0.707f, 0.707f, 1, 0.707f, 0.707f};
+    for (size_t s = 0; s < 5; ++s)
+        EQ::design(c, s, types[s], hz[s], db[s], q[s], 44100.0f);
+    double z1[5] = {}, z2[5] = {};
+    auto reference = [&](double x) {
+        for (size_t s = 0; s < 5; ++s)
+        {
+            const double y = c.b0[s] * x + z1[s];
+            z1[s] = c.b1[s] * x - c.a1[s] * y + z2[s];
+            z2[s] = c.b2[s] * x - c.a2[s] * y;
+            x = y;
+        }
+        return x * std::pow(10.0, -2.0 / 20.0);
+    };
+
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    std::vector<float> in(4000);
+    for (float &x : in)
+        x = noise(rng);
+    std::vector<float> out = in;
+    const size_t blocks[] = {1, 2, 3, 256, 7, 64};
+    for (size_t done = 0, b = 0; done < out.size(); ++b)
+    {
+        const size_t n = std::min(blocks[b % 6], out.size() - done);
+        eq.processBlock(out.data() + done, n);
+        done += n;
+    }
+    for (size_t i = 0; i < in.size(); ++i)
+        ASSERT_NEAR(out[i], reference(in[i]), 1e-4) << "sample " << i;
+
+    // The 1 kHz bell boosts by its 6 dB (minus the 2 dB output level, give or take the shelves)
+    std::vector<float> tone(8820);
+    for (size_t i = 0; i < tone.size(); ++i)
+        tone[i] = 0.1f * std::sin(2.0f * static_cast<float>(M_PI) * 1000.0f * i / 44100.0f);
+    eq.processBlock(tone.data(), tone.size());
+    float peak = 0.0f;
+    for (size_t i = 4410; i < tone.size(); ++i)
+        peak = std::max(peak, std::fabs(tone[i]));
+    EXPECT_NEAR(20.0f * std::log10(peak / 0.1f), 4.0f, 1.0f);
+}
+
+TEST(ChorusUnitTest, TableLfoAndSweptReadsFeedTheFlanger)
+{
+    // The shared table against std::sin, across the wrap; most of the tolerance is the fixed-point rate drifting
+    WavetableLFO lfo;
+    lfo.setRate(3.7f, 44100.0f);
+    lfo.setPhase(0.9f);
+    std::vector<float> values(30000);
+    lfo.render(values.data(), values.size());
+    for (size_t i = 0; i < values.size(); ++i)
+        ASSERT_NEAR(values[i], std::sin(2.0 * M_PI * (0.9 + 3.7 * i / 44100.0)), 3e-5) << "sample " << i;
+
+    // Slow (windowed) and fast sweeps match per-tap lookups
+    DelayLine line;
+    line.allocate(4096);
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    std::vector<float> history(3000);
+    for (float &x : history)
+        x = noise(rng);
+    line.write(history.data(), history.size());
+    for (float slope : {0.02f, -0.03f, 0.37f})
+    {
+        float delays[100], out[100];
+        for (size_t i = 0; i < 100; ++i)
+            delays[i] = 300.25f + slope * i;
+        line.readModulated(out, delays, 100);
+        for (size_t i = 0; i < 100; ++i)
+        {
+            const size_t whole = static_cast<size_t>(delays[i]), age = whole + 2 - i;
+            const float u = 1.0f - (delays[i] - whole);
+            ASSERT_NEAR(out[i], cubicInterpolate(line.at(age), line.at(age - 1), line.at(age - 2), line.at(age - 3), u),
+                        1e-6f)
+                << "slope " << slope << " sample " << i;
+        }
+    }
+
+    // A still flanger at 2 ms (88.2 samples) with feedback repeats an impulse, halving it
+    Config config;
+    config.set("chorus", true, 1.0f);
+    config.set("chorus_mode", true, std::string("flanger"));
+    config.set("chorus_depth", true, 0.0f);
+    config.set("chorus_delay", true, 2.0f);
+    config.set("chorus_feedback", true, 0.5f);
+    config.set("chorus_mix", true, 1.0f);
+    Chorus chorus;
+    ASSERT_TRUE(chorus.configure(config));
+    EXPECT_EQ(chorus.voiceCount(), 1u);
+
+    std::vector<float> signal(400, 0.0f);
+    signal[0] = 1.0f;
+    for (size_t done = 0; done < signal.size(); done += 37)
+        chorus.processBlock(signal.data() + done, std::min<size_t>(37, signal.size() - done));
+    auto energy = [&](size_t from, size_t to) {
+        return std::accumulate(signal.begin() + from, signal.begin() + to, 0.0f);
+    };
+    EXPECT_FLOAT_EQ(signal[0], 1.0f);
+    EXPECT_NEAR(energy(1, 85), 0.0f, 1e-6f);
+    EXPECT_NEAR(energy(85, 93), 1.0f, 1e-3f);
+    EXPECT_NEAR(energy(93, 173), 0.0f, 1e-3f);
+    EXPECT_NEAR(energy(173, 181), 0.5f, 1e-2f);
+}
+
+TEST(PitchDetectorUnitTest, TracksGuitarRangeAcrossHops)
+{
+    for (size_t decimation : {1, 2})
+    {
+        for (float hz : {82.41f, 110.0f, 196.0f, 329.63f, 440.0f, 987.77f})
+        {
+            PitchDetector detector(44100.0f, decimation);
+            // A bright tone: ten harmonics, the second stronger than the fundamental
+            std::vector<float> block(64);
+            size_t t = 0;
+            for (size_t b = 0; b < 80; ++b)
+            {
+                for (float &x : block)
+                {
+                    x = 0.0f;
+                    for (int k = 1; k <= 10; ++k)
+                        x += (k == 2 ? 0.6f : 0.4f / k) * std::sin(2.0f * static_cast<float>(M_PI) * hz * k * t / 44100.0f);
+                    ++t;
+                }
+                detector.push(block.data(), block.size());
+            }
+            // First frame after a frame's worth of input, then one per hop; the last is still being analysed
+            EXPECT_EQ(detector.estimates(), (t - detector.frameLength()) / detector.hopLength());
+            EXPECT_NEAR(detector.frequency(), hz, hz * 0.002f) << hz << " Hz, decimation " << decimation;
+            EXPECT_GT(detector.periodicity(), 0.9f);
+        }
+    }
+
+    // Silence has no pitch
+    PitchDetector detector(44100.0f);
+    std::vector<float> silence(detector.frameLength() + detector.hopLength(), 0.0f);
+    detector.push(silence.data(), silence.size());
+    EXPECT_EQ(detector.frequency(), 0.0f);
+}
+
+TEST(HarmonizerUnitTest, DiatonicIntervalsFollowTheKey)
+{
+    HarmonyKey key;
+    ASSERT_TRUE(Harmonizer::parseKey("C", key));
+    EXPECT_TRUE(key.enabled);
+    // A third above C, E and B in C major: major, minor, minor
+    EXPECT_EQ(Harmonizer::diatonicShift(key, 60, 2), 4);
+    EXPECT_EQ(Harmonizer::diatonicShift(key, 64, 2), 3);
+    EXPECT_EQ(Harmonizer::diatonicShift(key, 71, 2), 3);
+    // A fifth above B is diminished; an octave is always 12; a third below E lands on C
+    EXPECT_EQ(Harmonizer::diatonicShift(key, 71, 4), 6);
+    EXPECT_EQ(Harmonizer::diatonicShift(key, 64, 7), 12);
+    EXPECT_EQ(Harmonizer::diatonicShift(key, 64, -2), -4);
+    EXPECT_EQ(Harmonizer::diatonicShift(key, 64, -9), -16);
+    // C# is off the scale: harmonised from C, landing on E
+    EXPECT_EQ(Harmonizer::diatonicShift(key, 61, 2), 3);
+
+    ASSERT_TRUE(Harmonizer::parseKey("A minor", key));
+    EXPECT_EQ(key.tonic, 9);
+    EXPECT_EQ(Harmonizer::diatonicShift(key, 57, 2), 3); // A -> C
+    EXPECT_EQ(Harmonizer::diatonicShift(key, 60, 2), 4); // C -> E
+    ASSERT_TRUE(Harmonizer::parseKey("Bb harmonic minor", key));
+    EXPECT_EQ(key.tonic, 10);
+    EXPECT_EQ(Harmonizer::diatonicShift(key, 65, 2), 4); // F -> the raised seventh, A
+
+    EXPECT_FALSE(Harmonizer::parseKey("H major", key));
+    EXPECT_FALSE(Harmonizer::parseKey("C bebop", key));
+    EXPECT_EQ(key.tonic, 10);
+}
+
+TEST(TunerUnitTest, RingFeedsTheAnalysisThread)
+{
+    // A full ring truncates writes; reads wrap in order
+    SpscRing<float> ring;
+    ring.allocate(100);
+    ASSERT_EQ(ring.capacity(), 128u);
+    std::vector<float> data(200), out(200);
+    std::iota(data.begin(), data.end(), 0.0f);
+    EXPECT_EQ(ring.write(data.data(), 200), 128u);
+    EXPECT_EQ(ring.read(out.data(), 100), 100u);
+    EXPECT_EQ(ring.write(data.data() + 128, 72), 72u);
+    EXPECT_EQ(ring.read(out.data() + 100, 200), 100u);
+    EXPECT_EQ(out, std::vector<float>(data.begin(), data.end()));
+    EXPECT_EQ(ring.size(), 0u);
+
+    TunerReading low = Tuner::classify(82.41f, 440.0f);
+    EXPECT_EQ(low.note, 40); // E2
+    EXPECT_NEAR(low.cents, 0.0f, 0.1f);
+    TunerReading sharp = Tuner::classify(445.0f, 440.0f);
+    EXPECT_EQ(sharp.note, 69);
+    EXPECT_NEAR(sharp.cents, 19.56f, 0.01f);
+    EXPECT_EQ(Tuner::classify(0.0f, 440.0f).note, -1);
+
+    Config config;
+    config.set("tuner", true, 440.0f);
+    config.set("tuner_mute", true, true);
+    Tuner tuner;
+    std::mutex readingMutex;
+    TunerReading latest;
+    size_t readings = 0;
+    tuner.setListener([&](const TunerReading &reading) {
+        std::lock_guard<std::mutex> lock(readingMutex);
+        latest = reading;
+        ++readings;
+    });
+    ASSERT_TRUE(tuner.configure(config));
+
+    // A2 ten cents sharp, fed at about twice real time until the thread has shown a few readings
+    const float hz = 110.0f * std::pow(2.0f, 10.0f / 1200.0f);
+    std::vector<float> block(1024);
+    size_t t = 0;
+    for (int i = 0; i < 200; ++i)
+    {
+        for (float &x : block)
+            x = 0.5f * std::sin(2.0f * static_cast<float>(M_PI) * hz * static_cast<float>(t++) / 44100.0f);
+        tuner.processBlock(block.data(), block.size());
+        EXPECT_EQ(*std::max_element(block.begin(), block.end()), 0.0f); // Muted
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        std::lock_guard<std::mutex> lock(readingMutex);
+        if (readings >= 3 && latest.note == 45)
+            break;
+    }
+    {
+        std::lock_guard<std::mutex> lock(readingMutex);
+        EXPECT_EQ(latest.note, 45);
+        EXPECT_NEAR(latest.cents, 10.0f, 1.0f);
+        EXPECT_GT(latest.clarity, 0.9f);
+    }
+
+    // Switched off, the thread stops and the input passes untouched
+    config.set("tuner", false, 440.0f);
+    ASSERT_TRUE(tuner.configure(config));
+    EXPECT_FALSE(tuner.isActive());
+    block.assign(block.size(), 0.25f);
+    tuner.processBlock(block.data(), block.size());
+    EXPECT_EQ(block[0], 0.25f);
+}
+
+TEST(LooperUnitTest, LoopsAtExactSamplesAndRestoresFromDisk)
+{
+    const std::string path = "/tmp/pedal_test_loop.wav";
+    std::remove(path.c_str());
+    Config config;
+    config.set("looper", true, 1.0f);
+    config.set("looper_file", true, path);
+    config.set("looper_minutes", true, 0.01f); // 26460 samples
+
+    // Blocks of 64 against a 1000-sample loop: boundaries fall mid-block
+    size_t t = 0;
+    auto run = [&](Looper &looper, size_t frames, float input) {
+        std::vector<float> out;
+        std::vector<float> block(64);
+        for (size_t done = 0; done < frames; done += block.size())
+        {
+            const size_t n = std::min(block.size(), frames - done);
+            for (size_t i = 0; i < n; ++i)
+                block[i] = input < 0.0f ? static_cast<float>(t + i) : input; // input < 0: a ramp
+            looper.processBlock(block.data(), n);
+            out.insert(out.end(), block.begin(), block.begin() + n);
+            t += n;
+        }
+        return out;
+    };
+
+    {
+        Looper looper;
+        ASSERT_TRUE(looper.configure(config));
+        EXPECT_EQ(looper.state(), Looper::State::Empty);
+
+        looper.press();
+        t = 0;
+        run(looper, 1000, -1.0f); // Records 0..999
+        looper.press();
+        std::vector<float> out = run(looper, 2500, 0.0f);
+        EXPECT_EQ(looper.state(), Looper::State::Playing);
+        ASSERT_EQ(looper.length(), 1000u);
+        for (size_t i = 0; i < out.size(); ++i)
+            ASSERT_EQ(out[i], static_cast<float>(i % 1000)) << i;
+
+        // Overdub a constant from loop sample 500 for one lap
+        looper.press();
+        out = run(looper, 1000, 1.0f);
+        EXPECT_EQ(out[0], 501.0f);
+        EXPECT_EQ(out[999], 500.0f);
+        looper.press();
+        EXPECT_EQ(run(looper, 1, 0.0f)[0], 501.0f);
+        looper.flush();
+    }
+
+    // A new looper restores the overdubbed loop, stopped until pressed
+    Looper restored;
+    ASSERT_TRUE(restored.configure(config));
+    EXPECT_EQ(restored.state(), Looper::State::Stopped);
+    ASSERT_EQ(restored.length(), 1000u);
+    std::vector<float> out = run(restored, 10, 0.0f);
+    EXPECT_EQ(out[3], 0.0f);
+    restored.press();
+    out = run(restored, 1000, 0.0f);
+    for (size_t i = 0; i < out.size(); ++i)
+        ASSERT_EQ(out[i], static_cast<float>(i) + 1.0f) << i;
+
+    // A new rate resizes the buffer and keeps the loop; after release() the next prepare() restores it
+    restored.prepare(2.0f * DEFAULT_SAMPLE_RATE, MAX_BLOCK_SIZE, 1);
+    EXPECT_EQ(restored.length(), 1000u);
+    restored.release();
+    EXPECT_EQ(restored.length(), 0u);
+    restored.prepare(DEFAULT_SAMPLE_RATE, MAX_BLOCK_SIZE, 1);
+    EXPECT_EQ(restored.state(), Looper::State::Stopped);
+    ASSERT_EQ(restored.length(), 1000u);
+
+    // Clearing removes the file
+    restored.clear();
+    run(restored, 1, 0.0f);
+    EXPECT_EQ(restored.state(), Looper::State::Empty);
+    restored.flush();
+    std::ifstream gone(path);
+    EXPECT_FALSE(gone.good());
+}
+
+TEST(DisplayUnitTest, PagePrimitivesMatchPixelDrawing)
+{
+    // Rectangles and checkerboards written a page at a time against the same shapes set pixel by pixel
+    const size_t size = WIDTH * HEIGHT / 8;
+    std::mt19937 random(7);
+    for (int trial = 0; trial < 500; ++trial)
+    {
+        int x = static_cast<int>(random() % 140) - 6, y = static_cast<int>(random() % 40) - 4;
+        int w = static_cast<int>(random() % 20), h = static_cast<int>(random() % 20);
+        char mode = static_cast<char>(random() & 1);
+        bool checker = random() & 1;
+
+        SSD1305_copy(piano_screen);
+        for (int i = std::max(x, 0); i < x + w; ++i)
+        {
+            for (int j = std::max(y, 0); j < y + h; ++j)
+            {
+                if (!checker)
+                    SSD1305_pixel(i, j, mode);
+                else if ((i + j) % 2 == 0)
+                    SSD1305_pixel(i, j, mode);
+                else if (mode)
+                    SSD1305_pixel(i, j, 0);
+            }
+        }
+        std::vector<unsigned char> expected(SSD1305_framebuffer(), SSD1305_framebuffer() + size);
+
+        SSD1305_copy(piano_screen);
+        if (checker)
+            SSD1305_checker_rect(x, y, w, h, mode);
+        else
+            SSD1305_fill_rect(x, y, w, h, mode);
+        ASSERT_TRUE(std::equal(expected.begin(), expected.end(), SSD1305_framebuffer()))
+            << "x " << x << " y " << y << " w " << w << " h " << h << " checker " << checker;
+    }
+
+    // Keys come from the layout: the central C, its sharp and the top E; off the keyboard falls back
+    EXPECT_FALSE(Display::keyGeometry(0).black);
+    EXPECT_EQ(Display::keyGeometry(0).x, KEY0_X_POSITION + 3);
+    EXPECT_TRUE(Display::keyGeometry(1).black);
+    EXPECT_EQ(Display::keyGeometry(1).x, 65);
+    EXPECT_EQ(Display::keyGeometry(HIGHEST_NOTE).x, KEY0_X_POSITION + 3 + 10 * WHITE_KEY_WIDTH);
+    EXPECT_EQ(Display::keyGeometry(HIGHEST_NOTE + 1).x, KEY0_X_POSITION);
+}
+
+TEST(DisplayUnitTest, HeadlessPianoScreenMatchesSnapshot)
+{
+    // Drawn without the panel and dumped as it would be shown; regenerate with UPDATE_SNAPSHOTS=1
+    const std::string snapshot = ASSET_PATH + "/piano_snapshot.pbm";
+    char dir[] = "/tmp/pedal_framesXXXXXX";
+    ASSERT_NE(mkdtemp(dir), nullptr);
+
+    Display display;
+    ASSERT_TRUE(display.init(DisplayBackend::Headless));
+    display.setDumpDirectory(dir);
+    int notes[] = {-12, 0, 4, 7, 10};
+    display.setSelectedNotes(notes, 5);
+    display.setCursor(6);
+    display.update("Fuzz", 0.42f, true);
+
+    const std::string frame = std::string(dir) + "/frame_00000.pbm";
+    auto contents = [](const std::string &path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    };
+    const std::string drawn = contents(frame);
+    ASSERT_EQ(drawn.size(), std::string("P4\n128 32\n").size() + WIDTH * HEIGHT / 8);
+    if (std::getenv("UPDATE_SNAPSHOTS"))
+        std::ofstream(snapshot, std::ios::binary) << drawn;
+
+    ASSERT_EQ(drawn, contents(snapshot)) << "the frame drawn is left at " << frame;
+    std::remove(frame.c_str());
+    rmdir(dir);
+}
+
+/**
+ * @brief Runs effects on the audio path with the real-time safety checker linked in,
+ *        so anything that allocates, locks or blocks while processing fails the test.
+ */
+class RealtimeSafetyTest : public ::testing::Test
+{
+protected:
+    static constexpr size_t PERIOD = 11; ///< Frames per period on the pedal (AudioIO::FRAMES)
+    Config config;
+
+    void SetUp() override
+    {
+        ASSERT_TRUE(RealtimeCheck::enabled());
+        RealtimeCheck::setAbort(false);
+
+        // A short IR for the convolver
+        const std::string irPath = "/tmp/pedal_rt_ir.wav";
+        SF_INFO info = {};
+        info.samplerate = 44100;
+        info.channels = 1;
+        info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+        SNDFILE *file = sf_open(irPath.c_str(), SFM_WRITE, &info);
+        ASSERT_NE(file, nullptr);
+        std::vector<float> ir(600);
+        for (size_t i = 0; i < ir.size(); ++i)
+            ir[i] = std::exp(-static_cast<float>(i) / 100.0f) * (i % 2 ? -0.5f : 0.5f);
+        sf_write_float(file, ir.data(), ir.size());
+        sf_close(file);
+
+        // Every effect switched on; a registered effect missing here fails the test
+        config.set("fuzz", true, 100.0f);
+        config.set("fuzz_oversample", true, 4);
+        config.set("gain", true, 120.0f);
+        config.set("harmonizer", true, std::string("2 4"));
+        config.set("harmonizer_key", true, std::string("A minor"));
+        config.set("waveshaper", true, 400.0f);
+        config.set("eq", true, 0.0f);
+        config.set("eq_1", true, std::string("peak 800 6 1"));
+        config.set("noisegate", true, -50.0f);
+        config.set("convolver", true, irPath);
+        config.set("convolver_partition", true, 64);
+        config.set("convolver_cache", true, false);
+        config.set("chorus", true, 0.8f);
+        config.set("delay", true, 5.0f);
+        config.set("delay_depth", true, 0.5f);
+        config.set("reverb", true, 1.5f);
+        config.set("looper", true, 1.0f);
+        config.set("looper_file", true, std::string("/tmp/pedal_rt_loop.wav"));
+        config.set("looper_minutes", true, 0.01f);
+        config.set("limiter", true, -1.0f);
+        config.set("tuner", true, 440.0f);
+        config.set("route", false, std::string(""));
+        RealtimeCheck::clearViolations();
+    }
+
+    /**
+     * @brief Feeds `blocks` blocks of noise to `effect` in as many channels as it takes.
+     */
+    static void run(Effect &effect, size_t blocks, size_t frames)
+    {
+        std::mt19937 rng(5);
+        std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+        std::vector<float> left(frames), right(frames);
+        float *channels[2] = {left.data(), right.data()};
+        const size_t count = effect.channelLayout() == ChannelLayout::Mono ? 1 : 2;
+        for (size_t b = 0; b < blocks; ++b)
+        {
+            for (size_t i = 0; i < frames; ++i)
+                left[i] = right[i] = noise(rng);
+            RealtimeScope realtime;
+            effect.processChannels(channels, count, frames);
+        }
+    }
+};
+
+TEST_F(RealtimeSafetyTest, ReportsAllocationOnlyInScope)
+{
+    void *volatile outside = std::malloc(64);
+    std::free(outside);
+    EXPECT_EQ(RealtimeCheck::violations(), 0u);
+
+    {
+        RealtimeScope realtime;
+        void *volatile inside = std::malloc(64);
+        std::free(inside);
+        std::fflush(stdout);
+    }
+    EXPECT_EQ(RealtimeCheck::violations(), 3u);
+}
+
+TEST_F(RealtimeSafetyTest, EveryRegisteredEffectProcessesWithoutViolations)
+{
+    for (const EffectInfo &info : EffectRegistry::table)
+    {
+        SCOPED_TRACE(info.name);
+        std::shared_ptr<Effect> effect = info.create();
+        effect->configure(config);
+        ASSERT_TRUE(effect->isActive()) << "Switch " << info.name << " on in RealtimeSafetyTest";
+        if (auto *looper = dynamic_cast<Looper *>(effect.get()))
+        {
+            looper->clear();
+            run(*looper, 4, 64);
+            looper->press(); // Record, then play it back
+            run(*looper, 100, 64);
+            looper->press();
+        }
+
+        run(*effect, 200, PERIOD);
+        run(*effect, 40, MAX_BLOCK_SIZE);
+        EXPECT_EQ(RealtimeCheck::violations(), 0u);
+        RealtimeCheck::clearViolations();
+    }
+
+    // And all of them in one chain, fused stages and parallel branches included
+    DigitalSignalChain chain;
+    config.set("route", true, std::string("noisegate gain fuzz [harmonizer | chorus] waveshaper eq convolver delay "
+                                          "reverb looper limiter tuner"));
+    chain.configureEffects(config);
+    std::vector<float> left(PERIOD, 0.1f), right(PERIOD, 0.1f);
+    float *channels[2] = {left.data(), right.data()};
+    for (int b = 0; b < 400; ++b)
+        chain.processBlock(channels, 1, 2, left.size());
+    EXPECT_EQ(RealtimeCheck::violations(), 0u);
+}
+
 // --- Entry point ---
 int main(int argc, char **argv)
 {
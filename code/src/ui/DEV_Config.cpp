@@ -20,11 +20,18 @@ int SPI_Handle;
 int I2C_Handle;
 
 #endif
+static UDOUBLE Bus_Transfers = 0; // GPIO writes and SPI transfers, each one a system call
+
+UDOUBLE DEV_Bus_Transfers(void)
+{
+    return Bus_Transfers;
+}
 /*****************************************
                 GPIO
 *****************************************/
 void DEV_Digital_Write(UWORD Pin, UBYTE Value)
 {
+    Bus_Transfers++;
 #ifdef USE_BCM2835_LIB
     bcm2835_gpio_write(Pin, Value);
     
@@ -199,6 +206,7 @@ UBYTE DEV_ModuleInit(void)
 
 void DEV_SPI_WriteByte(uint8_t Value)
 {
+    Bus_Transfers++;
 #ifdef USE_BCM2835_LIB
     bcm2835_spi_transfer(Value);
     
@@ -214,6 +222,7 @@ void DEV_SPI_WriteByte(uint8_t Value)
 
 void DEV_SPI_Write_nByte(uint8_t *pData, uint32_t Len)
 {
+    Bus_Transfers++;
 #ifdef USE_BCM2835_LIB
     char rData[Len];
     bcm2835_spi_transfernb(pData,rData,Len);
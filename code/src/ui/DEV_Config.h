@@ -67,5 +67,6 @@ void DEV_Delay_ms(UDOUBLE xms);
 void I2C_Write_Byte(uint8_t value, uint8_t Cmd);
 void DEV_SPI_WriteByte(UBYTE Value);
 void DEV_SPI_Write_nByte(uint8_t *pData, uint32_t Len);
+UDOUBLE DEV_Bus_Transfers(void);
 
 #endif
@@ -1,6 +1,11 @@
 #include "Display.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
 
-Display::Display() : cursor(0), semitones(nullptr), semitone_count(0) {
+Display::Display()
+    : cursor(0), semitones(nullptr), semitone_count(0), backend(DisplayBackend::Panel), framesDumped(0) {
     // Initialize with default values
 }
 
@@ -10,7 +15,12 @@ Display::~Display() {
 }
 
 // Initialize display hardware
-bool Display::init() {
+bool Display::init(DisplayBackend backend) {
+    this->backend = backend;
+    SSD1305_clear();
+    if (backend == DisplayBackend::Headless) {
+        return true;
+    }
     if(DEV_ModuleInit() != 0) {
         return false;
     }
@@ -19,71 +29,101 @@ bool Display::init() {
     return true;
 }
 
-// Check if a note is a black key
-bool Display::isBlackKey(int note) {
-    for (int i = 0; i < 14; i++) {
-        if (black_keys[i] == note) {
-            return true;
+void Display::setDumpDirectory(const std::string& directory) {
+    dumpDirectory = directory;
+}
+
+bool Display::savePBM(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    // P4 packs each row MSB first with 1 = black, so lit pixels are written as 0
+    const unsigned char* pages = SSD1305_framebuffer();
+    unsigned char rows[HEIGHT][WIDTH / 8] = {};
+    for (int y = 0; y < HEIGHT; y++) {
+        for (int x = 0; x < WIDTH; x++) {
+            if (!(pages[x + (y / 8) * WIDTH] & (1 << (y % 8)))) {
+                rows[y][x / 8] |= 0x80 >> (x % 8);
+            }
         }
     }
-    return false;
+
+    const bool written = fprintf(file, "P4\n%d %d\n", WIDTH, HEIGHT) > 0
+                         && fwrite(rows, sizeof(rows), 1, file) == 1;
+    return fclose(file) == 0 && written;
 }
 
-// Get white key x position based on cursor value
-int Display::getWhiteKeyXPosition(int cursor) {
-    int cursor_index = -1;
-    int zero_index = -1;
+void Display::flush() {
+    if (backend == DisplayBackend::Panel) {
+        SSD1305_display();
+        return;
+    }
+    if (dumpDirectory.empty()) {
+        return;
+    }
 
-    // Find the indices of cursor and 0 in white_keys array
-    for (int i = 0; i < 21; i++) {
-        if (white_keys[i] == cursor) {
-            cursor_index = i;
-        }
-        if (white_keys[i] == 0) {
-            zero_index = i;
-        }
+    char name[32];
+    snprintf(name, sizeof(name), "/frame_%05u.pbm", framesDumped++);
+    if (!savePBM(dumpDirectory + name)) {
+        fprintf(stderr, "[Display] Could not write %s%s\n", dumpDirectory.c_str(), name);
     }
+}
 
-    if (cursor_index == -1) {
-        // Cursor value not found in array, return default position
-        return KEY0_X_POSITION;
+namespace {
+    // Keyboard layout: semitones of the white and black keys, and where the black keys are drawn
+    constexpr int white_keys[21] = {-17, -15, -13, -12, -10, -8, -7, -5, -3, -1, 0, 2, 4, 5, 7, 9, 11, 12, 14, 16, 17};
+    constexpr int black_keys[14] = {-16, -14, -11, -9, -6, -4, -2, 1, 3, 6, 8, 10, 13, 15};
+    constexpr int black_key_positions[14] = {5, 12, 23, 30, 41, 47, 54, 65, 72, 83, 89, 96, 107, 114};
+    constexpr int KEY_COUNT = HIGHEST_NOTE - LOWEST_NOTE + 1;
+
+    // Semitone -> key geometry, built once at compile time from the layout above
+    constexpr std::array<Display::KeyGeometry, KEY_COUNT> buildKeyTable() {
+        std::array<Display::KeyGeometry, KEY_COUNT> table{};
+        for (int i = 0; i < 21; i++) {
+            // White keys are 6 pixels apart, counted from the central C (index 10)
+            table[white_keys[i] - LOWEST_NOTE] = {false, KEY0_X_POSITION + (i - 10) * WHITE_KEY_WIDTH + 3};
+        }
+        for (int i = 0; i < 14; i++) {
+            table[black_keys[i] - LOWEST_NOTE] = {true, black_key_positions[i]};
+        }
+        return table;
     }
 
-    // Calculate offset based on position difference in white_keys
-    int key_offset = cursor_index - zero_index;
+    constexpr auto KEYS = buildKeyTable();
+    constexpr Display::KeyGeometry OFF_KEYBOARD = {false, KEY0_X_POSITION};
 
-    // Each white key is 6 pixels wide
-    return KEY0_X_POSITION + (key_offset * 6)+3;
-}
+    static_assert(!KEYS[0 - LOWEST_NOTE].black && KEYS[0 - LOWEST_NOTE].x == 62, "central C");
+    static_assert(KEYS[1 - LOWEST_NOTE].black && KEYS[1 - LOWEST_NOTE].x == 65, "C#");
 
-// Get black key x position based on cursor value
-int Display::getBlackKeyXPosition(int cursor) {
-    for (int i = 0; i < 14; i++) {
-        if (black_keys[i] == cursor) {
-            return black_key_positions[i];
+    // piano_screen is stored a row at a time, MSB first; the framebuffer is column bytes per page
+    constexpr std::array<unsigned char, WIDTH * HEIGHT / 8> packPages(const unsigned char* rows) {
+        std::array<unsigned char, WIDTH * HEIGHT / 8> pages{};
+        for (int y = 0; y < HEIGHT; y++) {
+            for (int x = 0; x < WIDTH; x++) {
+                if (rows[y * (WIDTH / 8) + x / 8] & (0x80 >> (x % 8))) {
+                    pages[x + (y / 8) * WIDTH] |= static_cast<unsigned char>(1 << (y % 8));
+                }
+            }
         }
+        return pages;
     }
-    // If not found, return default
-    return KEY0_X_POSITION;
+
+    constexpr auto PIANO_PAGES = packPages(piano_screen);
 }
 
-// Return the upper left x position of any key based on cursor value
-int Display::getKeyXPosition(int cursor) {
-    if (isBlackKey(cursor)) {
-        return getBlackKeyXPosition(cursor);
-    } else {
-        return getWhiteKeyXPosition(cursor);
+const Display::KeyGeometry& Display::keyGeometry(int note) {
+    if (note < LOWEST_NOTE || note > HIGHEST_NOTE) {
+        return OFF_KEYBOARD;
     }
+    return KEYS[note - LOWEST_NOTE];
 }
 
 void Display::drawHeader(const char* effectName, float effectValue, bool isEnabled) {
     if (isEnabled) {
         // Draw a filled white rectangle as background
-        for (int i = 2; i < 62; i++) {
-            for (int j = 2; j < 2 + 8; j++) {
-                SSD1305_pixel(i, j, 1);
-            }
-        }
+        SSD1305_fill_rect(2, 2, 60, 8, 1);
         // Then draw black text on white background
         SSD1305_string_4x7(3, 3, effectName, 0);
     } else {
@@ -103,99 +143,89 @@ void Display::drawSelection() {
     
     // Draw the selection rectangle for each semitone
     for (int i = 0; i < semitone_count; i++) {
-        int x_pos = getKeyXPosition(semitones[i]);
-        if (isBlackKey(semitones[i])) {
-            int y_pos = BLACK_KEY_Y_POSITION;
-            for (int j = x_pos + 1; j < x_pos + BLACK_KEY_WIDTH - 1; j++) {
-                for (int k = y_pos + 1; k < y_pos + BLACK_KEY_HEIGHT - 1; k++) {
-                    SSD1305_pixel(j, k, 1); // Set to white
-                }
-            }
+        const KeyGeometry& key = keyGeometry(semitones[i]);
+        if (key.black) {
+            // Light the key inside its outline
+            SSD1305_fill_rect(key.x + 1, BLACK_KEY_Y_POSITION + 1, BLACK_KEY_WIDTH - 2, BLACK_KEY_HEIGHT - 2, 1);
         } else {
-            // Draw a filled rectangle for the selection
-            int y_pos = WHITE_KEY_Y_POSITION;
-            for (int j = x_pos + 1; j < x_pos + WHITE_KEY_WIDTH - 2; j++) {
-                for (int k = y_pos + 10; k < y_pos + WHITE_KEY_HEIGHT - 2; k++) {
-                    SSD1305_pixel(j, k, 0); // Set to black
-                }
-            }
+            // Darken the part of the white key below the black keys
+            SSD1305_fill_rect(key.x + 1, WHITE_KEY_Y_POSITION + 10, WHITE_KEY_WIDTH - 3, WHITE_KEY_HEIGHT - 12, 0);
         }
     }
 }
 
 // Draw cursor at current position
 void Display::drawCursor() {
-    // Check if cursor is on a black key
-    bool is_black = isBlackKey(cursor);
-    
-    // Get position to draw cursor
-    char cursor_x = getKeyXPosition(cursor);
-    
-    // Adjust settings based on key type
-    char cursor_y, cursor_width, cursor_height;
-    if (is_black) {
-        // Black key settings
-        cursor_y = BLACK_KEY_Y_POSITION;
-        cursor_width = BLACK_KEY_WIDTH;
-        cursor_height = BLACK_KEY_HEIGHT;
-    } else {
-        // White key settings
-        cursor_y = WHITE_KEY_Y_POSITION;
-        cursor_width = WHITE_KEY_WIDTH;
-        cursor_height = WHITE_KEY_HEIGHT;
-    }
-
-    // Check if cursor is on a selected note (for black keys)
-    if (is_black && semitones) {
-        for (int k = 0; k < semitone_count; k++) { 
-            if (semitones[k] == cursor) {
-                for (int i = cursor_x; i < cursor_x + cursor_width; i++) {
-                    for (int j = cursor_y - 1; j < cursor_y + 1; j++) {    
-                        if ((i + j) % 2 == 0) {
-                            SSD1305_pixel(i, j, 1);  // Set to white on black keys
-                        } else {
-                            SSD1305_pixel(i, j, 0);  // Set to black on black keys
-                        }
-                    }
-                }
-                return;  // Exit function - don't draw standard cursor on selected keys
-            }
-        }
-    } 
-
-    // Draw checkered pattern
-    for (int i = cursor_x; i < cursor_x + cursor_width; i++) {
-        for (int j = cursor_y; j < cursor_y + cursor_height; j++) {
-            // For black keys, we need special handling to maintain borders
-            if (is_black) {
-                // Skip the border pixels
-                if (i == cursor_x || i == cursor_x + cursor_width - 1 || j == cursor_y + cursor_height - 1) {
-                    // Don't modify border pixels
-                    continue;
-                }
-                // Draw alternating white and black pixels for the interior
-                if ((i + j) % 2 == 0) {
-                    SSD1305_pixel(i, j, 1);  // Set to white on black keys
-                } else {
-                    SSD1305_pixel(i, j, 0);  // Set to black on black keys
-                }
-            } else {
-                // For white keys, just set black pixels for checkerboard
-                if ((i + j) % 2 == 0) {
-                    SSD1305_pixel(i, j, 0);  // Set to black
-                }
-            }
+    const KeyGeometry& key = keyGeometry(cursor);
+
+    if (!key.black) {
+        // White keys: knock a checkerboard out of the key
+        SSD1305_checker_rect(key.x, WHITE_KEY_Y_POSITION, WHITE_KEY_WIDTH, WHITE_KEY_HEIGHT, 0);
+        return;
+    }
+
+    // A selected black key is lit already, so the cursor becomes a checkered bar above it
+    for (int k = 0; semitones && k < semitone_count; k++) {
+        if (semitones[k] == cursor) {
+            SSD1305_checker_rect(key.x, BLACK_KEY_Y_POSITION - 1, BLACK_KEY_WIDTH, 2, 1);
+            return;
         }
     }
+
+    // Checker the inside of the black key, keeping its side and bottom borders
+    SSD1305_checker_rect(key.x + 1, BLACK_KEY_Y_POSITION, BLACK_KEY_WIDTH - 2, BLACK_KEY_HEIGHT - 1, 1);
 }
 
 void Display::update(const char* effectName, float effectValue, bool isEnabled) {
-    SSD1305_clear();
-    SSD1305_bitmap(0, 0, piano_screen, 128, 32, 1);
+    draw(effectName, effectValue, isEnabled);
+    flush();
+}
+
+void Display::draw(const char* effectName, float effectValue, bool isEnabled) {
+    SSD1305_copy(PIANO_PAGES.data());
     drawCursor();
     drawSelection();
     drawHeader(effectName, effectValue, isEnabled);
-    SSD1305_display();
+}
+
+// Draw the cents scale and the needle
+void Display::drawTunerMeter(float cents, bool pitched) {
+    // Ticks every 10 cents, the centre one full height
+    for (int c = -40; c <= 40; c += 10) {
+        int top = (c == 0) ? TUNER_METER_TOP : HEIGHT - 3;
+        SSD1305_fill_rect(TUNER_CENTRE_X + c, top, 1, HEIGHT - top, 1);
+    }
+
+    if (!pitched) {
+        return;
+    }
+
+    // A wider needle once the note is in tune
+    int offset = static_cast<int>(std::lround(std::max(std::min(cents, (float)TUNER_RANGE_CENTS), -(float)TUNER_RANGE_CENTS)));
+    int half_width = (std::fabs(cents) < TUNER_IN_TUNE_CENTS) ? 2 : 1;
+    SSD1305_fill_rect(TUNER_CENTRE_X + offset - half_width, TUNER_METER_TOP + 1,
+                      2 * half_width + 1, HEIGHT - 4 - (TUNER_METER_TOP + 1), 1);
+}
+
+void Display::showTuner(const char* noteName, float cents, bool pitched, float reference) {
+    drawTuner(noteName, cents, pitched, reference);
+    flush();
+}
+
+void Display::drawTuner(const char* noteName, float cents, bool pitched, float reference) {
+    SSD1305_clear();
+    drawHeader("TUNER", reference, true);
+    SSD1305_string_4x7(3, 14, noteName, 1);
+
+    char centsStr[10];
+    if (pitched) {
+        snprintf(centsStr, sizeof(centsStr), "%+dc", static_cast<int>(std::lround(cents)));
+    } else {
+        snprintf(centsStr, sizeof(centsStr), "--");
+    }
+    SSD1305_string_4x7(3, 23, centsStr, 1);
+
+    drawTunerMeter(cents, pitched);
 }
 
 // Set cursor position
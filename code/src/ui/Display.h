@@ -3,6 +3,7 @@
 
 #include "SSD1305.h"
 #include "DEV_Config.h"
+#include <string>
 
 // Keyboard position constants
 #define KEY0_X_POSITION 59  // Position of the central C key
@@ -13,37 +14,63 @@
 #define BLACK_KEY_WIDTH 4
 #define BLACK_KEY_HEIGHT 12
 
-// Forward declare external bitmap
-extern const unsigned char piano_screen[];
+// Tuner meter constants
+#define TUNER_CENTRE_X 78   // x of 0 cents; one pixel per cent
+#define TUNER_RANGE_CENTS 48
+#define TUNER_METER_TOP 13
+#define TUNER_IN_TUNE_CENTS 3.0f
+
+// Keyboard range in semitones from the central C
+#define LOWEST_NOTE -17
+#define HIGHEST_NOTE 17
+
+// Where frames go: the SSD1305 over SPI, or only into the framebuffer (dev boxes, tests)
+enum class DisplayBackend { Panel, Headless };
 
 class Display {
+public:
+    // Where a key is drawn; looked up by semitone, see keyGeometry()
+    struct KeyGeometry {
+        bool black;
+        int x;
+    };
+
+    // Geometry of the key for a semitone; notes off the keyboard map to the central C's position
+    static const KeyGeometry& keyGeometry(int note);
+
 private:
-    // Static keyboard layout data
-    static constexpr int white_keys[21] = {-17, -15, -13, -12, -10, -8, -7, -5, -3, -1, 0, 2, 4, 5, 7, 9, 11, 12, 14, 16, 17};
-    static constexpr int black_keys[14] = {-16, -14, -11, -9, -6, -4, -2, 1, 3, 6, 8, 10, 13, 15};
-    static constexpr int black_key_positions[14] = {5, 12, 23, 30, 41, 47, 54, 65, 72, 83, 89, 96, 107, 114};
-    
     // Note tracking
     int cursor;
     int* semitones;
     int semitone_count;
 
+    // Output
+    DisplayBackend backend;
+    std::string dumpDirectory;
+    unsigned int framesDumped;
+
     // Helper methods for drawing
-    bool isBlackKey(int note);
-    int getWhiteKeyXPosition(int cursor);
-    int getBlackKeyXPosition(int cursor);
-    int getKeyXPosition(int cursor);
     void drawHeader(const char* effectName, float effectValue, bool isEnabled);
     void drawSelection();
     void drawCursor();
+    void drawTunerMeter(float cents, bool pitched);
+
+    // Show the framebuffer: send it to the panel, or dump it if headless
+    void flush();
 
 public:
     // Constructor & destructor
     Display();
     ~Display();
     
-    // Initialization
-    bool init();
+    // Initialization: the panel backend brings up GPIO/SPI and the controller, headless needs nothing
+    bool init(DisplayBackend backend = DisplayBackend::Panel);
+
+    // Headless: save every frame shown as <directory>/frame_NNNNN.pbm (empty to stop)
+    void setDumpDirectory(const std::string& directory);
+
+    // Save the framebuffer as a binary PBM, lit pixels white as on the panel
+    static bool savePBM(const std::string& path);
     
     // State setting methods
     void setCursor(int note);
@@ -51,6 +78,13 @@ public:
     
     // Display update method with effect information provided by UIHandler
     void update(const char* effectName, float effectValue, bool isEnabled);
+
+    // Tuner screen: note name (e.g. "E2", "--" if unpitched), cents meter and reference pitch
+    void showTuner(const char* noteName, float cents, bool pitched, float reference);
+
+    // Draw either screen into the framebuffer without sending it to the panel
+    void draw(const char* effectName, float effectValue, bool isEnabled);
+    void drawTuner(const char* noteName, float cents, bool pitched, float reference);
 };
 
 #endif // DISPLAY_H
\ No newline at end of file
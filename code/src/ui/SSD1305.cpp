@@ -31,11 +31,26 @@
 #include "SSD1305.h"
 #include "DEV_Config.h"
 #include <stdint.h>
+#include <string.h>
 unsigned char buffer[WIDTH * HEIGHT / 8];
 
+#define COLUMN_OFFSET 4 // The controller has 132 columns; the panel shows columns 4..131
+
+static unsigned char shown[WIDTH * HEIGHT / 8]; // What the panel's RAM holds, once shownValid
+static char shownValid = 0;
+static int dcLevel = -1;                       // Last level driven on DC, -1 if unknown
+
+static void setDC(int level)
+{
+	if (level == dcLevel) return;
+	if (level) OLED_DC_1;
+	else OLED_DC_0;
+	dcLevel = level;
+}
+
 void command(uint8_t cmd){
    #if USE_SPI
-	OLED_DC_0;
+	setDC(0);
     // OLED_CS_0;
     DEV_SPI_WriteByte(cmd);
     // OLED_CS_1;
@@ -47,7 +62,7 @@ void command(uint8_t cmd){
 void data(uint8_t Data)
 {
 	#if USE_SPI
-		OLED_DC_1;
+		setDC(1);
 		DEV_SPI_WriteByte(Data);
 	#elif USE_IIC
 		I2C_Write_Byte(Data,IIC_RAM);
@@ -63,6 +78,8 @@ void SSD1305_begin()
     OLED_RST_1;
     DEV_Delay_ms(100);
 
+    dcLevel = -1;
+    shownValid = 0; // Panel RAM is undefined after reset
     command(0xAE);//--turn off oled panel
 	command(0x04);//--Set Lower Column Start Address for Page Addressing Mode	
 	command(0x10);//--Set Higher Column Start Address for Page Addressing Mode
@@ -175,21 +192,139 @@ void SSD1305_bitmap(unsigned char x, unsigned char y, const unsigned char *pBmp,
 	}
 }
 
+/******************************************************************************
+function:	Bits of one page covered by rows [top, bottom) of that page
+******************************************************************************/
+static unsigned char pageMask(int top, int bottom)
+{
+	return (unsigned char)((0xFF << top) & (0xFF >> (8 - bottom)));
+}
+
+/******************************************************************************
+function:	Fills a rectangle, clipped to the screen
+Info:		Works a page at a time: one masked OR/AND per column and page
+			instead of one read-modify-write per pixel.
+******************************************************************************/
+void SSD1305_fill_rect(int x, int y, int w, int h, char color)
+{
+	int x0 = x < 0 ? 0 : x, x1 = x + w > WIDTH ? WIDTH : x + w;
+	int y0 = y < 0 ? 0 : y, y1 = y + h > HEIGHT ? HEIGHT : y + h;
+	if (x0 >= x1 || y0 >= y1) return;
+
+	for (int page = y0 / 8; page <= (y1 - 1) / 8; page++) {
+		int top = y0 > page * 8 ? y0 - page * 8 : 0;
+		int bottom = y1 < page * 8 + 8 ? y1 - page * 8 : 8;
+		unsigned char mask = pageMask(top, bottom);
+		unsigned char *column = buffer + page * WIDTH;
+		for (int i = x0; i < x1; i++) {
+			if (color) column[i] |= mask;
+			else column[i] &= ~mask;
+		}
+	}
+}
+
+/******************************************************************************
+function:	Checkerboard over a rectangle, clipped to the screen
+Info:		The pattern lights pixels where x + y is even. Pages are 8 rows, so
+			a column's bits are 0x55 at even x and 0xAA at odd x on every page.
+			mode 1 draws the pattern (other pixels in the rectangle go dark);
+			mode 0 only darkens the pattern's pixels and leaves the rest.
+******************************************************************************/
+void SSD1305_checker_rect(int x, int y, int w, int h, char mode)
+{
+	int x0 = x < 0 ? 0 : x, x1 = x + w > WIDTH ? WIDTH : x + w;
+	int y0 = y < 0 ? 0 : y, y1 = y + h > HEIGHT ? HEIGHT : y + h;
+	if (x0 >= x1 || y0 >= y1) return;
+
+	for (int page = y0 / 8; page <= (y1 - 1) / 8; page++) {
+		int top = y0 > page * 8 ? y0 - page * 8 : 0;
+		int bottom = y1 < page * 8 + 8 ? y1 - page * 8 : 8;
+		unsigned char mask = pageMask(top, bottom);
+		unsigned char *column = buffer + page * WIDTH;
+		for (int i = x0; i < x1; i++) {
+			unsigned char pattern = ((i & 1) ? 0xAA : 0x55) & mask;
+			if (mode) column[i] = (column[i] & ~mask) | pattern;
+			else column[i] &= ~pattern;
+		}
+	}
+}
+
+/******************************************************************************
+function:	Replaces the framebuffer with a page-packed image (WIDTH x HEIGHT)
+******************************************************************************/
+void SSD1305_copy(const unsigned char *pages)
+{
+	memcpy(buffer, pages, sizeof(buffer));
+}
+
+const unsigned char *SSD1305_framebuffer()
+{
+	return buffer;
+}
+
+/******************************************************************************
+function:	Writes one glyph column (bit 0 on top) at row y
+Info:		The column straddles at most two pages. mode 1 lights the glyph's
+			pixels; mode 0 draws it inverted, lighting the rest of `rows`.
+******************************************************************************/
+static void blitColumn(int x, int y, unsigned char bits, unsigned char rows, char mode)
+{
+	if (x < 0 || x >= WIDTH) return;
+	unsigned int glyph = (unsigned int)(bits & rows) << (y % 8);
+	unsigned int mask = (unsigned int)rows << (y % 8);
+	for (int page = y / 8; page < HEIGHT / 8 && mask; page++, glyph >>= 8, mask >>= 8) {
+		unsigned char *column = buffer + page * WIDTH + x;
+		if (mode) *column |= (unsigned char)glyph;
+		else *column = (unsigned char)((*column | mask) & ~glyph);
+	}
+}
+
+void SSD1305_invalidate()
+{
+	shownValid = 0;
+}
+
+/******************************************************************************
+function:	Sends the changed part of the framebuffer to the panel
+Info:		Each page with changes gets its column range sent in one SPI
+			transfer after a single batch of address commands, so a full
+			refresh is 4 pages x (DC, 3 commands, DC, data) rather than
+			one DC write and one SPI write per byte. Unchanged pages are skipped.
+******************************************************************************/
 void SSD1305_display()
 {
-    UWORD page, column;
-    for (page = 0; page < (HEIGHT / 8); page++) {  
-        /* set page address */
+    UWORD page, first, last;
+    for (page = 0; page < (HEIGHT / 8); page++) {
+        unsigned char *row = buffer + page * WIDTH;
+        unsigned char *was = shown + page * WIDTH;
+
+        first = 0;
+        last = WIDTH - 1;
+        if (shownValid) {
+            while (first < WIDTH && row[first] == was[first]) first++;
+            if (first == WIDTH) continue; // Page unchanged
+            while (row[last] == was[last]) last--;
+        }
+
+#if USE_SPI
+        /* page address, then column address (low and high nibble) */
+        uint8_t address[3] = {(uint8_t)(0xB0 + page), (uint8_t)((first + COLUMN_OFFSET) & 0x0F),
+                              (uint8_t)(0x10 | ((first + COLUMN_OFFSET) >> 4))};
+        setDC(0);
+        DEV_SPI_Write_nByte(address, sizeof(address));
+        setDC(1);
+        DEV_SPI_Write_nByte(row + first, last - first + 1);
+#elif USE_IIC
         command(0xB0 + page);
-        /* set low column address */
-        command(0x04); 
-        /* set high column address */
-        command(0x10); 
-        /* write data */
-		for(column=0; column< WIDTH; column++) {
-            data(buffer[page * WIDTH + column]);
+        command((first + COLUMN_OFFSET) & 0x0F);
+        command(0x10 | ((first + COLUMN_OFFSET) >> 4));
+        for (UWORD column = first; column <= last; column++) {
+            data(row[column]);
         }
+#endif
+        memcpy(was + first, row + first, last - first + 1);
     }
+    shownValid = 1;
 }
 
 void SSD1305_string_5x7(unsigned char x, unsigned char y, const char *pString, unsigned char Mode)
@@ -208,23 +343,9 @@ void SSD1305_string_5x7(unsigned char x, unsigned char y, const char *pString, u
             continue;
         }
         
-        // Draw character column by column
+        // Draw character column by column, 7 rows at a time
         for (unsigned char col = 0; col < 5; col++) {
-            unsigned char byte = Font5x7[ch][col];
-            
-            // Skip empty columns for efficiency
-            if (byte == 0 && Mode == 1) continue;
-            
-		// Draw each pixel in the column
-		for (unsigned char row = 0; row < 7; row++) {
-			if (byte & (1 << row)) {
-				SSD1305_pixel(x_pos + col, y + row, Mode);
-			}
-			 // Clear pixels if we're in inverse mode
-			else if (Mode == 0) { 
-				SSD1305_pixel(x_pos + col, y + row, 1); 
-			}
-		}
+            blitColumn(x_pos + col, y, Font5x7[ch][col], 0x7F, Mode);
         }
         
         // Move to next character position with 1 pixel spacing
@@ -257,23 +378,9 @@ void SSD1305_string_4x7(unsigned char x, unsigned char y, const char *pString, u
 			continue;
 		}
         
-        // Draw character column by column
+        // Draw character column by column, 7 rows at a time
         for (unsigned char col = 0; col < 4; col++) {
-            unsigned char byte = Font4x7[ch][col];
-            
-            // Skip empty columns for efficiency
-            if (byte == 0 && Mode == 1) continue;
-            
-            // Draw each pixel in the column
-            for (unsigned char row = 0; row < 7; row++) {
-                if (byte & (1 << row)) {
-                    SSD1305_pixel(x_pos + col, y + row, Mode);
-                }
-				// Only clear pixels if in inverse mode
-                else if (Mode == 0) {  
-                    SSD1305_pixel(x_pos + col, y + row, 1);
-                }
-            }
+            blitColumn(x_pos + col, y, Font4x7[ch][col], 0x7F, Mode);
         }
         // Move to next character position with 1 pixel spacing, 4px width + 1px spacing
         x_pos += 5;
@@ -39,13 +39,18 @@
 
 void SSD1305_begin();
 void SSD1305_display();
+void SSD1305_invalidate(); // Next SSD1305_display() sends every page
 void SSD1305_clear();
 void SSD1305_pixel(int x,int y,char color);
+void SSD1305_fill_rect(int x, int y, int w, int h, char color);
+void SSD1305_checker_rect(int x, int y, int w, int h, char mode); // mode 1 draws, 0 knocks out
+void SSD1305_copy(const unsigned char *pages); // Page-packed image, WIDTH x HEIGHT
+const unsigned char *SSD1305_framebuffer(); // Byte x + (y / 8) * WIDTH holds rows y & ~7 .. +7 of column x
 void SSD1305_bitmap(unsigned char x,unsigned char y,const unsigned char *pBmp,
 					unsigned char chWidth,unsigned char chHeight, char mode);
 void SSD1305_string_4x7(unsigned char x, unsigned char y, const char *pString, unsigned char Mode);
 
-static const unsigned char piano_screen[512]={
+static constexpr unsigned char piano_screen[512]={
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 
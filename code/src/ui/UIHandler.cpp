@@ -3,6 +3,13 @@
 #include <sstream>
 #include <cmath>
 #include <algorithm>
+#include <cstdio>
+#include <thread>
+#include <pthread.h>
+#include <sched.h>
+#include <cerrno>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 // Static singleton instance
 UIHandler& UIHandler::getInstance() {
@@ -13,74 +20,209 @@ UIHandler& UIHandler::getInstance() {
 UIHandler::UIHandler() 
     : config(Config::getInstance()),
       cursorPosition(0),
-      currentEffectIndex(1) {  // Start with fuzz selected
-    
+      currentEffectIndex(1),  // Start with fuzz selected
+      editFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+    if (editFd < 0) {
+        perror("[UIHandler] eventfd");
+    }
+
     // Initialize with 8-bit resolution
     effects.emplace_back("Harmonizer", "harmonizer", EffectParam::TYPE_SEMITONES, 0.0f, 0.0f);
     effects.emplace_back("Fuzz", "fuzz", EffectParam::TYPE_FLOAT, 0.0f, 1.0f);
     effects.emplace_back("Gain", "gain", EffectParam::TYPE_FLOAT, 0.0f, 200.0f);
+    effects.emplace_back("Chorus", "chorus", EffectParam::TYPE_FLOAT, 0.05f, 5.0f);
+    effects.emplace_back("Delay", "delay", EffectParam::TYPE_FLOAT, 40.0f, 2000.0f);
+    effects.emplace_back("Reverb", "reverb", EffectParam::TYPE_FLOAT, 0.2f, 10.0f);
+    effects.emplace_back("EQ", "eq", EffectParam::TYPE_FLOAT, -12.0f, 12.0f);
+    effects.emplace_back("Tuner", "tuner", EffectParam::TYPE_FLOAT, 415.0f, 466.0f);
+    effects.emplace_back("Looper", "looper", EffectParam::TYPE_FLOAT, 0.0f, 1.0f);
     
 }
 
 UIHandler::~UIHandler() {
-    // Cleanup resources if needed
+    stop();
+    if (editFd >= 0) {
+        close(editFd);
+    }
 }
 
-bool UIHandler::init(DigitalSignalChain &dspChain) {
+void UIHandler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (renderThread.joinable()) {
+        renderThread.join();
+    }
+}
+
+bool UIHandler::init(DigitalSignalChain &dspChain, DisplayBackend backend, const std::string& dumpDirectory) {
     // Initialize the display
     this->dspChain = &dspChain;
-    if (!display.init()) {
+    if (!display.init(backend)) {
         std::cerr << "Failed to initialize display" << std::endl;
         return false;
     }
+    display.setDumpDirectory(dumpDirectory);
     
+    // Every chain's tuner (live or preset) draws its readings here
+    dspChain.forEachInstance(EffectRegistry::idOf<Tuner>(), [this](Effect& tuner) {
+        static_cast<Tuner&>(tuner).setListener([this](const TunerReading& reading) { showTuner(reading); });
+    });
+
+    // From here on only the render thread touches the display
+    renderThread = std::thread(&UIHandler::renderLoop, this);
+
     // Load initial settings from config
+    std::lock_guard<std::mutex> lock(stateMutex);
     loadFromConfig();
     
     // Update display with initial state
-    update();
+    publishPiano();
 
     for (int i = 1; i < 9; i++) {
         toggleSemitone(i);
-        update();
+        publishPiano();
     }
     
     return true;
 }
 
 void UIHandler::update() {
-    std::cout << "Updating display..." << std::endl;
-    
-    // Set cursor position on piano keyboard
-    display.setCursor(cursorPosition);
-    
-    // Set selected notes for harmonizer
-    std::cout << "  Harmonizer enabled: " << (effects[0].isEnabled ? "YES" : "NO") 
-             << ", semitone count: " << effects[0].semitoneCount << std::endl;
-             
-    if (effects[0].isEnabled && effects[0].semitoneCount > 0) {
-        std::cout << "  Sending semitones to display: ";
-        for (int i = 0; i < effects[0].semitoneCount; i++) {
-            std::cout << effects[0].semitones[i] << " ";
+    std::lock_guard<std::mutex> lock(stateMutex);
+    publishPiano();
+}
+
+void UIHandler::publishPiano() {
+    const auto& effect = effects[currentEffectIndex];
+
+    // The looper's header also shows what the playing chain's looper is doing
+    std::shared_ptr<Effect> looper;
+    if (effect.configKey == "looper") {
+        looper = dspChain->getPlayingEffect(EffectRegistry::idOf<Looper>());
+    }
+
+    std::lock_guard<std::mutex> lock(publishMutex);
+    UISnapshot& snapshot = snapshots.writeBuffer();
+    snapshot.screen = UISnapshot::SCREEN_PIANO;
+    snapshot.cursor = cursorPosition;
+
+    // Selected notes for the harmonizer
+    if (effects[0].isEnabled) {
+        snapshot.semitones = effects[0].semitones;
+        snapshot.semitoneCount = effects[0].semitoneCount;
+    } else {
+        snapshot.semitoneCount = 0;
+    }
+
+    if (looper) {
+        snprintf(snapshot.label, sizeof(snapshot.label), "%s %s", effect.name.c_str(),
+                 Looper::stateName(static_cast<Looper*>(looper.get())->state()));
+    } else {
+        snprintf(snapshot.label, sizeof(snapshot.label), "%s", effect.name.c_str());
+    }
+    snapshot.value = effect.currentValue;
+    snapshot.enabled = effect.isEnabled;
+
+    publish();
+}
+
+void UIHandler::publish() {
+    snapshots.publish();
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        framePending = true;
+    }
+    wake.notify_one();
+}
+
+void UIHandler::renderLoop() {
+    // Drawing can always wait: never compete with the audio or input threads for a core
+    sched_param param{};
+    if (pthread_setschedparam(pthread_self(), SCHED_IDLE, &param) != 0) {
+        std::cerr << "[UIHandler] Could not lower render thread priority\n";
+    }
+
+    auto nextFrame = std::chrono::steady_clock::now();
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait(lock, [this] { return framePending || stopping; });
+            if (stopping) {
+                return;
+            }
+            framePending = false;
         }
-        std::cout << std::endl;
-        
-        display.setSelectedNotes(effects[0].semitones.data(), effects[0].semitoneCount);
+
+        // Anything published until the next frame is due folds into that frame
+        std::this_thread::sleep_until(nextFrame);
+        if (!snapshots.update()) {
+            continue;
+        }
+        render(snapshots.read());
+        nextFrame = std::chrono::steady_clock::now() + FRAME_INTERVAL;
+    }
+}
+
+void UIHandler::render(const UISnapshot& snapshot) {
+    if (snapshot.screen == UISnapshot::SCREEN_TUNER) {
+        display.showTuner(snapshot.noteName, snapshot.cents, snapshot.pitched, snapshot.reference);
+        return;
+    }
+
+    // The display keeps a pointer to the notes, so give it a copy that outlives the snapshot
+    renderSemitones = snapshot.semitones;
+    display.setCursor(snapshot.cursor);
+    display.setSelectedNotes(snapshot.semitoneCount > 0 ? renderSemitones.data() : nullptr, snapshot.semitoneCount);
+    display.update(snapshot.label, snapshot.value, snapshot.enabled);
+}
+
+void UIHandler::showTuner(const TunerReading& reading) {
+    static const char* names[12] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+
+    char noteName[8];
+    const bool pitched = reading.note >= 0;
+    if (pitched) {
+        snprintf(noteName, sizeof(noteName), "%s%d", names[reading.note % 12], reading.note / 12 - 1);
     } else {
-        std::cout << "  No semitones to display" << std::endl;
-        display.setSelectedNotes(nullptr, 0);
+        snprintf(noteName, sizeof(noteName), "--");
     }
-    const auto& effect = effects[currentEffectIndex];
-    
-    std::cout << "  Updating display with effect: " << effect.name 
-             << ", value: " << effect.currentValue 
-             << ", enabled: " << effect.isEnabled << std::endl;
-    
-    // Update the display with current effect information
-    display.update(effect.name.c_str(), effect.currentValue, effect.isEnabled);
+
+    // Never stateMutex: reconfiguring the tuner joins the thread that calls this,
+    // so it may only wait on the snapshot writer lock, which nothing holds for long
+    std::lock_guard<std::mutex> lock(publishMutex);
+    UISnapshot& snapshot = snapshots.writeBuffer();
+    snapshot.screen = UISnapshot::SCREEN_TUNER;
+    snprintf(snapshot.noteName, sizeof(snapshot.noteName), "%s", noteName);
+    snapshot.cents = reading.cents;
+    snapshot.pitched = pitched;
+    snapshot.reference = reading.reference;
+    publish();
+}
+
+void UIHandler::refreshFromConfig() {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    loadFromConfig();
+    publishPiano();
 }
 
 void UIHandler::handleEncoder(int encoderID, int action) {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        if (!handleEncoderLocked(encoderID, action)) {
+            return;
+        }
+    }
+
+    // The config thread applies the edits; a burst of ticks folds into one reconfigure
+    const uint64_t one = 1;
+    if (editFd >= 0 && write(editFd, &one, sizeof(one)) != sizeof(one) && errno != EAGAIN) {
+        perror("[UIHandler] eventfd write");
+    }
+}
+
+bool UIHandler::handleEncoderLocked(int encoderID, int action) {
     switch (encoderID) {
         case ENC_CURSOR:
             handleCursorEncoder(static_cast<EncoderAction>(action));
@@ -95,14 +237,15 @@ void UIHandler::handleEncoder(int encoderID, int action) {
             break;
             
         default:
-            return;
+            return false;
     }
     
     // Update config with any changes
     updateConfig();
     
-    // Refresh display
-    update();
+    // Hand the new state to the render thread
+    publishPiano();
+    return true;
 }
 
 void UIHandler::handleCursorEncoder(EncoderAction action) {
@@ -129,15 +272,12 @@ void UIHandler::handleCursorEncoder(EncoderAction action) {
 }
 
 void UIHandler::handleEffectSelectEncoder(EncoderAction action) {
-    // We only have two effects - fuzz (index 1) and gain (index 2)
+    // Cycle through every effect after the harmonizer (index 0, edited with the cursor)
+    const int count = static_cast<int>(effects.size()) - 1;
     
     if (action == ACTION_LEFT || action == ACTION_RIGHT) {
-        // Toggle between fuzz and gain
-        if (currentEffectIndex == 1) {
-            currentEffectIndex = 2;  // Switch from fuzz to gain
-        } else {
-            currentEffectIndex = 1;  // Switch from gain to fuzz
-        }
+        int step = (action == ACTION_RIGHT) ? 1 : count - 1;
+        currentEffectIndex = (currentEffectIndex - 1 + step) % count + 1;
     } 
     else if (action == ACTION_PUSH) {
         // Toggle the current effect on/off
@@ -146,7 +286,7 @@ void UIHandler::handleEffectSelectEncoder(EncoderAction action) {
 }
 
 void UIHandler::handleEffectEditEncoder(EncoderAction action) {
-    // Only adjust parameters if we have a selected effect (should be 1 or 2)
+    // Only adjust parameters if we have a selected effect (any after the harmonizer)
     if (currentEffectIndex < 1 || currentEffectIndex >= static_cast<int>(effects.size())) {
         return;
     }
@@ -174,8 +314,27 @@ void UIHandler::handleEffectEditEncoder(EncoderAction action) {
         }
     }
     else if (action == ACTION_PUSH) {
-        // Could implement a "reset to default" feature here
-        // For now, does nothing
+        // Looper: push to record, play and overdub. Pushing twice within LOOPER_DOUBLE_PUSH
+        // clears it, but only if it was stopped or empty before the first push, so quick
+        // pushes on a running loop (play -> overdub -> play) never lose it.
+        // It drives the looper of whichever chain is playing, preset or live
+        std::shared_ptr<Effect> playing;
+        if (effect.configKey == "looper") {
+            playing = dspChain->getPlayingEffect(EffectRegistry::idOf<Looper>());
+        }
+        if (Looper *looper = static_cast<Looper*>(playing.get())) {
+            auto now = std::chrono::steady_clock::now();
+            if (looperClearArmed && now - lastLooperPush < LOOPER_DOUBLE_PUSH) {
+                looper->clear();
+                looperClearArmed = false;
+            } else {
+                const Looper::State state = looper->state();
+                looperClearArmed = state == Looper::State::Stopped || state == Looper::State::Empty;
+                looper->press();
+                lastLooperPush = now;
+            }
+            // No waiting for the audio thread: the header shows the new state from the next publish
+        }
     }
 }
 
@@ -222,8 +381,6 @@ void UIHandler::updateConfig() {
             // For harmonizer, convert semitones to string representation
             std::string semitonesStr = semitonesToString(effect.semitones, effect.semitoneCount);
             config.set(effect.configKey, effect.isEnabled, semitonesStr);
-            this->dspChain->configureEffects(config); // Apply changes to DSP chain
-            
         } else {
             // For numeric parameters, store the raw value
             config.set(effect.configKey, effect.isEnabled, effect.currentValue);
@@ -303,6 +460,14 @@ void UIHandler::loadFromConfig() {
             else if (effect.name == "Gain") {
                 effect.stepSize = 5.0f; // Adjust gain in steps of 5
             }
+            // For Tuner (reference pitch in Hz)
+            else if (effect.name == "Tuner") {
+                effect.stepSize = 1.0f;
+            }
+            // For Delay (time in ms)
+            else if (effect.name == "Delay") {
+                effect.stepSize = 10.0f; // Adjust delay time in 10 ms steps
+            }
             // Default fallback
             else {
                 effect.stepSize = (effect.maxValue - effect.minValue) / 40.0f; // ~40 steps across range
@@ -5,28 +5,66 @@
 #include "../options/Config.h"
 #include "../gpio_event/gpioevent.h"
 #include "DigitalSignalChain.h"
+#include "TripleBuffer.h"
 #include <string>
 #include <vector>
 #include <array>
+#include <chrono>
 #include <map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
 // Forward declarations
 class EncoderHandler;
 
+// Everything one frame shows, copied out of the UI state and handed to the render thread whole
+struct UISnapshot {
+    enum Screen { SCREEN_PIANO, SCREEN_TUNER } screen = SCREEN_PIANO;
+
+    // Piano screen
+    int cursor = 0;
+    std::array<int, 8> semitones{};
+    int semitoneCount = 0;
+    char label[32] = "";
+    float value = 0.0f;
+    bool enabled = false;
+
+    // Tuner screen
+    char noteName[8] = "";
+    float cents = 0.0f;
+    bool pitched = false;
+    float reference = 440.0f;
+};
+
 class UIHandler{
 public:
     // Singleton pattern
     static UIHandler& getInstance();
 
-    // Initialize UI subsystems
-    bool init(DigitalSignalChain &dspChain);
+    // Initialize UI subsystems; a headless display can save its frames to dumpDirectory
+    bool init(DigitalSignalChain &dspChain, DisplayBackend backend = DisplayBackend::Panel,
+              const std::string& dumpDirectory = "");
 
-    // Update display based on current state
+    // Publish the current state for the render thread to draw
     void update();
 
-    // Process encoder events
+    // Re-read effect settings from config (e.g. after the file changed) and redraw
+    void refreshFromConfig();
+
+    // Publish a tuner reading (called from the tuner's analysis thread)
+    void showTuner(const TunerReading& reading);
+
+    // Stop the render thread (also done on destruction)
+    void stop();
+
+    // Process encoder events; the config changes they make are applied by whoever
+    // waits on configEditFd()
     void handleEncoder(int encoderID, int action);
 
+    // eventfd signalled after the encoders change the config
+    int configEditFd() const { return editFd; }
+
     // Encoder action types
     enum EncoderAction {
         ACTION_LEFT = 0,
@@ -92,6 +130,10 @@ private:
 
     };
     
+    // Apply one encoder event to the UI state; stateMutex must be held.
+    // Returns false if the encoder is unknown
+    bool handleEncoderLocked(int encoderID, int action);
+
     // Handle specific encoder actions
     void handleCursorEncoder(EncoderAction action);
     void handleEffectSelectEncoder(EncoderAction action);
@@ -113,8 +155,44 @@ private:
     // Helper for parsing semitones string to array
     void parseSemitonesString(const std::string& str, std::array<int, EffectParam::MAX_SEMITONES>& semitones, int& count);
 
-    // Display object
+    // Copy the piano screen state into a snapshot and publish it; stateMutex must be held
+    void publishPiano();
+
+    // Hand the filled write buffer to the render thread and wake it; publishMutex must be held
+    void publish();
+
+    // Render thread: draws the newest snapshot, at most once per FRAME_INTERVAL
+    void renderLoop();
+
+    // Draw one snapshot and flush it to the panel (render thread only)
+    void render(const UISnapshot& snapshot);
+
+    // Display object, only drawn on by the render thread once init() has started it
     Display display;
+
+    // Guards the UI state below: the encoder and config threads both change it.
+    // Never held while the DSP chain is reconfigured.
+    std::mutex stateMutex;
+
+    // Snapshot writer lock, which keeps the buffer single-writer. Taken after stateMutex
+    // (never before), and alone by the tuner threads, which must not wait on the UI state
+    std::mutex publishMutex;
+
+    // Newest frame for the render thread; bursts of publishes collapse into one frame
+    TripleBuffer<UISnapshot> snapshots;
+
+    // Wakes the render thread when something is published
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool framePending = false;
+    bool stopping = false;
+    std::thread renderThread;
+
+    // Frame cap: 30 fps is as fast as the panel is worth watching
+    static constexpr std::chrono::milliseconds FRAME_INTERVAL{33};
+
+    // The render thread's copy of the harmonizer notes, which the display points at
+    std::array<int, 8> renderSemitones{};
     
     // Config reference
     Config& config;
@@ -127,6 +205,15 @@ private:
     
     // Currently selected effect for display
     int currentEffectIndex;
+
+    // Two pushes of the edit encoder within this time clear the looper, if the first
+    // push found it stopped or empty (looperClearArmed)
+    static constexpr std::chrono::milliseconds LOOPER_DOUBLE_PUSH{400};
+    std::chrono::steady_clock::time_point lastLooperPush;
+    bool looperClearArmed = false;
+
+    // Signalled after each encoder edit, so the config thread reconfigures the chain
+    int editFd;
     
 
 };